@@ -102,36 +102,26 @@ ANLIMPL_MAIN(int argc, char** argv) {
     }
   }
 
-  // Here we create the simulator. The constructor argument 25 is the number of
-  //  tics per slot (taken from the UPPAAL model). We also assign the topology
-  //  and register the components.
-  Simulator sim(25);
+  // Here we create the simulator. The constructor argument is the number of
+  //  tics per slot, 25 unless set by the "tics" parameter (taken from the
+  //  UPPAAL model). We also assign the topology and register the components.
+  Simulator sim(Parameters::getSize("tics", 25));
   sim.useTopology(&ent);
   sim.useComponents(comps, SIM_NUM_COMPS);
 
-  // Create the messages. Two is the number of distinct message types
-  //  (ALARM, ACK).
-  const Message** msgs = new const Message*[2 * SIM_NUM_COMPS * SIM_NUM_COMPS
-    * SIM_NUM_COMPS];
-  std::size_t ptr = 0;
-  for (std::size_t i = 0; i < SIM_NUM_COMPS; i++) {
-    for (std::size_t j = 0; j < SIM_NUM_COMPS; j++) {
-      for (std::size_t k = 0; k < SIM_NUM_COMPS; k++) {
-        msgs[ptr++] = ProtocolMessage::getMessage(MessageType::ALARM, comps[i],
-          comps[j], comps[k]);
-        msgs[ptr++] = ProtocolMessage::getMessage(MessageType::ACK, comps[i],
-          comps[j], comps[k]);
-      }
-    }
-  }
-  sim.useMessages(msgs, 2 * SIM_NUM_COMPS * SIM_NUM_COMPS * SIM_NUM_COMPS);
-  delete[] msgs;  // We no longer need the array of messages created for
-                  // registering them.
+  // Register the messages. They are created by the protocol when they are
+  //  sent for the first time, thus only the family is registered here instead
+  //  of every combination of type, sender, receiver and payload.
+  sim.useMessageFamily(ProtocolMessage::getFamily());
+
+  // Most components keep their intention from one slot to the next, thus the
+  //  transitions are computed incrementally.
+  sim.useIncrementalTransitions(true);
 
-  // Run the simulation for 120 slots (we determined this amount to be enough by
-  //  trying different values: after ~115 slots, nothing interesting happens
-  //  anymore).
-  sim.run(120);
+  // Run the simulation for 120 slots unless set by the "slots" parameter (we
+  //  determined this amount to be enough by trying different values: after
+  //  ~115 slots, nothing interesting happens anymore).
+  sim.run(Parameters::getSize("slots", 120));
 
   // Cleanup.
   delete gCentralUnit;
@@ -94,6 +94,16 @@ class CentralUnit : public StateMachineComponent<AlarmState> {
   // Getter for the ID.
   std::string doGetId() const override { return "CentralUnit"; }
 
+  // The central unit only reacts to alarms, so it is always stable.
+  bool doIsStable() const override { return true; }
+
+  // The state of the central unit is its state machine state.
+  bool doHashState(StateHasher* hasher) const override;
+
+  // Checkpoints of the state machine state.
+  bool doSaveState(CheckpointWriter* writer) const override;
+  bool doLoadState(CheckpointReader* reader) override;
+
   // XML conversion.
   std::vector<std::string> doToXML() const override;
 };
@@ -132,6 +142,16 @@ class Repeater : public StateMachineComponent<AlarmState> {
   // Getter for the ID.
   std::string doGetId() const override;
 
+  // A repeater is stable while it has no alarms to forward.
+  bool doIsStable() const override;
+
+  // Hashes the state machine state, the backoff, and the stored alarms.
+  bool doHashState(StateHasher* hasher) const override;
+
+  // Checkpoints of the hashed state.
+  bool doSaveState(CheckpointWriter* writer) const override;
+  bool doLoadState(CheckpointReader* reader) override;
+
   // XML conversion.
   std::vector<std::string> doToXML() const override;
 };
@@ -164,6 +184,17 @@ class Sensor : public StateMachineComponent<AlarmState> {
   // Getter for the ID.
   std::string doGetId() const override;
 
+  // A sensor is stable once its alarm was acknowledged.
+  bool doIsStable() const override
+    { return getState() == AlarmState::DONE_SEN; }
+
+  // Hashes the state machine state and the backoff.
+  bool doHashState(StateHasher* hasher) const override;
+
+  // Checkpoints of the hashed state.
+  bool doSaveState(CheckpointWriter* writer) const override;
+  bool doLoadState(CheckpointReader* reader) override;
+
   // XML conversion.
   std::vector<std::string> doToXML() const override;
 };
@@ -194,6 +225,9 @@ class ProtocolMessage : public Message {
   static const ProtocolMessage* getMessage(MessageType type,
     const Component* from, const Component* to, const Component* data);
 
+  // Get the family of all messages, for registering them on first use.
+  static const MessageFamily* getFamily();
+
   // Cleans up all messages.
   static void clean();
 
@@ -75,6 +75,27 @@ AlarmState CentralUnit::doStateAct(ANLView* view, AlarmState state) {
   }
 }
 
+// _____________________________________________________________________________
+bool CentralUnit::doHashState(StateHasher* hasher) const {
+  hasher->addValue(getState());
+  return true;
+}
+
+// _____________________________________________________________________________
+bool CentralUnit::doSaveState(CheckpointWriter* writer) const {
+  return writer->writeValue(getState());
+}
+
+// _____________________________________________________________________________
+bool CentralUnit::doLoadState(CheckpointReader* reader) {
+  AlarmState state = AlarmState::INITIAL_CU;
+  if (!reader->readValue(&state)) {
+    return false;
+  }
+  setState(state);
+  return true;
+}
+
 // _____________________________________________________________________________
 std::vector<std::string> CentralUnit::doToXML() const {
   std::vector<std::string> result;
@@ -28,54 +28,39 @@
 // Part of the ALARM example.
 
 #include <sstream>
-#include <unordered_map>
 #include "./alarm.h"
 
 // _____________________________________________________________________________
-// Required for old implementations of g++ which don't handle enum hashing.
-struct EnumHasher {
-  template<class T>
-  std::size_t operator()(T enumVal) const {
-    // Use the integer constant of the enumeration value as the hash.
-    return static_cast<std::size_t>(enumVal);
-  }
-};
+using MessageInternerType = MessageInterner<ProtocolMessage, MessageType,
+  const Component*, const Component*, const Component*>;
 
 // _____________________________________________________________________________
-using MessageMap = std::unordered_map<MessageType,
-    std::unordered_map<const Component*,
-      std::unordered_map<const Component*,
-        std::unordered_map<const Component*, const ProtocolMessage*>
-      >
-    >,
-    EnumHasher
-  >;
+// The interner of all messages, created on first use.
+static MessageInternerType* gMessageInterner = nullptr;
 
 // _____________________________________________________________________________
-static MessageMap gMessageMap;
+static MessageInternerType* getInterner() {
+  if (gMessageInterner == nullptr) {
+    gMessageInterner = new MessageInternerType();
+  }
+  return gMessageInterner;
+}
 
 // _____________________________________________________________________________
 const ProtocolMessage* ProtocolMessage::getMessage(MessageType type,
     const Component* from, const Component* to, const Component* data) {
-  std::size_t count = gMessageMap[type][from][to].count(data);
-  if (count == 0) {
-    gMessageMap[type][from][to][data] =
-      new ProtocolMessage(type, from, to, data);
-  }
-  return gMessageMap[type][from][to][data];
+  return getInterner()->get(type, from, to, data);
+}
+
+// _____________________________________________________________________________
+const MessageFamily* ProtocolMessage::getFamily() {
+  return getInterner();
 }
 
 // _____________________________________________________________________________
 void ProtocolMessage::clean() {
-  for (auto& x : gMessageMap) {
-    for (auto& y : x.second) {
-      for (auto& z : y.second) {
-        for (auto& w : z.second) {
-          delete w.second;
-        }
-      }
-    }
-  }
+  delete gMessageInterner;
+  gMessageInterner = nullptr;
 }
 
 // _____________________________________________________________________________
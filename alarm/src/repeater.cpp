@@ -96,7 +96,7 @@ AlarmState Repeater::doStateAct(ANLView* view, AlarmState state) {
             const ProtocolMessage* reply = ProtocolMessage::getMessage(
               MessageType::ACK, this, msg->getFrom(), msg->getData());
             addAlarm(msg->getData());
-            view->logProtocol(getId() + ": added alarm to stack: "
+            view->logProtocol("added alarm to stack: "
               + msg->getData()->getId());
             view->send(reply, 0, false);
             return AlarmState::FORWARD_ALARMS_REP;  // A
@@ -173,7 +173,7 @@ AlarmState Repeater::doStateAct(ANLView* view, AlarmState state) {
             //  not support the extra actions in FORWARD_ALARMS_REP, we do this
             //  here as we could only have one alarm at a time otherwise.
             view->listen();
-            view->logProtocol(getId() + ": latest alarm marked as done");
+            view->logProtocol("latest alarm marked as done");
             mAlarmCount--;
             mPriority = 0;
             mCollision = 0;
@@ -200,6 +200,53 @@ std::string Repeater::doGetId() const {
   return sstr.str();
 }
 
+// _____________________________________________________________________________
+bool Repeater::doIsStable() const {
+  return mAlarmCount == 0 && (getState() == AlarmState::INITIAL_REP
+    || getState() == AlarmState::WAIT_FOR_ALARM_REP);
+}
+
+// _____________________________________________________________________________
+bool Repeater::doHashState(StateHasher* hasher) const {
+  hasher->addValue(getState());
+  hasher->addValue(mPriority);
+  hasher->addValue(mCollision);
+  hasher->addValue(mAlarmCount);
+  for (std::size_t i = 0; i < mAlarmCount; i++) {
+    hasher->addPointer(mAlarms[i]);
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+bool Repeater::doSaveState(CheckpointWriter* writer) const {
+  writer->writeValue(getState());
+  writer->writeValue(mPriority);
+  writer->writeValue(mCollision);
+  writer->writeValue(mAlarmCount);
+  for (std::size_t i = 0; i < mAlarmCount; i++) {
+    writer->writeComponent(mAlarms[i]);
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+bool Repeater::doLoadState(CheckpointReader* reader) {
+  AlarmState state = AlarmState::INITIAL_REP;
+  if (!reader->readValue(&state) || !reader->readValue(&mPriority)
+      || !reader->readValue(&mCollision) || !reader->readValue(&mAlarmCount)
+      || mAlarmCount > sizeof(mAlarms) / sizeof(mAlarms[0])) {
+    return false;
+  }
+  for (std::size_t i = 0; i < mAlarmCount; i++) {
+    if (!reader->readComponent(&mAlarms[i])) {
+      return false;
+    }
+  }
+  setState(state);
+  return true;
+}
+
 // _____________________________________________________________________________
 std::vector<std::string> Repeater::doToXML() const {
   std::vector<std::string> result;
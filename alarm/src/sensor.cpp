@@ -137,6 +137,33 @@ std::string Sensor::doGetId() const {
   return sstr.str();
 }
 
+// _____________________________________________________________________________
+bool Sensor::doHashState(StateHasher* hasher) const {
+  hasher->addValue(getState());
+  hasher->addValue(mPriority);
+  hasher->addValue(mCollision);
+  return true;
+}
+
+// _____________________________________________________________________________
+bool Sensor::doSaveState(CheckpointWriter* writer) const {
+  writer->writeValue(getState());
+  writer->writeValue(mPriority);
+  writer->writeValue(mCollision);
+  return true;
+}
+
+// _____________________________________________________________________________
+bool Sensor::doLoadState(CheckpointReader* reader) {
+  AlarmState state = AlarmState::INITIAL_SEN;
+  if (!reader->readValue(&state) || !reader->readValue(&mPriority)
+      || !reader->readValue(&mCollision)) {
+    return false;
+  }
+  setState(state);
+  return true;
+}
+
 // _____________________________________________________________________________
 std::vector<std::string> Sensor::doToXML() const {
   std::vector<std::string> result;
@@ -32,11 +32,17 @@
 
 // Include everything that is relevant for use as a library.
 #include "anl/core/anl.h"
+#include "anl/core/checkpoint.h"
 #include "anl/core/entry_point.h"
+#include "anl/core/message_interner.h"
+#include "anl/core/message_pool.h"
+#include "anl/core/replay.h"
 #include "anl/core/simulator.h"
 #include "anl/core/statemachine.h"
+#include "anl/core/sweep.h"
 #include "anl/core/topologies.h"
 #include "anl/core/types.h"
+#include "anl/misc/log.h"
 #include "anl/output/output.h"
 
 // Import important names, if not disabled.
@@ -44,16 +50,34 @@
 
 using Core::ActionType;
 using Core::ANLView;
+using Core::CheckpointReader;
+using Core::CheckpointWriter;
 using Core::Component;
 using Core::ComponentAction;
+using Core::CycleMode;
 using Core::ExplicitNetworkTopology;
+using Core::IntentLogReplayer;
 using Core::IsolatedNetworkTopology;
 using Core::Message;
+using Core::MessageFamily;
+using Core::MessageInterner;
+using Core::MessagePool;
 using Core::NetworkTopology;
+using Core::ParameterSweep;
+using Core::Parameters;
+using Core::QuiescenceMode;
 using Core::Simulator;
+using Core::StateHasher;
 using Core::StateMachineComponent;
 using Core::TrivialNetworkTopology;
+using Core::UnitDiskNetworkTopology;
+using Output::FilterOutputModule;
+using Output::IndexOutputModule;
+using Output::IntentLogOutputModule;
+using Output::RecordOutputModule;
+using Output::StatisticsOutputModule;
 using Output::StdOutOutputModule;
+using Output::TeeOutputModule;
 using Output::XMLOutputModule;
 
 #endif  // ANL_NO_USING
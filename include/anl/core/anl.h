@@ -32,12 +32,18 @@
 
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include "anl/core/types.h"
 
+// The arena for scratch memory (see arena.h).
+namespace Misc {
+class Arena;
+}  // namespace Misc
+
 // This file contains the ANL from the CORE module.
 namespace Core {
 
@@ -47,6 +53,16 @@ namespace Core {
 // *  order to be easier to understand for developers knowing the report.
 
 
+// The protocol log (see protocol_log.h).
+class ProtocolLog;
+
+// A family of messages (see message_pool.h).
+class MessageFamily;
+
+// The incremental transition algorithm (see anl_algorithm.h).
+class IncrementalANLComputer;
+
+
 // A network setup (see report).
 class NetworkSetup {
  public:
@@ -57,16 +73,42 @@ class NetworkSetup {
   //  message directly after creating the network setup.
   void registerMessage(const Message* msg);
 
+  // Registers a family of messages with the network setup. Messages of the
+  //  family are registered on first use, i.e. when they are first checked by
+  //  isMessage or rendered. The family is not owned by the setup.
+  void registerMessageFamily(const MessageFamily* family);
+
   // Registers a component with the network setup. This must be done once per
-  //  component directly after creating the network setup.
+  //  component directly after creating the network setup. The ID and the XML
+  //  representation of the component are cached at this point, thus they must
+  //  not change afterwards.
   void registerComponent(Component* comp);
 
-  // Checks whether or not a message is registered in this network setup.
-  bool isMessage(const Message* msg) const;
+  // Checks whether or not a message is registered in this network setup,
+  //  directly or through one of its message families.
+  bool isMessage(const Message* msg) const
+    { return findMessage(msg) != nullptr; }
 
   // Checks whether or not a component is registered in this network setup.
   bool isComponent(const Component& comp) const;
 
+  // Gets the textual representation of a registered message. It is rendered
+  //  on first use and cached afterwards, thus the message must not change
+  //  once registered.
+  const std::string& getMessageString(const Message* msg) const;
+
+  // Gets the XML representation of a registered message. Cached like the
+  //  textual representation.
+  const std::vector<std::string>& getMessageXML(const Message* msg) const;
+
+  // Like getMessageString, but returns nullptr if the message is not
+  //  registered. Takes a single lookup, unlike isMessage followed by
+  //  getMessageString.
+  const std::string* findMessageString(const Message* msg) const;
+
+  // Like getMessageXML, but returns nullptr if the message is not registered.
+  const std::vector<std::string>* findMessageXML(const Message* msg) const;
+
   // Executes the given function for all components in this setup. The order of
   //  the components is guaranteed to be the registration order.
   void forEachComponent(std::function<void(Component*)>) const;
@@ -74,6 +116,42 @@ class NetworkSetup {
   // Gets the number of components in the setup.
   std::size_t getComponentCount() const { return mComponents.size(); }
 
+  // Gets the index of a registered component. Indices are assigned in
+  //  registration order, starting at zero.
+  std::size_t getComponentIndex(const Component* comp) const;
+
+  // Gets the component with the given index.
+  Component* getComponentAt(std::size_t index) const
+    { return mComponents.at(index); }
+
+  // Gets the cached ID of a registered component.
+  const std::string& getComponentId(const Component* comp) const
+    { return mComponentIds[getComponentIndex(comp)]; }
+
+  // Gets the cached ID of the component with the given index.
+  const std::string& getComponentIdAt(std::size_t index) const
+    { return mComponentIds.at(index); }
+
+  // Gets the cached XML representation of a registered component.
+  const std::vector<std::string>& getComponentXML(const Component* comp) const
+    { return mComponentXML[getComponentIndex(comp)]; }
+
+  // Gets the number of messages registered by registerMessage.
+  std::size_t getRegisteredMessageCount() const
+    { return mRegisteredMessages.size(); }
+
+  // Gets the message with the given index, in the order of registerMessage.
+  const Message* getRegisteredMessageAt(std::size_t index) const
+    { return mRegisteredMessages.at(index); }
+
+  // Gets the number of registered message families.
+  std::size_t getMessageFamilyCount() const
+    { return mMessageFamilies.size(); }
+
+  // Gets the message family with the given index, in registration order.
+  const MessageFamily* getMessageFamilyAt(std::size_t index) const
+    { return mMessageFamilies.at(index); }
+
   // Gets the number of tics per slot.
   std::size_t getTicsPerSlot() const { return mTicsPerSlot; }
 
@@ -81,11 +159,39 @@ class NetworkSetup {
   // The number of tics per slot.
   std::size_t mTicsPerSlot;
 
-  // The messages that are recognized by the network.
-  std::unordered_set<const Message*> mMessages;
+  // The lazily rendered representations of a registered message.
+  struct MessageCache {
+    bool mHasString = false;
+    bool mHasXML = false;
+    std::string mString;
+    std::vector<std::string> mXML;
+  };
+
+  // The messages that are recognized by the network, together with their
+  //  cached representations. Mutable as the caches are filled on first use.
+  mutable std::unordered_map<const Message*, MessageCache> mMessages;
+
+  // The messages registered by registerMessage, in registration order.
+  std::vector<const Message*> mRegisteredMessages;
+
+  // The message families whose messages are recognized as well.
+  std::vector<const MessageFamily*> mMessageFamilies;
+
+  // Finds the cache of a message. Messages of a message family are registered
+  //  on the first lookup. Returns nullptr if the message is not recognized.
+  MessageCache* findMessage(const Message* msg) const;
 
   // The components that the network consists of.
   std::vector<Component*> mComponents;
+
+  // The indices of the components, i.e. their positions in mComponents.
+  std::unordered_map<const Component*, std::size_t> mComponentIndices;
+
+  // The cached IDs of the components, in registration order.
+  std::vector<std::string> mComponentIds;
+
+  // The cached XML representations of the components, in registration order.
+  std::vector<std::vector<std::string>> mComponentXML;
 };
 
 
@@ -149,9 +255,21 @@ class ComponentTrait {
   // Creates a string that represents this component trait textually.
   std::string toString() const;
 
+  // Appends the textual representation of this component trait to the buffer.
+  //  Messages registered with the given network setup are taken from its
+  //  caches. The setup may be nullptr, in which case messages are rendered.
+  void appendText(std::string* buffer, const NetworkSetup* setup) const;
+
   // Creates an XML representation of this component trait.
   std::vector<std::string> toXML() const;
 
+  // Appends the XML representation of this component trait to the buffer. Each
+  //  line is indented by the given number of spaces and terminated by a
+  //  newline. Messages are taken from the caches of the setup like in
+  //  appendText.
+  void appendXML(std::string* buffer, std::size_t indent,
+    const NetworkSetup* setup) const;
+
   // Getters.
   T getType() const { return mType; }
   std::size_t getTic() const { return mTic; }
@@ -191,21 +309,64 @@ class TraitMapping {
   //  components.
   void setTraitFor(const Component* comp, const ComponentTrait<T>& trait);
 
+  // Checks whether or not a trait is set for the component. Unlike
+  //  getTraitFor, this may be used on partial mappings.
+  bool hasTraitFor(const Component* comp) const;
+
+  // Retrieves the trait for the component with the given registration index.
+  //  Must not be used on partial mappings.
+  const ComponentTrait<T>& getTraitAt(std::size_t index) const;
+
+  // Replaces the trait of a component. Unlike setTraitFor, the component must
+  //  already have a trait. Used for patching mappings in place.
+  void replaceTraitFor(const Component* comp, const ComponentTrait<T>& trait);
+
+  // Executes the given function for all components and their traits in this
+  //  mapping. The order of the components is guaranteed to be the
+  //  registration order. Must not be used on partial mappings.
+  void forEachTrait(
+    std::function<void(const Component*, const ComponentTrait<T>&)> cb) const;
+
   // Creates a string that represents this component trait mapping textually.
   std::string toString() const;
 
+  // Appends the textual representation of this mapping to the buffer.
+  void appendText(std::string* buffer) const;
+
   // Creates an XML representation of this component trait mapping.
   std::vector<std::string> toXML() const;
 
+  // Appends the XML representation of this mapping to the buffer. Each line is
+  //  indented by the given number of spaces and terminated by a newline.
+  void appendXML(std::string* buffer, std::size_t indent) const;
+
   // Checks whether this mapping is partial or not.
   bool isPartial() const { return mPartial; }
 
+  // Operators. Mappings are equal if they map the same components to equal
+  //  traits.
+  bool operator==(const TraitMapping<T>& other) const;
+  bool operator!=(const TraitMapping<T>& other) const
+    { return !(*this == other); }
+
+  // Adds the mapping to the hasher. Messages are hashed by their address, thus
+  //  equal messages at different addresses hash differently.
+  void hashState(StateHasher* hasher) const;
+
  private:
   // The underlying network setup.
   const NetworkSetup* mSetup;
 
-  // A mapping Component -> ComponentTrait that is the 'actual' trait mapping.
-  std::unordered_map<const Component*, ComponentTrait<T>> mMapping;
+  // The traits, indexed by the registration index of their component. The
+  //  storage is contiguous, so copying a mapping takes a single allocation.
+  //  Traits of components that are not mapped yet are placeholders.
+  std::vector<ComponentTrait<T>> mTraits;
+
+  // Whether or not the trait at the same index is set.
+  std::vector<bool> mIsSet;
+
+  // The number of set traits.
+  std::size_t mCount;
 
   // Whether or not the mapping is partial. Used for checking invariants.
   bool mPartial;
@@ -242,6 +403,9 @@ class ANL {
   // Constructor.
   explicit ANL(const NetworkSetup* setup, ANLSemantics semantics);
 
+  // Destructor.
+  ~ANL();
+
   // This method provides \psi.
   std::vector<NetworkState> transition(const NetworkTopology* topo,
     const IntentionAssignment* intent) const;
@@ -253,12 +417,36 @@ class ANL {
   void runSlot(std::size_t slot, const NetworkState* prevState,
     IntentionAssignment* targetIntent);
 
+  // Sets the protocol log that the components of subsequent slots log to. If
+  //  nullptr (the default), messages are written to the log directly.
+  void useProtocolLog(ProtocolLog* log) { mProtocolLog = log; }
+
+  // Sets the arena that transitions allocate their temporary data from. The
+  //  arena may be released after each transition. If nullptr (the default),
+  //  the heap is used.
+  void useScratchArena(Misc::Arena* arena) { mScratchArena = arena; }
+
+  // Sets whether or not transitions are computed incrementally, i.e. by
+  //  patching the network state of the previous transition where intentions
+  //  changed. Requires the deterministic NAIVE semantics. Defaults to false.
+  void useIncrementalTransitions(bool incremental);
+
  private:
   // The underlying network setup.
   const NetworkSetup* mSetup;
 
   // The ANL semantics that are used.
   const ANLSemantics mSemantics;
+
+  // The protocol log of the components. May be nullptr.
+  ProtocolLog* mProtocolLog;
+
+  // The arena for temporary data of transitions. May be nullptr.
+  Misc::Arena* mScratchArena;
+
+  // The state of incremental transitions. nullptr if transitions are computed
+  //  from scratch. Mutable as it is updated by every transition.
+  mutable std::unique_ptr<IncrementalANLComputer> mIncremental;
 };
 
 
@@ -266,11 +454,13 @@ class ANL {
 //  protocol designer.
 class ANLView {
  public:
-  // Constructors.
+  // Constructors. Protocol log messages are added to the given protocol log
+  //  or, if nullptr, written to the log directly.
   ANLView(const NetworkSetup* setup, std::size_t slot, const Component* comp,
-    IntentionAssignment* targetIntent);
+    IntentionAssignment* targetIntent, ProtocolLog* log = nullptr);
   ANLView(const NetworkSetup* setup, std::size_t slot, const Component* comp,
-    const ComponentAction& prev, IntentionAssignment* targetIntent);
+    const ComponentAction& prev, IntentionAssignment* targetIntent,
+    ProtocolLog* log = nullptr);
 
   // This causes the component to idle in the associated slot.
   void idle();
@@ -297,8 +487,8 @@ class ANLView {
   // Checks whether or not the component has already acted.
   bool hasActed() const { return mActed; }
 
-  // Adds a message to the protocol log (not included in the output, but printed
-  //  on stderr).
+  // Adds a message to the protocol log. The message is tagged with the slot and
+  //  the component of this view.
   void logProtocol(const std::string& msg) const;
 
  private:
@@ -322,6 +512,9 @@ class ANLView {
 
   // Whether this component has already acted in the associated slot.
   bool mActed;
+
+  // The protocol log. May be nullptr.
+  ProtocolLog* mProtocolLog;
 };
 
 
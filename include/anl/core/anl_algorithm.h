@@ -31,8 +31,13 @@
 #define ANL_CORE_ANL_ALGORITHM_H_
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
 #include <vector>
 #include "anl/core/anl.h"
+#include "anl/misc/arena.h"
 
 // This file contains algorithms for the ANL from the CORE module.
 namespace Core {
@@ -45,9 +50,11 @@ using SenderSetRepresentation = NetworkState;
 // The class that provides the sender-set algorithm.
 class SenderSetComputer {
  public:
-  // Constructor.
+  // Constructor. Temporary sets are allocated from the given scratch arena,
+  //  or from the heap if nullptr.
   explicit SenderSetComputer(const NetworkSetup* setup,
-    const NetworkTopology* topo, const IntentionAssignment* intent);
+    const NetworkTopology* topo, const IntentionAssignment* intent,
+    Misc::Arena* scratch = nullptr);
 
   // Determines the sender set.
   SenderSetRepresentation getSenderSet();
@@ -65,12 +72,18 @@ class SenderSetComputer {
   // The tic of the current iteration.
   std::size_t mIterationTic;
 
-  // The sending components. In between iterations this contains the key set
-  //  of the SenderSetRepresentation.
-  std::unordered_set<const Component*> mSendingComponents;
+  // A set of components. Every component starts sending at most once, thus
+  //  the sets are vectors without duplicates.
+  using ComponentSet = std::vector<const Component*,
+    Misc::ArenaAllocator<const Component*>>;
+
+  // Marks of the components that can be reached by a sending component and
+  //  thus detect an occupied medium by carrier sensing, by component index.
+  //  Only updated between iterations.
+  std::vector<bool, Misc::ArenaAllocator<bool>> mSensed;
 
   // The newly sending components. In between iterations this is empty.
-  std::unordered_set<const Component*> mNewlySendingComponents;
+  ComponentSet mNewlySendingComponents;
 
   // The resulting sender set. We will use the same object for all sets S_i as
   //  the sets just grow. Thus we are able to create the final sender set using
@@ -106,9 +119,11 @@ using FilterFunction = std::function<void(const NetworkSetup&,
 // The class that provides the algorithms for the transition function.
 class ANLComputer {
  public:
-  // Constructor.
+  // Constructor. Temporary data is allocated from the given scratch arena, or
+  //  from the heap if nullptr.
   ANLComputer(const NetworkSetup* setup, const NetworkTopology* topo,
-    const IntentionAssignment* intent, FilterFunction filter);
+    const IntentionAssignment* intent, FilterFunction filter,
+    Misc::Arena* scratch = nullptr);
 
   // This method provides \psi.
   std::vector<NetworkState> transition();
@@ -126,14 +141,132 @@ class ANLComputer {
   // The filter function that will be used for pruning.
   const FilterFunction mFilter;
 
+  // The scratch arena. May be nullptr.
+  Misc::Arena* mScratch;
+
   // The sender set that is determined for the computation.
   SenderSetRepresentation mSenderSet;
 
+  // The sending components that can reach each component, by component index
+  //  and in registration order.
+  std::vector<std::vector<const Component*>> mSendingNeighbors;
+
   // Determines all possible component actions using the semantics of the ANL.
   std::vector<ComponentAction> getPossibleActions(const Component* comp) const;
 };
 
 
+// The class that provides the transition function incrementally. It keeps the
+//  intention assignment, the sender set and the network state of the previous
+//  transition. The next transition only recomputes the components whose
+//  intention changed and the components that can be reached by a sender whose
+//  entry in the sender set changed, and patches the previous network state.
+//  The filter must be deterministic, i.e. leave exactly one component action.
+//
+//  Comparing the intention assignments is linear in the number of components.
+//  Every intended sender counts the senders of earlier tics it hears, thus
+//  carrier sensing is decided in constant time. It is only decided again for
+//  the components whose intention changed, and for the intended senders whose
+//  count drops to or rises from zero as a sender they hear appears or
+//  disappears, in the order of their tics. The receptions are kept per
+//  component and only updated for the components reachable by the senders
+//  whose entry changed. Both only enumerate the components reachable by these
+//  senders (see NetworkTopology::forEachReachable).
+class IncrementalANLComputer {
+ public:
+  // Constructor.
+  IncrementalANLComputer(const NetworkSetup* setup, FilterFunction filter);
+
+  // Computes the network state that follows from the intention assignment.
+  //  The first transition, and every transition with another topology than
+  //  the previous one or with a changed topology (see
+  //  NetworkTopology::getGeneration), is computed from scratch. Temporary
+  //  data is allocated from the given scratch arena, or from the heap if
+  //  nullptr.
+  NetworkState transition(const NetworkTopology* topo,
+    const IntentionAssignment* intent, Misc::Arena* scratch = nullptr);
+
+  // Gets the number of components whose component action was recomputed by
+  //  the last transition.
+  std::size_t getRecomputedCount() const { return mRecomputed; }
+
+ private:
+  // The entry of a component in the sender set.
+  struct Sender {
+    bool sends;
+    std::size_t tic;
+    const Message* message;
+  };
+
+  // A list of component indices.
+  using IndexList = std::vector<std::size_t, Misc::ArenaAllocator<std::size_t>>;
+
+  // The components whose carrier sensing is decided again, as pairs of tic and
+  //  index, earliest tic first.
+  using DecisionKey = std::pair<std::size_t, std::size_t>;
+  using DecisionList =
+    std::vector<DecisionKey, Misc::ArenaAllocator<DecisionKey>>;
+  using DecisionQueue = std::priority_queue<DecisionKey, DecisionList,
+    std::greater<DecisionKey>>;
+
+  // The underlying network setup.
+  const NetworkSetup* mSetup;
+
+  // The filter function that will be used for pruning.
+  const FilterFunction mFilter;
+
+  // The topology of the previous transition. nullptr before the first one.
+  const NetworkTopology* mTopology;
+
+  // The generation of the topology at the previous transition.
+  std::uint64_t mTopologyGeneration;
+
+  // The intention assignment of the previous transition.
+  IntentionAssignment mIntent;
+
+  // The network state of the previous transition.
+  NetworkState mState;
+
+  // The sender set of the previous transition, by component index.
+  std::vector<Sender> mSenders;
+
+  // The number of senders in the sender set that start sending before the
+  //  intended tic of each component and can reach it, by component index.
+  //  Only kept for the components that intend to send.
+  std::vector<std::size_t> mHeard;
+
+  // The indices of the senders in the sender set that can reach each
+  //  component, by component index and ordered.
+  std::vector<std::vector<std::size_t>> mReachingSenders;
+
+  // Marks of the components that are recomputed, by index. All false in
+  //  between transitions.
+  std::vector<bool> mAffected;
+
+  // The number of recomputed components in the last transition.
+  std::size_t mRecomputed;
+
+  // Computes the transition from scratch.
+  void transitionFully(const NetworkTopology* topo,
+    const IntentionAssignment* intent, Misc::Arena* scratch);
+
+  // Counts the senders in the sender set that the component with the given
+  //  index hears before its intended tic.
+  std::size_t countHeard(std::size_t index) const;
+
+  // Decides carrier sensing for the queued components, like the
+  //  SenderSetComputer, and updates their entries in the sender set. Calls
+  //  the given function for every component whose entry changed and every
+  //  component it can reach.
+  void decideSenders(DecisionQueue* queue,
+    const std::function<void(std::size_t)>& mark);
+
+  // Determines the component action of the component with the given index,
+  //  using the current intention assignment and sender set.
+  ComponentAction computeAction(std::size_t index) const;
+};
+
+
 // Filter function that filters nothing.
 void ANLFilterNothing(const NetworkSetup& setup,
   std::vector<ComponentAction>* inout);
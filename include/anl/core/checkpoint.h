@@ -0,0 +1,247 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+
+#ifndef ANL_CORE_CHECKPOINT_H_
+#define ANL_CORE_CHECKPOINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include "anl/core/anl.h"
+#include "anl/core/types.h"
+
+// This file contains the checkpoints of simulations from the CORE module.
+namespace Core {
+
+
+// Constants of the checkpoint format. A checkpoint holds everything that is
+//  needed to continue a simulation after the slot it was taken at. It is
+//  written by the simulator (see Simulator::useCheckpoints).
+//
+//  Numbers and strings are encoded like in the intent log (see IntentLog).
+//  The checkpoint starts with kMagic, the number of tics per slot, the number
+//  of components, the number of the next slot, and the state of the
+//  pseudo-random number generator as a string. The previous network state
+//  follows as the action type, tic, and message of every component. Then
+//  follow the states of the components (see
+//  Component::saveState) and of the output module (see
+//  Output::OutputModule::saveState), whose encodings are up to them.
+//
+//  Components are encoded by their index plus one, and zero for nullptr.
+//  Messages are encoded by a tag: kNoMessage for nullptr, kRegisteredMessage
+//  followed by the index of a registered message (see
+//  NetworkSetup::getRegisteredMessageAt), or kFamilyMessage followed by the
+//  index of its family and its key (see MessageFamily::saveMessage).
+struct Checkpoint {
+  // The magic bytes at the beginning of a checkpoint.
+  static const char kMagic[8];
+
+  // The message tags.
+  static const std::uint64_t kNoMessage = 0;
+  static const std::uint64_t kRegisteredMessage = 1;
+  static const std::uint64_t kFamilyMessage = 2;
+};
+
+
+// Encodes the state of a simulation into a checkpoint.
+class CheckpointWriter {
+ public:
+  // Constructor. Components and messages are encoded relative to the given
+  //  setup.
+  explicit CheckpointWriter(const NetworkSetup* setup);
+
+  // Writes the magic bytes.
+  void writeMagic();
+
+  // Writes a number.
+  void writeNumber(std::uint64_t value);
+
+  // Writes a string.
+  void writeString(const std::string& str);
+
+  // Writes a registered component, or nullptr.
+  void writeComponent(const Component* comp);
+
+  // Writes a registered message, or nullptr. Returns false if the message can
+  //  not be written, i.e. it is not registered or its family does not support
+  //  checkpoints.
+  bool writeMessage(const Message* msg);
+
+  // Writes a complete network state. Returns false if one of its messages can
+  //  not be written.
+  bool writeState(const NetworkState& state);
+
+  // Writes a value of an integral or enumeration type as a number. Returns
+  //  false for other types, which are not supported.
+  template<class T>
+  bool writeValue(const T& value) {
+    return writeIntegral(value, std::integral_constant<bool,
+      std::is_integral<T>::value || std::is_enum<T>::value>());
+  }
+
+  // Writes a registered component, or nullptr.
+  bool writeValue(const Component* comp) {
+    writeComponent(comp);
+    return true;
+  }
+
+  // Writes a string.
+  bool writeValue(const std::string& str) {
+    writeString(str);
+    return true;
+  }
+
+  // Gets the encoded checkpoint.
+  const std::string& getData() const { return mData; }
+
+ private:
+  // The underlying network setup.
+  const NetworkSetup* mSetup;
+
+  // The indices of the registered messages.
+  std::unordered_map<const Message*, std::size_t> mMessageIndices;
+
+  // The encoded checkpoint.
+  std::string mData;
+
+  // Writes a value of an integral or enumeration type.
+  template<class T>
+  bool writeIntegral(const T& value, std::true_type) {
+    writeNumber(static_cast<std::uint64_t>(value));
+    return true;
+  }
+
+  // Rejects a value of an unsupported type.
+  template<class T>
+  bool writeIntegral(const T& value, std::false_type) { return false; }
+};
+
+
+// Decodes a checkpoint written by CheckpointWriter. All read methods return
+//  false if the checkpoint is malformed.
+class CheckpointReader {
+ public:
+  // Constructor. Components and messages are decoded relative to the given
+  //  setup, which must equal the one the checkpoint was written with.
+  CheckpointReader(const NetworkSetup* setup, std::string&& data);
+
+  // Reads the magic bytes.
+  bool readMagic();
+
+  // Reads a number.
+  bool readNumber(std::uint64_t* value);
+
+  // Reads a string.
+  bool readString(std::string* str);
+
+  // Reads a registered component, or nullptr.
+  bool readComponent(const Component** comp);
+
+  // Reads a registered message, or nullptr. Messages of families are created
+  //  if necessary.
+  bool readMessage(const Message** msg);
+
+  // Reads a complete network state into an empty mapping.
+  bool readState(NetworkState* state);
+
+  // Reads a value of an integral or enumeration type. Returns false for other
+  //  types, which are not supported, and for values out of range.
+  template<class T>
+  bool readValue(T* value) {
+    return readIntegral(value, std::integral_constant<bool,
+      std::is_integral<T>::value || std::is_enum<T>::value>());
+  }
+
+  // Reads a registered component, or nullptr.
+  bool readValue(const Component** comp) { return readComponent(comp); }
+
+  // Reads a string.
+  bool readValue(std::string* str) { return readString(str); }
+
+  // Checks whether or not the whole checkpoint was read.
+  bool atEnd() const { return mPos == mData.size(); }
+
+ private:
+  // The underlying network setup.
+  const NetworkSetup* mSetup;
+
+  // The encoded checkpoint.
+  std::string mData;
+
+  // The position of the next value in mData.
+  std::size_t mPos;
+
+  // Reads a value of an integral or enumeration type.
+  template<class T>
+  bool readIntegral(T* value, std::true_type) {
+    std::uint64_t number = 0;
+    if (!readNumber(&number)) {
+      return false;
+    }
+    *value = static_cast<T>(number);
+    return static_cast<std::uint64_t>(*value) == number;
+  }
+
+  // Rejects a value of an unsupported type.
+  template<class T>
+  bool readIntegral(T* value, std::false_type) { return false; }
+};
+
+
+// Writes and reads the first N parts of a tuple one by one, e.g. the key of a
+//  message (see MessageFamily::saveMessage).
+template<class Tuple, std::size_t N = std::tuple_size<Tuple>::value>
+struct CheckpointTuple {
+  static bool write(CheckpointWriter* writer, const Tuple& tuple) {
+    return CheckpointTuple<Tuple, N - 1>::write(writer, tuple)
+      && writer->writeValue(std::get<N - 1>(tuple));
+  }
+
+  static bool read(CheckpointReader* reader, Tuple* tuple) {
+    return CheckpointTuple<Tuple, N - 1>::read(reader, tuple)
+      && reader->readValue(&std::get<N - 1>(*tuple));
+  }
+};
+
+// _____________________________________________________________________________
+template<class Tuple>
+struct CheckpointTuple<Tuple, 0> {
+  static bool write(CheckpointWriter* writer, const Tuple& tuple) {
+    return true;
+  }
+
+  static bool read(CheckpointReader* reader, Tuple* tuple) { return true; }
+};
+
+
+}  // namespace Core
+
+#endif  // ANL_CORE_CHECKPOINT_H_
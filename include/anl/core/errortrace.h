@@ -30,29 +30,82 @@
 #ifndef ANL_CORE_ERRORTRACE_H_
 #define ANL_CORE_ERRORTRACE_H_
 
-#include <string>
-#include <vector>
+#include <cstddef>
+
+// Whether or not sections are recorded by ANL_TRACE_SECTION. Sections are
+//  recorded in all builds by default. If ANL_ERROR_TRACE is defined as 0,
+//  they are compiled out and errors are reported without the sections they
+//  occurred in.
+#ifndef ANL_ERROR_TRACE
+#define ANL_ERROR_TRACE 1
+#endif
+
+// Enters a section of the given error tracer with the given name (a string
+//  literal) until the end of the enclosing scope.
+#define ANL_TRACE_CONCAT_(a, b) a##b
+#define ANL_TRACE_CONCAT(a, b) ANL_TRACE_CONCAT_(a, b)
+#if ANL_ERROR_TRACE
+#define ANL_TRACE_SECTION(tracer, name) \
+  Core::ErrorTracer::Section ANL_TRACE_CONCAT(anlTraceSection, __LINE__)( \
+    (tracer), (name))
+#else
+#define ANL_TRACE_SECTION(tracer, name) static_cast<void>(0)
+#endif
 
 // This file contains the error tracing helper from the CORE module.
 namespace Core {
 
 
-// The helper class that allows errors in a scope to be printed.
+// The helper class that allows errors in a scope to be printed. The section
+//  names are not copied, thus they must outlive their sections (string
+//  literals are used throughout).
 class ErrorTracer {
  public:
+  // The maximum number of sections that are printed. Deeper sections are
+  //  still counted, but only reported by their number.
+  static const std::size_t kMaxDepth = 32;
+
+  // Scope guard that enters a section on construction and leaves it on
+  //  destruction.
+  class Section {
+   public:
+    // Constructor.
+    Section(ErrorTracer* tracer, const char* name) : mTracer(tracer)
+      { mTracer->enter(name); }
+
+    // Destructor.
+    ~Section() { mTracer->leave(); }
+
+    // A section must be left exactly once, thus it must not be copied.
+    Section(const Section&) = delete;
+    Section& operator=(const Section&) = delete;
+
+   private:
+    // The tracer the section was entered in.
+    ErrorTracer* mTracer;
+  };
+
+  // Constructor.
+  ErrorTracer() : mDepth(0) {}
+
   // Enters a section with the given name.
-  void enter(const std::string& name);
+  void enter(const char* name);
 
   // Leaves the most recent section.
   void leave();
 
+  // Returns the number of sections that were entered and not yet left.
+  std::size_t getDepth() const { return mDepth; }
+
   // Asserts that the given boolean is true. If the assertion fails, an error
   //  trace is printed and the program is terminated.
   void require(bool expr, const char* message);
 
  private:
-  // The vector that stores the current section stack.
-  std::vector<std::string> mSections;
+  // The current section stack. Only the first min(mDepth, kMaxDepth) entries
+  //  are valid.
+  const char* mSections[kMaxDepth];
+  std::size_t mDepth;
 };
 
 
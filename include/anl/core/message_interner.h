@@ -0,0 +1,263 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#ifndef ANL_CORE_MESSAGE_INTERNER_H_
+#define ANL_CORE_MESSAGE_INTERNER_H_
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "anl/core/checkpoint.h"
+#include "anl/core/message_pool.h"
+#include "anl/core/types.h"
+#include "anl/misc/arena.h"
+
+// This file contains the flyweight message interner of the CORE module.
+namespace Core {
+
+
+// Hashes a single part of an interning key. Enumerations are hashed by their
+//  underlying value, as older standard libraries lack std::hash for them.
+template<class T, bool = std::is_enum<T>::value>
+struct InternHash {
+  std::size_t operator()(const T& value) const { return std::hash<T>()(value); }
+};
+
+// _____________________________________________________________________________
+template<class T>
+struct InternHash<T, true> {
+  std::size_t operator()(const T& value) const {
+    using Underlying = typename std::underlying_type<T>::type;
+    return std::hash<Underlying>()(static_cast<Underlying>(value));
+  }
+};
+
+// Hashes the first N parts of an interning key.
+template<class Tuple, std::size_t N = std::tuple_size<Tuple>::value>
+struct InternTupleHash {
+  std::size_t operator()(const Tuple& key) const {
+    using Part = typename std::decay<
+      typename std::tuple_element<N - 1, Tuple>::type>::type;
+    std::size_t hash = InternTupleHash<Tuple, N - 1>()(key);
+    return hash ^ (InternHash<Part>()(std::get<N - 1>(key)) + 0x9E3779B9
+      + (hash << 6) + (hash >> 2));
+  }
+};
+
+// _____________________________________________________________________________
+template<class Tuple>
+struct InternTupleHash<Tuple, 0> {
+  std::size_t operator()(const Tuple& key) const { return 0; }
+};
+
+// A list of tuple indices, for unpacking an interning key into arguments.
+template<std::size_t... I>
+struct InternIndices {};
+
+// Creates the indices 0 to N - 1, appended by the indices I.
+template<std::size_t N, std::size_t... I>
+struct MakeInternIndices : MakeInternIndices<N - 1, N - 1, I...> {};
+
+// _____________________________________________________________________________
+template<std::size_t... I>
+struct MakeInternIndices<0, I...> {
+  using Type = InternIndices<I...>;
+};
+
+// Interns messages of type M which are identified by a tuple of Args. The
+//  message of a key is constructed from the key parts on first use and shared
+//  afterwards. The messages live in an arena, the lookup table is a single flat
+//  table with open addressing, thus a lookup of an existing message does not
+//  allocate. Being a message family, the interner registers all its messages
+//  with a network setup at once (see Simulator::useMessageFamily).
+template<class M, class... Args>
+class MessageInterner : public MessageFamily {
+ public:
+  // The type of the key of a message.
+  using Key = std::tuple<Args...>;
+
+  // Constructor. The messages are allocated from the given arena, which must
+  //  outlive the interner and must not hold other objects than messages (see
+  //  Simulator::getArena), or from an arena of the interner if nullptr.
+  explicit MessageInterner(Misc::Arena* arena = nullptr)
+    : mBuckets(kInitialCapacity), mSize(0),
+      mArena(arena != nullptr ? arena : &mOwnArena) {}
+
+  // Destructor. Destructs all messages.
+  ~MessageInterner() override {
+    for (Bucket& bucket : mBuckets) {
+      if (bucket.node != nullptr) {
+        bucket.node->~Node();
+      }
+    }
+  }
+
+  // Returns the message of the given key, constructing it on first use.
+  const M* get(const Args&... args) {
+    std::size_t hash = hashKey(std::tie(args...));
+    std::size_t mask = mBuckets.size() - 1;
+    for (std::size_t i = hash & mask; mBuckets[i].node != nullptr;
+        i = (i + 1) & mask) {
+      const Bucket& bucket = mBuckets[i];
+      if (bucket.hash == hash && bucket.node->key == std::tie(args...)) {
+        return bucket.node;
+      }
+    }
+    return insert(hash, args...);
+  }
+
+  // Returns the number of messages interned so far.
+  std::size_t size() const { return mSize; }
+
+ private:
+  // A message together with its key and its interner, allocated in the
+  //  arena. Being a message itself, the node of a message is found without
+  //  a lookup.
+  struct Node final : M {
+    explicit Node(const MessageInterner* owner, const Args&... args)
+      : M(args...), owner(owner), key(args...) {}
+    const MessageInterner* owner;
+    Key key;
+  };
+
+  // An entry of the table. Empty if node is nullptr.
+  struct Bucket {
+    std::size_t hash;
+    Node* node;
+  };
+
+  // The initial number of buckets. Must be a power of two.
+  static constexpr std::size_t kInitialCapacity = 64;
+
+  // The table. At most half of the buckets are used.
+  std::vector<Bucket> mBuckets;
+
+  // The number of messages.
+  std::size_t mSize;
+
+  // The arena of the interner, used if no arena was given.
+  Misc::Arena mOwnArena;
+
+  // The memory of the nodes.
+  Misc::Arena* mArena;
+
+  // Hashes a key. The final mixing spreads pointer keys, whose low bits are
+  //  mostly zero, over the low bits that select the bucket.
+  template<class Tuple>
+  static std::size_t hashKey(const Tuple& key) {
+    std::size_t hash = InternTupleHash<Tuple>()(key);
+    hash ^= hash >> 16;
+    hash *= 0x45D9F3B;
+    hash ^= hash >> 16;
+    return hash;
+  }
+
+  // Constructs and stores the message of a key which is not present yet.
+  const M* insert(std::size_t hash, const Args&... args) {
+    if (2 * (mSize + 1) > mBuckets.size()) {
+      grow();
+    }
+    void* memory = mArena->allocate(sizeof(Node), alignof(Node));
+    Node* node = new (memory) Node(this, args...);
+    place(hash, node);
+    mSize++;
+    return node;
+  }
+
+  // Puts a node into the first free bucket of its probe sequence.
+  void place(std::size_t hash, Node* node) {
+    std::size_t mask = mBuckets.size() - 1;
+    std::size_t i = hash & mask;
+    while (mBuckets[i].node != nullptr) {
+      i = (i + 1) & mask;
+    }
+    mBuckets[i].hash = hash;
+    mBuckets[i].node = node;
+  }
+
+  // Doubles the number of buckets.
+  void grow() {
+    std::vector<Bucket> old(mBuckets.size() * 2);
+    old.swap(mBuckets);
+    for (const Bucket& bucket : old) {
+      if (bucket.node != nullptr) {
+        place(bucket.hash, bucket.node);
+      }
+    }
+  }
+
+  // Returns the message of the given key, unpacked by the given indices.
+  template<std::size_t... I>
+  const M* getByKey(const Key& key, InternIndices<I...>) {
+    return get(std::get<I>(key)...);
+  }
+
+  // Membership callback. Only interned messages live in an own arena. A
+  //  shared arena is trusted to hold messages only.
+  bool doContains(const Message* msg) const override {
+    return mArena->owns(msg);
+  }
+
+  // Checkpoint callback. Writes the key of the message, which is stored in
+  //  its node. Messages of other interners that share the arena are rejected
+  //  by their type or owner. Only keys whose parts are of integral,
+  //  enumeration, component, or string type are supported (see
+  //  CheckpointWriter::writeValue).
+  bool doSaveMessage(const Message* msg, CheckpointWriter* writer)
+      const override {
+    const Node* node = dynamic_cast<const Node*>(msg);
+    if (node == nullptr || node->owner != this) {
+      return false;
+    }
+    return CheckpointTuple<Key>::write(writer, node->key);
+  }
+
+  // Checkpoint callback. Interning a missing message does not change the
+  //  family as seen from the outside, thus the interner may do so while const.
+  const Message* doLoadMessage(CheckpointReader* reader) const override {
+    Key key;
+    if (!CheckpointTuple<Key>::read(reader, &key)) {
+      return nullptr;
+    }
+    return const_cast<MessageInterner*>(this)->getByKey(key,
+      typename MakeInternIndices<sizeof...(Args)>::Type());
+  }
+};
+
+// _____________________________________________________________________________
+template<class M, class... Args>
+constexpr std::size_t MessageInterner<M, Args...>::kInitialCapacity;
+
+
+}  // namespace Core
+
+#endif  // ANL_CORE_MESSAGE_INTERNER_H_
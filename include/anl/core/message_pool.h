@@ -0,0 +1,147 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#ifndef ANL_CORE_MESSAGE_POOL_H_
+#define ANL_CORE_MESSAGE_POOL_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include "anl/core/checkpoint.h"
+#include "anl/core/types.h"
+
+// This file contains the declaration of message families and typed message
+//  pools in the CORE module.
+namespace Core {
+
+
+// A family of messages which is registered with a network setup as a whole.
+//  Its messages do not need to be registered one by one: the setup asks the
+//  family whenever it encounters an unknown message.
+class MessageFamily {
+ public:
+  // Virtual destructor.
+  virtual ~MessageFamily() {}
+
+  // Checks whether or not the message belongs to this family. Must be cheap,
+  //  i.e. it must not enumerate the family.
+  bool contains(const Message* msg) const { return doContains(msg); }
+
+  // Writes the key of a message of this family to a checkpoint. Returns false
+  //  if the family does not support checkpoints or does not know the message.
+  bool saveMessage(const Message* msg, CheckpointWriter* writer) const
+    { return doSaveMessage(msg, writer); }
+
+  // Reads a key written by saveMessage and returns its message, creating it if
+  //  necessary. Returns nullptr if the checkpoint is malformed.
+  const Message* loadMessage(CheckpointReader* reader) const
+    { return doLoadMessage(reader); }
+
+ private:
+  // Membership callback.
+  virtual bool doContains(const Message* msg) const = 0;
+
+  // Checkpoint callbacks. Families do not support checkpoints by default.
+  virtual bool doSaveMessage(const Message* msg, CheckpointWriter* writer)
+    const { return false; }
+  virtual const Message* doLoadMessage(CheckpointReader* reader) const
+    { return nullptr; }
+};
+
+// A typed pool of messages. Messages are identified by a key and created by the
+//  factory when they are requested for the first time. The pool owns all its
+//  messages, thus it must outlive every network setup it is registered with.
+template<class M, class Key, class Hash = std::hash<Key>>
+class MessagePool : public MessageFamily {
+ public:
+  // The type of the factory which creates the message of a key.
+  using Factory = std::function<M*(const Key&)>;
+
+  // Constructor.
+  explicit MessagePool(Factory factory) : mFactory(factory) {}
+
+  // Returns the message of the given key, creating it on first use.
+  const M* get(const Key& key) {
+    auto entry = mMessages.find(key);
+    if (entry != mMessages.end()) {
+      return entry->second.get();
+    }
+    M* msg = mFactory(key);
+    entry = mMessages.emplace(key, std::unique_ptr<M>(msg)).first;
+    mKeys.emplace(msg, &entry->first);
+    return msg;
+  }
+
+  // Returns the number of messages created so far.
+  std::size_t size() const { return mMessages.size(); }
+
+ private:
+  // The factory for new messages.
+  Factory mFactory;
+
+  // The created messages by key.
+  std::unordered_map<Key, std::unique_ptr<M>, Hash> mMessages;
+
+  // The keys of the created messages, for membership checks and checkpoints.
+  //  The keys are stored in mMessages, whose elements never move.
+  std::unordered_map<const Message*, const Key*> mKeys;
+
+  // Membership callback.
+  bool doContains(const Message* msg) const override {
+    return mKeys.count(msg) != 0;
+  }
+
+  // Checkpoint callback. Writes the key of the message. Only keys of
+  //  integral, enumeration, component, or string type are supported (see
+  //  CheckpointWriter::writeValue).
+  bool doSaveMessage(const Message* msg, CheckpointWriter* writer)
+      const override {
+    auto entry = mKeys.find(msg);
+    if (entry == mKeys.end()) {
+      return false;
+    }
+    return writer->writeValue(*entry->second);
+  }
+
+  // Checkpoint callback. Creating a missing message does not change the
+  //  family as seen from the outside, thus the pool may do so while const.
+  const Message* doLoadMessage(CheckpointReader* reader) const override {
+    Key key;
+    if (!reader->readValue(&key)) {
+      return nullptr;
+    }
+    return const_cast<MessagePool*>(this)->get(key);
+  }
+};
+
+
+}  // namespace Core
+
+#endif  // ANL_CORE_MESSAGE_POOL_H_
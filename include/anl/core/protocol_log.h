@@ -0,0 +1,109 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#ifndef ANL_CORE_PROTOCOL_LOG_H_
+#define ANL_CORE_PROTOCOL_LOG_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "anl/core/anl.h"
+#include "anl/core/types.h"
+#include "anl/output/output.h"
+#include "anl/output/sink.h"
+
+// This file contains the protocol log from the CORE module.
+namespace Core {
+
+
+// A message of the protocol log, tagged with the slot and the index of the
+//  component (in the network setup) that logged it.
+struct ProtocolLogRecord {
+  std::size_t slot;
+  std::size_t component;
+  std::string message;
+};
+
+
+// The protocol log of a simulation. Messages logged by the components through
+//  ANLView::logProtocol are collected in a buffer of fixed capacity and
+//  flushed in batches: to an output module (merging the log into the trace),
+//  to a sink (one "[slot] component: message" line each), or to the log on
+//  STDERR, in this order of preference. The records and their strings are
+//  reused, thus logging does not allocate once the buffer is warmed up.
+class ProtocolLog {
+ public:
+  // The default number of records that are buffered before flushing.
+  static const std::size_t kDefaultCapacity = 256;
+
+  // Constructor.
+  explicit ProtocolLog(const NetworkSetup* setup,
+    std::size_t capacity = kDefaultCapacity);
+
+  // Sets the sink that the log is flushed to. The sink is not owned by the
+  //  log. If nullptr (the default), the log on STDERR is used.
+  void setSink(Output::Sink* sink) { mSink = sink; }
+
+  // Sets the output module that the log is merged into. The module is
+  //  notified of each record through OutputModule::onProtocolLog, thus the
+  //  log must be flushed before the slot of the records ends. If nullptr (the
+  //  default), the log is not merged.
+  void setOutputModule(Output::OutputModule* module) { mModule = module; }
+
+  // Adds a message of the given component in the given slot. Flushes the log
+  //  if the buffer is full. Messages are dropped right away if they would
+  //  neither be merged nor written.
+  void add(std::size_t slot, const Component* comp, const std::string& message);
+
+  // Writes all buffered records in the order they were added.
+  void flush();
+
+  // Returns the number of buffered records.
+  std::size_t getSize() const { return mSize; }
+
+  // Returns the number of records that are buffered before flushing.
+  std::size_t getCapacity() const { return mRecords.size(); }
+
+ private:
+  // The underlying network setup.
+  const NetworkSetup* mSetup;
+
+  // The buffered records. Only the first mSize records are valid.
+  std::vector<ProtocolLogRecord> mRecords;
+  std::size_t mSize;
+
+  // The destinations of the log. May be nullptr.
+  Output::Sink* mSink;
+  Output::OutputModule* mModule;
+};
+
+
+}  // namespace Core
+
+#endif  // ANL_CORE_PROTOCOL_LOG_H_
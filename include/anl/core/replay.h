@@ -0,0 +1,157 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#ifndef ANL_CORE_REPLAY_H_
+#define ANL_CORE_REPLAY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "anl/core/anl.h"
+#include "anl/core/topologies.h"
+#include "anl/core/types.h"
+#include "anl/output/output.h"
+
+// This file contains the intent log replay from the CORE module.
+namespace Core {
+
+
+// Constants of the intent log format. An intent log records the chosen
+//  intention assignments of a simulation together with everything that is
+//  needed to feed them into the ANL again: the setup, the topology and the
+//  representations of the components and messages. It is written by
+//  Output::IntentLogOutputModule.
+//
+//  All numbers are variable-length integers (see Misc::Strings::appendVarint)
+//  and strings are prefixed by their length. The log starts with kMagic, the
+//  number of tics per slot, the intended number of slots, and the number of
+//  components. Then follow, per component, its ID and XML lines (count and
+//  strings), and its reachable components (count and indices). Then follow
+//  records, each starting with a tag:
+//   kMessageTag: message index, text, and XML lines. Defines the message with
+//    the next index before its first use.
+//   kSlotTag: slot number, then per component the intention type and, for
+//    sending intentions, the tic and the message index.
+//   kSkipTag: first slot, number of slots, and period of slots that were
+//    skipped (see Output::OutputModule::onSlotsSkipped). The skipped slots
+//    repeat the network states of the last period slots.
+//   kEndTag: the end of the log.
+struct IntentLog {
+  // The magic bytes at the beginning of an intent log.
+  static const char kMagic[8];
+
+  // The record tags.
+  static const char kMessageTag = 'M';
+  static const char kSlotTag = 'S';
+  static const char kSkipTag = 'K';
+  static const char kEndTag = 'E';
+};
+
+
+// Replays an intent log. The recorded intention assignments are fed straight
+//  into the ANL, thus neither the protocols nor the components of the
+//  recorded simulation are needed. Components and messages are replaced by
+//  stand-ins that have the recorded IDs and representations.
+class IntentLogReplayer {
+ public:
+  // Reads the intent log at the given path. Returns nullptr if the file can
+  //  not be read or is not an intent log.
+  static IntentLogReplayer* open(const std::string& path);
+
+  // Destructor. Deletes the stand-ins.
+  ~IntentLogReplayer();
+
+  // The replayer owns its stand-ins, thus it must not be copied.
+  IntentLogReplayer(const IntentLogReplayer&) = delete;
+  IntentLogReplayer& operator=(const IntentLogReplayer&) = delete;
+
+  // Gets the reconstructed network setup.
+  const NetworkSetup& getSetup() const { return mSetup; }
+
+  // Gets the reconstructed network topology.
+  const NetworkTopology& getTopology() const { return mTopology; }
+
+  // Gets the intended number of slots of the recorded simulation.
+  std::size_t getIntendedSlots() const { return mIntendedSlots; }
+
+  // Replays the log using the given semantics and notifies the given output
+  //  module like the simulator does. If there are several successor states,
+  //  the first one is chosen. May be repeated. Returns the number of replayed
+  //  slots, including the skipped ones.
+  std::size_t run(Output::OutputModule* outModule, ANLSemantics semantics);
+
+ private:
+  // Constructor. Only used by open.
+  IntentLogReplayer(std::string&& data, std::size_t ticsPerSlot);
+
+  // The content of the log.
+  std::string mData;
+
+  // The positions of the first record and after the last complete record in
+  //  mData.
+  std::size_t mRecordStart;
+  std::size_t mRecordEnd;
+
+  // The intended number of slots.
+  std::size_t mIntendedSlots;
+
+  // The longest period of the skip records, thus the number of recent
+  //  network states the replay must keep.
+  std::size_t mMaxSkipPeriod;
+
+  // The reconstructed network setup.
+  NetworkSetup mSetup;
+
+  // The reconstructed network topology.
+  ExplicitNetworkTopology mTopology;
+
+  // The stand-ins for the recorded components and messages.
+  std::vector<Component*> mComponents;
+  std::vector<Message*> mMessages;
+
+  // Reads the components and the topology, starting at the given position.
+  //  Returns false if the log is malformed.
+  bool readComponents(std::size_t* pos);
+
+  // Checks the records, starting at the given position, and defines the
+  //  recorded messages. Sets mRecordEnd. Returns false if the log is
+  //  malformed.
+  bool readRecords(std::size_t pos);
+
+  // Reads the intentions of a slot record, starting after the slot number.
+  //  Sets them in the given intention assignment unless it is nullptr.
+  //  Returns false if the log is malformed.
+  bool readIntentions(std::size_t* pos, IntentionAssignment* intent) const;
+};
+
+
+}  // namespace Core
+
+#endif  // ANL_CORE_REPLAY_H_
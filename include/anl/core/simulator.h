@@ -31,19 +31,64 @@
 #define ANL_CORE_SIMULATOR_H_
 
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "anl/core/anl.h"
 #include "anl/core/errortrace.h"
+#include "anl/core/protocol_log.h"
 #include "anl/core/types.h"
+#include "anl/misc/arena.h"
 #include "anl/output/output.h"
 
 // This file contains the simulator from the CORE module.
 namespace Core {
 
 
+// The reactions of the simulator to a quiescent network, i.e. a network whose
+//  components are all stable and whose network state repeats.
+enum class QuiescenceMode {
+  // Quiescence is not detected, every slot is simulated.
+  OFF,
+
+  // The simulation stops after the first quiescent slot.
+  STOP,
+
+  // The remaining slots are skipped, only their count is passed to the output
+  //  module. The slot counter is advanced as if they were simulated.
+  FAST_FORWARD
+};
+
+
+// The reactions of the simulator to a cycle of the whole network, i.e. a slot
+//  after which the network state and the states of all components equal those
+//  after an earlier slot.
+enum class CycleMode {
+  // Cycles are not detected, every slot is simulated.
+  OFF,
+
+  // The simulation stops after the first slot that closes a cycle.
+  STOP,
+
+  // The remaining slots are skipped, the output module extrapolates them from
+  //  the network states of the cycle. The slot counter is advanced as if they
+  //  were simulated.
+  EXTRAPOLATE
+};
+
+
 // The interface of the simulator that is used by the protocol designer in order
 //  to perform simulations.
 class Simulator {
  public:
+  // Alias for predicates that end a simulation. They are called after every
+  //  slot with the resulting network state and the number of the slot.
+  using StopPredicate = std::function<bool(const NetworkState&, std::size_t)>;
+
   // Constructor.
   explicit Simulator(std::size_t ticsPerSlot);
 
@@ -56,6 +101,50 @@ class Simulator {
   //  specific (potentially custom) output module.
   void useOutputModule(Output::OutputModule* outModule);
 
+  // Writes the protocol log to the given sink instead of the log on STDERR.
+  //  The sink is not owned by the simulator.
+  void useProtocolLogSink(Output::Sink* sink);
+
+  // Sets whether or not the protocol log is merged into the output of the
+  //  output module, within the slot it was logged in. Defaults to false.
+  void mergeProtocolLog(bool merge);
+
+  // Sets whether or not the transitions are computed incrementally from the
+  //  previous slot. The results are the same, but a slot only costs as much as
+  //  the intentions changed since the previous slot. Defaults to false.
+  void useIncrementalTransitions(bool incremental);
+
+  // Sets how the simulator reacts to a quiescent network. The network is
+  //  quiescent once all components are stable and the network state equals
+  //  one of the network states of the given number of previous slots, which
+  //  covers protocols that alternate between states. Defaults to OFF.
+  void useQuiescence(QuiescenceMode mode, std::size_t period = 2);
+
+  // Sets how the simulator reacts to a cycle of the whole network. The states
+  //  after the given number of previous slots are remembered. A cycle is only
+  //  accepted once its whole period repeated, as the states of the components
+  //  are only known by their hash, thus the period of detectable cycles is at
+  //  most half the history. Requires all components to expose their state
+  //  (see Component::hashState). Defaults to OFF.
+  void useCycleDetection(CycleMode mode, std::size_t historySize = 1024);
+
+  // Seeds the pseudo-random number generator of the simulation (see
+  //  getRandom). Must be set before the simulation.
+  void useSeed(std::uint64_t seed);
+
+  // Writes a checkpoint to the given path after every interval-th slot, from
+  //  which the simulation can be resumed (see resumeFrom). The checkpoint is
+  //  replaced atomically. It is skipped with a warning if a component, a
+  //  message family, or the output module does not support checkpoints.
+  void useCheckpoints(const std::string& path, std::size_t interval);
+
+  // Resumes the simulation from the checkpoint at the given path, if it
+  //  exists. The simulation must be set up like the one that wrote the
+  //  checkpoint, and the files of the output module must be opened without
+  //  truncating them (see Output::Sink::openFile). Quiescence and cycles are
+  //  only detected among the slots after the checkpoint.
+  void resumeFrom(const std::string& path);
+
   // Adds components to the simulation. The components are expected in a
   //  C-array.
   void useComponents(Component* const* compStart, std::size_t count);
@@ -63,10 +152,20 @@ class Simulator {
   // Adds messages to the simulation. The messages are expected in a C-array.
   void useMessages(const Message* const* msgStart, std::size_t count);
 
+  // Adds a message family to the simulation. Its messages are registered on
+  //  first use. The family must outlive the simulator.
+  void useMessageFamily(const MessageFamily* family);
+
   // Performs the simulation for the given amount of slots. Must not be
   //  repeated. Must not be combined with runSingle.
   void run(std::size_t numSlots);
 
+  // Performs the simulation until the predicate is fulfilled after a slot, but
+  //  for at most the given amount of slots. Returns the number of slots,
+  //  including skipped ones. Must not be repeated. Must not be combined with
+  //  run or runSingle.
+  std::size_t runUntil(StopPredicate predicate, std::size_t maxSlots);
+
   // Runs a single slot. May be repeated multiple times. A sequence of runSingle
   //  calls must be terminated by a single call to endSingle. Must not be
   //  combined with run(). The argument shall be passed as the intended number
@@ -76,6 +175,26 @@ class Simulator {
   // Terminates a sequence of runSingle calls.
   void endSingle();
 
+  // Checks whether or not the network was quiescent in the last slot. Always
+  //  false if quiescence is not detected.
+  bool isQuiescent() const { return mQuiescent; }
+
+  // Gets the period of the cycle that was closed by the last slot, or zero if
+  //  there is none. Always zero if cycles are not detected.
+  std::size_t getCyclePeriod() const { return mCyclePeriod; }
+
+  // Gets the number of the next slot. Skipped slots are counted.
+  std::size_t getSlotNumber() const { return mSlotNumber; }
+
+  // Gets the arena of the simulation, for the messages of MessageInterners.
+  //  Memory allocated from it lives as long as the simulator and is returned
+  //  at once.
+  Misc::Arena* getArena() { return &mArena; }
+
+  // Gets the pseudo-random number generator of the simulation. Protocols that
+  //  draw their random numbers from it are resumed exactly from checkpoints.
+  std::mt19937_64* getRandom() { return &mRandom; }
+
  private:
   // The error tracing helper.
   ErrorTracer mErrorTracer;
@@ -101,14 +220,122 @@ class Simulator {
   // Whether or not simulation has already begun.
   bool mHasBegun;
 
+  // The protocol log of the components.
+  ProtocolLog mProtocolLog;
+
+  // Whether or not the protocol log is merged into the output.
+  bool mMergeProtocolLog;
+
+  // The arena for allocations that live as long as the simulation.
+  Misc::Arena mArena;
+
+  // The arena for temporary data of a single slot. Released after each slot.
+  Misc::Arena mSlotArena;
+
+  // The reaction to a quiescent network.
+  QuiescenceMode mQuiescenceMode;
+
+  // The number of previous network states that are compared for quiescence.
+  std::size_t mQuiescencePeriod;
+
+  // The network states of the previous slots, the most recent one last.
+  std::deque<NetworkState> mRecentStates;
+
+  // Whether or not the network was quiescent in the last slot.
+  bool mQuiescent;
+
+  // A remembered global state of the network.
+  struct HistoryEntry {
+    std::size_t hash;
+    std::size_t slot;
+    NetworkState state;
+  };
+
+  // The reaction to a cycle of the network.
+  CycleMode mCycleMode;
+
+  // The maximum number of remembered global states.
+  std::size_t mHistorySize;
+
+  // The global states after the previous slots, the most recent one last.
+  std::deque<HistoryEntry> mHistory;
+
+  // The slots of the remembered global states, by their hash.
+  std::unordered_map<std::size_t, std::size_t> mHistoryIndex;
+
+  // The period of the cycle closed by the last slot, or zero.
+  std::size_t mCyclePeriod;
+
+  // The network states that the following slots repeat cyclically, if the
+  //  last slot was quiescent or closed a cycle. Empty otherwise.
+  std::vector<NetworkState> mRepetition;
+
+  // The pseudo-random number generator of the simulation.
+  std::mt19937_64 mRandom;
+
+  // The path checkpoints are written to. No checkpoints are written if empty.
+  std::string mCheckpointPath;
+
+  // The number of slots between checkpoints.
+  std::size_t mCheckpointInterval;
+
+  // The path of the checkpoint to resume from. Not resumed if empty.
+  std::string mResumePath;
+
+  // Checks that the simulation is set up completely.
+  void checkPrerequisites();
+
+  // Begins the simulation, resuming it from a checkpoint if requested.
+  void beginSimulation(std::size_t intendedSlots);
+
+  // Writes a checkpoint after the current slot. Returns false if a part of the
+  //  simulation does not support checkpoints.
+  bool writeCheckpoint();
+
+  // Restores the simulation from the checkpoint to resume from. Returns false
+  //  if there is no checkpoint.
+  bool readCheckpoint(std::size_t intendedSlots);
+
   // Simulates a single slot.
   void runSlot();
+
+  // Skips up to the given number of slots that repeat the previous ones, but
+  //  not beyond a slot fulfilling the predicate (if any).
+  void skipSlots(const StopPredicate& predicate, std::size_t remaining);
+
+  // Updates the quiescence of the network after a slot.
+  void updateQuiescence();
+
+  // Remembers the global state after a slot and checks whether it closes a
+  //  cycle.
+  void updateCycles();
+
+  // Checks whether the global state with the given hash after the last slot
+  //  closes a cycle of the given period that repeated completely, comparing
+  //  the hashes and network states of the remembered slots.
+  bool isCycleConfirmed(std::size_t hash, std::size_t period) const;
 };
 
 
 // Declaration of the default output module set by the entry point.
 extern Output::OutputModule* gDefaultOutModule;
 
+// Declaration of the default protocol log settings set by the entry point.
+extern Output::Sink* gDefaultProtocolLogSink;
+extern bool gDefaultMergeProtocolLog;
+
+// Declaration of the default quiescence mode set by the entry point.
+extern QuiescenceMode gDefaultQuiescenceMode;
+
+// Declaration of the default cycle mode set by the entry point.
+extern CycleMode gDefaultCycleMode;
+
+// Declaration of the default checkpoint settings set by the entry point. No
+//  checkpoints are written if the path is empty.
+extern std::string gDefaultCheckpointPath;
+extern std::size_t gDefaultCheckpointInterval;
+extern bool gDefaultResume;
+
 
 }  // namespace Core
 
@@ -47,6 +47,10 @@ class StateMachineComponent : public Component {
   // State getter.
   T getState() const { return mState; }
 
+ protected:
+  // State setter, for restoring the state from a checkpoint.
+  void setState(T state) { mState = state; }
+
  private:
   // The current state of the component.
   T mState;
@@ -0,0 +1,141 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#ifndef ANL_CORE_SWEEP_H_
+#define ANL_CORE_SWEEP_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "anl/output/sink.h"
+
+// This file contains the parameter sweeps from the CORE module.
+namespace Core {
+
+
+// Function module for the parameters of the current simulation run. The
+//  parameters are set on the command line (--param and --sweep) and read by
+//  the simulation entry point to configure the run, e.g. the number of tics
+//  per slot or the size of the topology.
+class Parameters {
+ public:
+  // Sets the parameter with the given name to the given value.
+  static void set(const std::string& name, const std::string& value);
+
+  // Returns whether the parameter with the given name is set.
+  static bool has(const std::string& name);
+
+  // Gets the value of the parameter with the given name, or the given default
+  //  value if it is not set.
+  static std::string get(const std::string& name,
+    const std::string& defaultValue);
+
+  // Gets the value of the parameter with the given name as a size, or the
+  //  given default value if it is not set. Fails if the value is not a size.
+  static std::size_t getSize(const std::string& name,
+    std::size_t defaultValue);
+
+  // Removes all parameters.
+  static void clear();
+
+ private:
+  // Prevent instance creation.
+  Parameters() {}
+};
+
+
+// Runs a simulation for every combination of parameter values (the cartesian
+//  product of the swept parameters), each in its own process. Processes keep
+//  the runs apart even though simulations use global state, e.g. the default
+//  output module or the interners of their messages.
+class ParameterSweep {
+ public:
+  // Function that performs the given run. The parameters of the run are set
+  //  when it is called. It writes the result of the run to the given sink and
+  //  returns its exit status.
+  using RunFunction = std::function<int(std::size_t, Output::Sink*)>;
+
+  // The result of a single run.
+  struct Result {
+    // The exit status of the run, or 128 plus the signal number if it was
+    //  killed by a signal.
+    int status;
+
+    // What the run wrote to its result sink.
+    std::string output;
+  };
+
+  // Adds a parameter that is swept over the given values. Fails if the
+  //  parameter was already added or if there are no values.
+  void addParameter(const std::string& name,
+    const std::vector<std::string>& values);
+
+  // Gets the number of swept parameters.
+  std::size_t getParameterCount() const { return mNames.size(); }
+
+  // Gets the name of the parameter with the given index.
+  const std::string& getParameterName(std::size_t param) const;
+
+  // Gets the number of runs. The sweep without parameters has a single run.
+  std::size_t getRunCount() const;
+
+  // Gets the value of the parameter with the given index in the given run.
+  //  The last parameter varies fastest.
+  const std::string& getValue(std::size_t run, std::size_t param) const;
+
+  // Gets the header line of a table of results with one row per run. The
+  //  columns are the run number, the swept parameters prefixed with "param:",
+  //  and the given result columns. Fails if a result column contains ':', so
+  //  that no result column is named like a parameter.
+  std::string getTableHeader(const std::vector<std::string>& resultColumns)
+    const;
+
+  // Sets the parameters (see Parameters) to their values in the given run.
+  void applyRun(std::size_t run) const;
+
+  // Performs all runs, at most the given number of them at the same time (the
+  //  number of online processors if 0). Every run is performed in a forked
+  //  process that sets the parameters of the run and calls the given
+  //  function. Returns the results in the order of the runs.
+  std::vector<Result> run(std::size_t jobs, const RunFunction& function)
+    const;
+
+ private:
+  // The names of the swept parameters.
+  std::vector<std::string> mNames;
+
+  // The values of the swept parameters.
+  std::vector<std::vector<std::string>> mValues;
+};
+
+
+}  // namespace Core
+
+#endif  // ANL_CORE_SWEEP_H_
@@ -30,8 +30,12 @@
 #ifndef ANL_CORE_TOPOLOGIES_H_
 #define ANL_CORE_TOPOLOGIES_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include "anl/core/types.h"
 
 // This file contains the default topologies in the CORE module.
@@ -44,6 +48,10 @@ class TrivialNetworkTopology final : public NetworkTopology {
   // Overriding the internal canReach mechanism.
   bool doCanReach(const Component* sndr, const Component* rcvr) const override
     { return true; }
+
+  // Overriding the internal enumeration mechanism: everyone is reachable.
+  void doForEachReachable(const NetworkSetup& setup, const Component* sndr,
+    std::function<void(const Component*)> cb) const override;
 };
 
 
@@ -53,6 +61,10 @@ class IsolatedNetworkTopology final : public NetworkTopology {
   // Overriding the internal canReach mechanism.
   bool doCanReach(const Component* sndr, const Component* rcvr) const override
     { return false; }
+
+  // Overriding the internal enumeration mechanism: no one is reachable.
+  void doForEachReachable(const NetworkSetup& setup, const Component* sndr,
+    std::function<void(const Component*)> cb) const override {}
 };
 
 
@@ -66,6 +78,10 @@ class ExplicitNetworkTopology : public NetworkTopology {
   // Overriding the internal canReach mechanism.
   bool doCanReach(const Component* sndr, const Component* rcvr) const override;
 
+  // Overriding the internal enumeration mechanism using the stored edges.
+  void doForEachReachable(const NetworkSetup& setup, const Component* sndr,
+    std::function<void(const Component*)> cb) const override;
+
  private:
   // The storage in which the edges of the network topology are kept.
   std::unordered_map<const Component*,
@@ -73,6 +89,80 @@ class ExplicitNetworkTopology : public NetworkTopology {
 };
 
 
+// A network topology of components placed in two- or three-dimensional space,
+//  in which components reach each other if their distance is at most the radio
+//  range. A component does not reach itself. The neighbors are determined
+//  using a uniform grid of cells as large as the range, thus only components
+//  in adjacent cells are compared. They are determined on the first query
+//  after components were placed.
+class UnitDiskNetworkTopology final : public NetworkTopology {
+ public:
+  // Constructor. Fails if the range is not positive.
+  explicit UnitDiskNetworkTopology(double range);
+
+  // Places the given component at the given coordinates. Two-dimensional
+  //  layouts keep the default z coordinate. Fails if the component was
+  //  already placed, or if a coordinate is not finite or so large that its
+  //  grid cell does not fit into 64 bits. Components may also be placed once
+  //  the simulation has started, which makes the ANL compute the next
+  //  transition in full (see NetworkTopology::getGeneration).
+  void addComponent(const Component* comp, double x, double y, double z = 0);
+
+  // Gets the number of components the given component reaches (0 if it was
+  //  not placed).
+  std::size_t getNeighborCount(const Component* comp) const;
+
+ private:
+  // Overriding the internal canReach mechanism by comparing the distance.
+  bool doCanReach(const Component* sndr, const Component* rcvr) const override;
+
+  // Overriding the internal enumeration mechanism using the neighbor lists.
+  void doForEachReachable(const NetworkSetup& setup, const Component* sndr,
+    std::function<void(const Component*)> cb) const override;
+
+  // Test for whether the components with the given placement indices are
+  //  distinct and in range of each other.
+  bool isInRange(std::size_t from, std::size_t to) const;
+
+  // Determines the neighbor lists of all placed components, if outdated.
+  void buildNeighbors() const;
+
+  // Orders the neighbor lists by the registration order of the given setup,
+  //  if not already done for it.
+  void orderNeighbors(const NetworkSetup& setup) const;
+
+  // The radio range.
+  double mRange;
+
+  // Whether any component has a non-zero z coordinate. Otherwise, only the
+  //  cells of a single layer need to be compared.
+  bool mIs3D;
+
+  // The placed components with their coordinates, in placement order.
+  std::vector<const Component*> mComps;
+  std::vector<double> mCoords;
+
+  // The placement index of every placed component.
+  std::unordered_map<const Component*, std::size_t> mIndices;
+
+  // Whether the neighbor lists are up to date.
+  mutable bool mBuilt;
+
+  // The neighbor lists (placement indices) of all components, stored
+  //  consecutively. The list of component i starts at mNeighborBegins[i] and
+  //  ends at mNeighborBegins[i + 1].
+  mutable std::vector<std::size_t> mNeighborBegins;
+  mutable std::vector<std::size_t> mNeighbors;
+
+  // The neighbor lists restricted to the components of the setup (and its
+  //  number of components) they were ordered for, in registration order.
+  mutable const NetworkSetup* mOrderedSetup;
+  mutable std::size_t mOrderedCount;
+  mutable std::vector<std::size_t> mOrderedBegins;
+  mutable std::vector<const Component*> mOrdered;
+};
+
+
 }  // namespace Core
 
 #endif  // ANL_CORE_TOPOLOGIES_H_
@@ -30,6 +30,9 @@
 #ifndef ANL_CORE_TYPES_H_
 #define ANL_CORE_TYPES_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -39,6 +42,39 @@ namespace Core {
 
 // See anl.h for full declaration.
 class ANLView;
+class NetworkSetup;
+
+// See checkpoint.h for full declaration.
+class CheckpointReader;
+class CheckpointWriter;
+
+
+// Combines values into a hash of the state of a simulation. Used for detecting
+//  cycles of the whole network.
+class StateHasher {
+ public:
+  // Constructor.
+  StateHasher() : mHash(0) {}
+
+  // Adds an integral or enumeration value to the hash.
+  template<class T>
+  void addValue(T value) { combine(static_cast<std::size_t>(value)); }
+
+  // Adds a pointer to the hash. The object pointed to is not hashed.
+  void addPointer(const void* ptr)
+    { addValue(reinterpret_cast<std::uintptr_t>(ptr)); }
+
+  // Gets the hash of the values added so far.
+  std::size_t getHash() const { return mHash; }
+
+ private:
+  // The current hash.
+  std::size_t mHash;
+
+  // Combines the hash with a value.
+  void combine(std::size_t value)
+    { mHash ^= value + 0x9E3779B9 + (mHash << 6) + (mHash >> 2); }
+};
 
 
 // A component in a network.
@@ -53,11 +89,39 @@ class Component {
 
   // Converts the component into a representation of XML tags. Each element of
   //  the vector will be one line of the XML output.
-  std::vector<std::string> toXML() const { return doToXML(); }
+  std::vector<std::string> toXML() const;
+
+  // Appends the XML representation of the component to the buffer. Each line
+  //  is indented by the given number of spaces and terminated by a newline.
+  void appendXML(std::string* buffer, std::size_t indent) const
+    { doAppendXML(buffer, indent); }
 
   // Fetches an ID of the component. Must be unique if proper XML support is
   //  desired.
-  std::string getId() const { return doGetId(); }
+  std::string getId() const;
+
+  // Appends the ID of the component to the buffer.
+  void appendId(std::string* buffer) const { doAppendId(buffer); }
+
+  // Checks whether or not the component is stable, i.e. it makes no progress of
+  //  its own and only repeats its behavior until a message reaches it. Used for
+  //  detecting quiescent networks.
+  bool isStable() const { return doIsStable(); }
+
+  // Adds the internal state of the component to the hasher. Returns false if
+  //  the component does not expose its state, which rules out detecting cycles
+  //  of the network. Components whose protocol depends on the slot number must
+  //  not expose their state.
+  bool hashState(StateHasher* hasher) const { return doHashState(hasher); }
+
+  // Writes the internal state of the component to a checkpoint. Returns false
+  //  if the component does not support checkpoints, which rules out resuming
+  //  the simulation.
+  bool saveState(CheckpointWriter* writer) const { return doSaveState(writer); }
+
+  // Restores the internal state written by saveState. Returns false if the
+  //  checkpoint is malformed.
+  bool loadState(CheckpointReader* reader) { return doLoadState(reader); }
 
   // Operators.
   bool operator==(const Component& other) const { return equals(other); }
@@ -74,9 +138,32 @@ class Component {
   virtual std::vector<std::string> doToXML() const
     { return std::vector<std::string>(); }
 
+  // Appends the XML representation of the component. The default
+  //  implementation appends the lines returned by doToXML.
+  virtual void doAppendXML(std::string* buffer, std::size_t indent) const;
+
   // Fetches an ID of the component. Must be unique if proper XML support is
   //  desired.
   virtual std::string doGetId() const { return "default"; }
+
+  // Appends the ID of the component. The default implementation appends the
+  //  value returned by doGetId.
+  virtual void doAppendId(std::string* buffer) const;
+
+  // Checks whether or not the component is stable. Components are not stable
+  //  by default, which disables quiescence detection for them.
+  virtual bool doIsStable() const { return false; }
+
+  // Adds the internal state of the component to the hasher. Components do not
+  //  expose their state by default.
+  virtual bool doHashState(StateHasher* hasher) const { return false; }
+
+  // Writes the internal state of the component to a checkpoint. Components do
+  //  not support checkpoints by default.
+  virtual bool doSaveState(CheckpointWriter* writer) const { return false; }
+
+  // Restores the internal state of the component from a checkpoint.
+  virtual bool doLoadState(CheckpointReader* reader) { return false; }
 };
 
 
@@ -86,11 +173,19 @@ class Message {
   virtual ~Message() {}
 
   // Converts the message into a textual representation.
-  std::string toString() const { return doToString(); }
+  std::string toString() const;
+
+  // Appends the textual representation of the message to the buffer.
+  void appendText(std::string* buffer) const { doAppendText(buffer); }
 
   // Converts the message into a representation of XML tags. Each element of
   //  the vector will be one line of the XML output.
-  std::vector<std::string> toXML() const { return doToXML(); }
+  std::vector<std::string> toXML() const;
+
+  // Appends the XML representation of the message to the buffer. Each line is
+  //  indented by the given number of spaces and terminated by a newline.
+  void appendXML(std::string* buffer, std::size_t indent) const
+    { doAppendXML(buffer, indent); }
 
   // Operators.
   bool operator==(const Message& other) const { return equals(other); }
@@ -103,25 +198,60 @@ class Message {
   // Converts the message into a textual representation.
   virtual std::string doToString() const { return "Message"; }
 
+  // Appends the textual representation of the message. The default
+  //  implementation appends the value returned by doToString.
+  virtual void doAppendText(std::string* buffer) const;
+
   // Converts the message into a representation of XML tags.
   virtual std::vector<std::string> doToXML() const
     { return std::vector<std::string>(); }
+
+  // Appends the XML representation of the message. The default implementation
+  //  appends the lines returned by doToXML.
+  virtual void doAppendXML(std::string* buffer, std::size_t indent) const;
 };
 
 
 // A network topology.
 class NetworkTopology {
  public:
+  NetworkTopology() : mGeneration(0) {}
   virtual ~NetworkTopology() {}
 
   // Test for whether a component can reach another component.
   bool canReach(const Component* sndr, const Component* rcvr) const;
 
+  // Executes the given function for every component of the given setup that
+  //  the given component can reach. The order of the components is guaranteed
+  //  to be the registration order.
+  void forEachReachable(const NetworkSetup& setup, const Component* sndr,
+    std::function<void(const Component*)> cb) const;
+
+  // Gets the generation of the topology, which changes whenever its
+  //  reachability changes. Incremental transitions compare it to notice
+  //  changes of the same topology object between slots.
+  std::uint64_t getGeneration() const { return mGeneration; }
+
+ protected:
+  // Notes that the reachability changed. Topologies that change after the
+  //  simulation has begun must call this on every change.
+  void markChanged() { mGeneration++; }
+
  private:
+  // The generation of the topology.
+  std::uint64_t mGeneration;
+
   // Virtual delegate for checking whether a component can reach another
   // component.
   virtual bool doCanReach(const Component* sndr, const Component* rcvr)
     const = 0;
+
+  // Virtual delegate for enumerating the components that a component can
+  //  reach. The default implementation checks every component of the setup
+  //  using canReach, which is quadratic in the number of components when used
+  //  for all edges. Topologies that know their edges should override this.
+  virtual void doForEachReachable(const NetworkSetup& setup,
+    const Component* sndr, std::function<void(const Component*)> cb) const;
 };
 
 
@@ -0,0 +1,153 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#ifndef ANL_MISC_ARENA_H_
+#define ANL_MISC_ARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace Misc {
+
+
+// A monotonic arena. Memory is handed out from large blocks and only returned
+//  all at once, either by release() or when the arena is destroyed. Objects
+//  placed in the arena are not destructed by it. Released blocks are reused,
+//  thus an arena that is released once per slot serves as scratch memory which
+//  does not call the allocator in steady state.
+class Arena {
+ public:
+  // The size of the first block, in bytes. Later blocks double in size.
+  static constexpr std::size_t kDefaultBlockSize = 4096;
+
+  // Constructor.
+  explicit Arena(std::size_t blockSize = kDefaultBlockSize);
+
+  // Destructor. Frees all blocks.
+  ~Arena();
+
+  // Returns uninitialized memory of the given size and alignment. The
+  //  alignment must be a power of two.
+  void* allocate(std::size_t size, std::size_t align);
+
+  // Checks whether or not the pointer points into memory of this arena that
+  //  was handed out since the last release. Takes time logarithmic in the
+  //  number of allocated bytes.
+  bool owns(const void* ptr) const;
+
+  // Returns the number of bytes handed out since construction or the last
+  //  release.
+  std::size_t getAllocated() const { return mAllocated; }
+
+  // Returns all memory at once in constant time. Pointers into the arena
+  //  become invalid. The blocks are kept for reuse and freed on destruction.
+  void release() { mCurrent = 0; mUsed = 0; mAllocated = 0; }
+
+ private:
+  // A block of memory.
+  struct Block {
+    char* data;
+    std::size_t size;
+  };
+
+  // The blocks, in the order of their use.
+  std::vector<Block> mBlocks;
+
+  // The index of the block that is currently used. Blocks behind it are free.
+  std::size_t mCurrent;
+
+  // The number of bytes used in the current block.
+  std::size_t mUsed;
+
+  // The size of the next block to allocate.
+  std::size_t mNextBlockSize;
+
+  // The number of bytes handed out.
+  std::size_t mAllocated;
+
+  // Prevent copies, the blocks are owned.
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+};
+
+
+// A standard allocator that allocates from an arena. Deallocation is a no-op,
+//  the memory is returned when the arena is released. Without an arena, the
+//  global operators new and delete are used.
+template<class T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  // Constructors.
+  explicit ArenaAllocator(Arena* arena = nullptr) : mArena(arena) {}
+  template<class U>
+  ArenaAllocator(const ArenaAllocator<U>& other)  // NOLINT(runtime/explicit)
+    : mArena(other.getArena()) {}
+
+  // Allocates memory for n objects.
+  T* allocate(std::size_t n) {
+    if (mArena == nullptr) {
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T*>(mArena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  // Deallocates memory for n objects.
+  void deallocate(T* ptr, std::size_t n) {
+    if (mArena == nullptr) {
+      ::operator delete(ptr);
+    }
+  }
+
+  // Getter for the arena.
+  Arena* getArena() const { return mArena; }
+
+ private:
+  // The arena the memory is taken from. May be nullptr.
+  Arena* mArena;
+};
+
+// _____________________________________________________________________________
+template<class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.getArena() == b.getArena();
+}
+
+// _____________________________________________________________________________
+template<class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.getArena() != b.getArena();
+}
+
+
+}  // namespace Misc
+
+#endif  // ANL_MISC_ARENA_H_
@@ -30,6 +30,28 @@
 #ifndef ANL_MISC_ASSERTS_H_
 #define ANL_MISC_ASSERTS_H_
 
+// Assertion tiers. The condition of a disabled tier is not evaluated at all.
+//  ANL_REQUIRE: always checked. Used for misuse of the public interface.
+//  ANL_DEBUG_REQUIRE, ANL_DEBUG_EXPECT: checked unless NDEBUG is defined. Used
+//   for internal invariants on hot paths.
+//  ANL_PARANOID_REQUIRE: checked only if ANL_PARANOID is defined (as in the
+//   debug build). Used for checks that cost more than the checked operation.
+#define ANL_REQUIRE(cond, message) Misc::Asserts::require((cond), (message))
+#ifndef NDEBUG
+#define ANL_DEBUG_REQUIRE(cond, message) \
+  Misc::Asserts::require((cond), (message))
+#define ANL_DEBUG_EXPECT(cond, message) Misc::Asserts::expect((cond), (message))
+#else
+#define ANL_DEBUG_REQUIRE(cond, message) static_cast<void>(0)
+#define ANL_DEBUG_EXPECT(cond, message) static_cast<void>(0)
+#endif
+#if defined(ANL_PARANOID) && !defined(NDEBUG)
+#define ANL_PARANOID_REQUIRE(cond, message) \
+  Misc::Asserts::require((cond), (message))
+#else
+#define ANL_PARANOID_REQUIRE(cond, message) static_cast<void>(0)
+#endif
+
 namespace Misc {
 
 
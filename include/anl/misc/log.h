@@ -0,0 +1,117 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#ifndef ANL_MISC_LOG_H_
+#define ANL_MISC_LOG_H_
+
+#include <cstddef>
+
+// The least severe log level that is compiled in. Messages of less severe
+//  levels are removed by the compiler, including the evaluation of their
+//  arguments. Fine messages are only compiled into debug code by default.
+#ifndef ANL_LOG_COMPILED_LEVEL
+#ifdef NDEBUG
+#define ANL_LOG_COMPILED_LEVEL 1
+#else
+#define ANL_LOG_COMPILED_LEVEL 0
+#endif
+#endif
+
+// Logs a printf-style message with the given level (FINE, INFO, PROTOCOL,
+//  WARNING or SEVERE). The arguments are only evaluated if the level is
+//  compiled in and enabled at runtime.
+#define ANL_LOG(level, ...) \
+  do { \
+    if (static_cast<int>(Misc::LogLevel::level) >= ANL_LOG_COMPILED_LEVEL \
+        && Misc::Log::isEnabled(Misc::LogLevel::level)) { \
+      Misc::Log::write(Misc::LogLevel::level, __VA_ARGS__); \
+    } \
+  } while (false)
+
+namespace Misc {
+
+
+// The levels of log messages, from least to most severe. OFF is only used as
+//  a threshold and disables all messages.
+enum class LogLevel {
+  FINE = 0,
+  INFO = 1,
+  PROTOCOL = 2,
+  WARNING = 3,
+  SEVERE = 4,
+  OFF = 5
+};
+
+// Function module for leveled logging. Messages are prefixed with their level
+//  (followed by a space unless the message is empty) and collected in a
+//  buffer, which is written to the log file descriptor (STDERR by default)
+//  when it is full, for warnings and severe messages, and at program exit.
+class Log {
+ public:
+  // The size of the log buffer.
+  static const std::size_t kBufferSize = 4096;
+
+  // Returns whether messages of the given level are written.
+  static bool isEnabled(LogLevel level)
+    { return static_cast<int>(level) >= static_cast<int>(sThreshold); }
+
+  // Sets the least severe level that is written. Defaults to INFO.
+  static void setLevel(LogLevel level) { sThreshold = level; }
+
+  // Returns the least severe level that is written.
+  static LogLevel getLevel() { return sThreshold; }
+
+  // Parses a level name (fine, info, protocol, warning, severe or off). Returns
+  //  false if the name is unknown.
+  static bool parseLevel(const char* name, LogLevel* level);
+
+  // Sets the file descriptor that messages are written to. The buffer is
+  //  flushed to the previous file descriptor first.
+  static void setFileDescriptor(int fd);
+
+  // Writes a printf-style message with the given level, regardless of the
+  //  threshold. Use ANL_LOG to skip disabled messages without cost.
+  static void write(LogLevel level, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+  // Writes all buffered messages.
+  static void flush();
+
+ private:
+  // Prevent instance creation.
+  Log() {}
+
+  // The least severe level that is written.
+  static LogLevel sThreshold;
+};
+
+
+}  // namespace Misc
+
+#endif  // ANL_MISC_LOG_H_
@@ -0,0 +1,78 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#ifndef ANL_MISC_STRINGS_H_
+#define ANL_MISC_STRINGS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Misc {
+
+
+// Function module for building output in caller-owned string buffers.
+class Strings {
+ public:
+  // Appends the decimal representation of the given number to the buffer.
+  //  Does not allocate unless the buffer has to grow.
+  static void appendNumber(std::string* buffer, std::size_t value);
+
+  // Appends the given number to the buffer as a variable-length integer (7
+  //  bits per byte, least significant group first, high bit set on all but
+  //  the last byte).
+  static void appendVarint(std::string* buffer, std::uint64_t value);
+
+  // Appends the given number of spaces to the buffer.
+  static void appendIndent(std::string* buffer, std::size_t indent)
+    { buffer->append(indent, ' '); }
+
+  // Appends the given text to the buffer, escaping the characters that are
+  //  special in XML character data and attribute values.
+  static void appendEscapedXML(std::string* buffer, const std::string& text);
+
+  // Appends the given lines to the buffer. Each line is indented by the given
+  //  number of spaces and terminated by a newline.
+  static void appendLines(std::string* buffer,
+    const std::vector<std::string>& lines, std::size_t indent);
+
+  // Splits a buffer of newline-terminated lines into its lines, without the
+  //  newlines. A trailing line without a newline is kept as well.
+  static std::vector<std::string> splitLines(const std::string& buffer);
+
+ private:
+  // Prevent instance creation.
+  Strings() {}
+};
+
+
+}  // namespace Misc
+
+#endif  // ANL_MISC_STRINGS_H_
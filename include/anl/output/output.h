@@ -31,9 +31,15 @@
 #define ANL_OUTPUT_OUTPUT_H_
 
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "anl/core/anl.h"
 #include "anl/core/types.h"
+#include "anl/output/sink.h"
 
 // This file contains the declaration of output modules.
 namespace Output {
@@ -60,11 +66,40 @@ class OutputModule {
   // Notify the module of the chosen result of transitioning.
   void onResultChosen(const Core::NetworkState& state);
 
+  // Notify the module of a protocol log message of the current slot. Only
+  //  called if the protocol log is merged into the output, and only between
+  //  the beginning of the slot and the chosen intention assignment.
+  void onProtocolLog(const std::string& componentId,
+    const std::string& message);
+
   // Notify the module of the ending slot.
   void onSlotEnd();
 
-  // Notify the module of the ending simulation.
-  void onSimulationEnd();
+  // Notify the module of slots that were skipped, as they would only have
+  //  repeated the previous slots. The skipped slots cycle through the given
+  //  network states, beginning with the first one. Only called between slots.
+  void onSlotsSkipped(std::size_t firstSlot, std::size_t count,
+    const std::vector<Core::NetworkState>& cycle);
+
+  // Notify the module of the ending simulation. The number of slots includes
+  //  skipped slots and may differ from the number given at the beginning, if
+  //  the simulation ended early.
+  void onSimulationEnd(std::size_t numSlots);
+
+  // Notify the module of a simulation that is resumed from a checkpoint
+  //  instead of beginning, continuing with the given slot. The module continues
+  //  its output, and its state is restored by loadState right afterwards.
+  void onSimulationResume(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology, std::size_t firstSlot);
+
+  // Writes the state of the module to a checkpoint, flushing its output.
+  //  Returns false if the module does not support checkpoints. Only called
+  //  between slots.
+  bool saveState(Core::CheckpointWriter* writer);
+
+  // Restores the state written by saveState, discarding the output written
+  //  after the checkpoint. Returns false if the checkpoint is malformed.
+  bool loadState(Core::CheckpointReader* reader);
 
  private:
   // Notify the module of the beginning of the simulation.
@@ -84,17 +119,48 @@ class OutputModule {
   // Notify the module of the chosen result of transitioning.
   virtual void doResultChosen(const Core::NetworkState& state) = 0;
 
+  // Notify the module of a protocol log message. Ignored by default.
+  virtual void doProtocolLog(const std::string& componentId,
+    const std::string& message) {}
+
   // Notify the module of the ending slot.
   virtual void doSlotEnd() = 0;
 
+  // Notify the module of skipped slots. Ignored by default.
+  virtual void doSlotsSkipped(std::size_t firstSlot, std::size_t count,
+    const std::vector<Core::NetworkState>& cycle) {}
+
   // Notify the module of the ending simulation.
-  virtual void doSimulationEnd() = 0;
+  virtual void doSimulationEnd(std::size_t numSlots) = 0;
+
+  // Notify the module of the resumed simulation. Ignored by default.
+  virtual void doSimulationResume(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology,
+    std::size_t firstSlot) {}
+
+  // Checkpoint callbacks. Modules do not support checkpoints by default.
+  virtual bool doSaveState(Core::CheckpointWriter* writer) { return false; }
+  virtual bool doLoadState(Core::CheckpointReader* reader) { return false; }
 };
 
 
 // An implementation of the output module that logs to STDOUT.
 class StdOutOutputModule : public OutputModule {
+ public:
+  // Constructor. The output is written to the given sink, which defaults to
+  //  the STDOUT sink (nullptr). The sink is not owned by the module.
+  explicit StdOutOutputModule(Sink* sink = nullptr);
+
  private:
+  // The sink the output is written to.
+  Sink* mSink;
+
+  // The buffer the traits are rendered into. Reused to avoid allocations.
+  std::string mBuffer;
+
+  // The number of slots given at the beginning of the simulation.
+  std::size_t mIntendedSlots;
+
   // Notify the module of the beginning of the simulation.
   void doSimulationBegin(std::size_t numSlots, const Core::NetworkSetup* setup,
     const Core::NetworkTopology* topology) override;
@@ -112,17 +178,47 @@ class StdOutOutputModule : public OutputModule {
   // Notify the module of the chosen result of transitioning.
   void doResultChosen(const Core::NetworkState& state) override;
 
+  // Notify the module of a protocol log message.
+  void doProtocolLog(const std::string& componentId,
+    const std::string& message) override;
+
   // Notify the module of the ending slot.
   void doSlotEnd() override;
 
+  // Notify the module of skipped slots.
+  void doSlotsSkipped(std::size_t firstSlot, std::size_t count,
+    const std::vector<Core::NetworkState>& cycle) override;
+
   // Notify the module of the ending simulation.
-  void doSimulationEnd() override;
+  void doSimulationEnd(std::size_t numSlots) override;
+
+  // Notify the module of the resumed simulation.
+  void doSimulationResume(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology, std::size_t firstSlot) override;
+
+  // Checkpoint callbacks.
+  bool doSaveState(Core::CheckpointWriter* writer) override;
+  bool doLoadState(Core::CheckpointReader* reader) override;
 };
 
 
 // An implementation of the output module that logs to STDOUT using XML.
 class XMLOutputModule : public OutputModule {
+ public:
+  // Constructor. The output is written to the given sink, which defaults to
+  //  the STDOUT sink (nullptr). The sink is not owned by the module.
+  explicit XMLOutputModule(Sink* sink = nullptr);
+
  private:
+  // The sink the output is written to.
+  Sink* mSink;
+
+  // The buffer the traits are rendered into. Reused to avoid allocations.
+  std::string mBuffer;
+
+  // The number of slots given at the beginning of the simulation.
+  std::size_t mIntendedSlots;
+
   // Notify the module of the beginning of the simulation.
   void doSimulationBegin(std::size_t numSlots, const Core::NetworkSetup* setup,
     const Core::NetworkTopology* topology) override;
@@ -140,11 +236,628 @@ class XMLOutputModule : public OutputModule {
   // Notify the module of the chosen result of transitioning.
   void doResultChosen(const Core::NetworkState& state) override;
 
+  // Notify the module of a protocol log message.
+  void doProtocolLog(const std::string& componentId,
+    const std::string& message) override;
+
   // Notify the module of the ending slot.
   void doSlotEnd() override;
 
+  // Notify the module of skipped slots.
+  void doSlotsSkipped(std::size_t firstSlot, std::size_t count,
+    const std::vector<Core::NetworkState>& cycle) override;
+
+  // Notify the module of the ending simulation.
+  void doSimulationEnd(std::size_t numSlots) override;
+
+  // Notify the module of the resumed simulation.
+  void doSimulationResume(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology, std::size_t firstSlot) override;
+
+  // Checkpoint callbacks.
+  bool doSaveState(Core::CheckpointWriter* writer) override;
+  bool doLoadState(Core::CheckpointReader* reader) override;
+};
+
+
+// An implementation of the output module that forwards every notification to
+//  a number of child modules. This allows producing several output formats in
+//  a single simulation run.
+class TeeOutputModule : public OutputModule {
+ public:
+  // Constructor.
+  TeeOutputModule() {}
+
+  // Destructor. Deletes all child modules.
+  ~TeeOutputModule() override;
+
+  // The tee owns its children, thus it must not be copied.
+  TeeOutputModule(const TeeOutputModule&) = delete;
+  TeeOutputModule& operator=(const TeeOutputModule&) = delete;
+
+  // Adds a child module. The tee takes ownership of the module. Children are
+  //  notified in the order in which they were added.
+  void addModule(OutputModule* module);
+
+  // Gets the number of child modules.
+  std::size_t getModuleCount() const { return mModules.size(); }
+
+ private:
+  // The child modules that notifications are forwarded to.
+  std::vector<OutputModule*> mModules;
+
+  // Notify the module of the beginning of the simulation.
+  void doSimulationBegin(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology) override;
+
+  // Notify the module of the beginning slot.
+  void doSlotBegin(std::size_t slotNumber) override;
+
+  // Notify the module of the chosen intention assignment
+  void doIntentChosen(const Core::IntentionAssignment& intent) override;
+
+  // Notify the module of the possible results of transitioning.
+  void doTransitionComputed(const std::vector<Core::NetworkState>& outcomes)
+    override;
+
+  // Notify the module of the chosen result of transitioning.
+  void doResultChosen(const Core::NetworkState& state) override;
+
+  // Notify the module of a protocol log message.
+  void doProtocolLog(const std::string& componentId,
+    const std::string& message) override;
+
+  // Notify the module of the ending slot.
+  void doSlotEnd() override;
+
+  // Notify the module of skipped slots.
+  void doSlotsSkipped(std::size_t firstSlot, std::size_t count,
+    const std::vector<Core::NetworkState>& cycle) override;
+
+  // Notify the module of the ending simulation.
+  void doSimulationEnd(std::size_t numSlots) override;
+
+  // Notify the module of the resumed simulation.
+  void doSimulationResume(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology, std::size_t firstSlot) override;
+
+  // Checkpoint callbacks.
+  bool doSaveState(Core::CheckpointWriter* writer) override;
+  bool doLoadState(Core::CheckpointReader* reader) override;
+};
+
+
+// An implementation of the output module that forwards only selected slots to
+//  a child module. Slots can be selected by a slot range, a stride, and a
+//  predicate on the chosen network state. Slots that are not selected are
+//  never formatted by the child module.
+class FilterOutputModule : public OutputModule {
+ public:
+  // Alias for predicates that decide whether or not a slot is selected based
+  //  on its chosen network state.
+  using SlotPredicate = std::function<bool(const Core::NetworkState&)>;
+
+  // Constructor. The filter takes ownership of the child module. By default,
+  //  every slot is selected.
+  explicit FilterOutputModule(OutputModule* module);
+
+  // Destructor. Deletes the child module.
+  ~FilterOutputModule() override;
+
+  // The filter owns its child, thus it must not be copied.
+  FilterOutputModule(const FilterOutputModule&) = delete;
+  FilterOutputModule& operator=(const FilterOutputModule&) = delete;
+
+  // Restricts the selected slots to the range [first, last].
+  void setSlotRange(std::size_t first, std::size_t last);
+
+  // Restricts the selected slots to every stride-th slot, counted from the
+  //  beginning of the slot range. Must be greater than zero.
+  void setStride(std::size_t stride);
+
+  // Restricts the selected slots to those whose chosen network state fulfills
+  //  the predicate. Slots in the range and stride are then held back until the
+  //  network state is known.
+  void setPredicate(SlotPredicate predicate);
+
+  // Additionally selects the given number of slots before and after each slot
+  //  fulfilling the predicate. Slots before a match are copied while they are
+  //  held back, thus this should only be used with small values.
+  void setContext(std::size_t before, std::size_t after);
+
+  // Creates a predicate that is fulfilled if any component has the given
+  //  component action type.
+  static SlotPredicate anyAction(Core::ActionType type);
+
+ private:
+  // A protocol log message that is held back.
+  struct HeldLog {
+    std::string componentId;
+    std::string message;
+  };
+
+  // A slot that is held back as context for a later match.
+  struct HeldSlot {
+    std::size_t slot;
+    std::vector<HeldLog> logs;
+    Core::IntentionAssignment intent;
+    std::vector<Core::NetworkState> outcomes;
+    Core::NetworkState result;
+  };
+
+  // The child module.
+  OutputModule* mModule;
+
+  // The first and last selected slot.
+  std::size_t mFirst;
+  std::size_t mLast;
+
+  // The stride of selected slots.
+  std::size_t mStride;
+
+  // The predicate on the chosen network state. May be empty.
+  SlotPredicate mPredicate;
+
+  // The number of context slots before and after a match.
+  std::size_t mBefore;
+  std::size_t mAfter;
+
+  // The number of context slots that still need to be selected after the
+  //  last match.
+  std::size_t mAfterLeft;
+
+  // The slots held back as context before a match.
+  std::deque<HeldSlot> mHeld;
+
+  // The current slot number.
+  std::size_t mSlot;
+
+  // Whether the current slot passed the slot range and the stride.
+  bool mCandidate;
+
+  // Whether the current slot is forwarded to the child module.
+  bool mForwarding;
+
+  // The intention assignment and outcomes of the current slot while it is held
+  //  back. These are only valid until the end of the slot.
+  const Core::IntentionAssignment* mIntent;
+  const std::vector<Core::NetworkState>* mOutcomes;
+
+  // The protocol log messages of the current slot while it is held back.
+  std::vector<HeldLog> mLogs;
+
+  // Forwards a complete slot (except its ending) to the child module.
+  void forwardSlot(std::size_t slot, const std::vector<HeldLog>& logs,
+    const Core::IntentionAssignment& intent,
+    const std::vector<Core::NetworkState>& outcomes,
+    const Core::NetworkState& state);
+
+  // Notify the module of the beginning of the simulation.
+  void doSimulationBegin(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology) override;
+
+  // Notify the module of the beginning slot.
+  void doSlotBegin(std::size_t slotNumber) override;
+
+  // Notify the module of the chosen intention assignment
+  void doIntentChosen(const Core::IntentionAssignment& intent) override;
+
+  // Notify the module of the possible results of transitioning.
+  void doTransitionComputed(const std::vector<Core::NetworkState>& outcomes)
+    override;
+
+  // Notify the module of the chosen result of transitioning.
+  void doResultChosen(const Core::NetworkState& state) override;
+
+  // Notify the module of a protocol log message.
+  void doProtocolLog(const std::string& componentId,
+    const std::string& message) override;
+
+  // Notify the module of the ending slot.
+  void doSlotEnd() override;
+
+  // Notify the module of skipped slots.
+  void doSlotsSkipped(std::size_t firstSlot, std::size_t count,
+    const std::vector<Core::NetworkState>& cycle) override;
+
+  // Notify the module of the ending simulation.
+  void doSimulationEnd(std::size_t numSlots) override;
+
+  // Notify the module of the resumed simulation.
+  void doSimulationResume(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology, std::size_t firstSlot) override;
+
+  // Checkpoint callbacks.
+  bool doSaveState(Core::CheckpointWriter* writer) override;
+  bool doLoadState(Core::CheckpointReader* reader) override;
+};
+
+
+// An implementation of the output module that aggregates statistics instead
+//  of recording the execution. The number of component actions of every type
+//  is counted per component and per slot. The time series also holds the
+//  channel utilization, as the number of slots in which any component sent.
+//  A summary (totals, per-component table, and time series) is written at the
+//  end of the simulation.
+class StatisticsOutputModule : public OutputModule {
+ public:
+  // The number of distinct component action types.
+  static const std::size_t kNumActionTypes = 6;
+
+  // Constructor. The summary is written to the given sink, which defaults to
+  //  the STDOUT sink (nullptr). The sink is not owned by the module. The time
+  //  series combines the given number of slots into a single sample (0
+  //  disables the time series).
+  explicit StatisticsOutputModule(Sink* sink = nullptr,
+    std::size_t slotsPerSample = 1);
+
+  // Gets the number of slots that were recorded.
+  std::size_t getSlotCount() const { return mSlotCount; }
+
+  // Gets the number of slots that were skipped instead of simulated. Their
+  //  component actions are extrapolated from the repeated network states, and
+  //  they are included in all other counters.
+  std::size_t getSkippedCount() const { return mSkippedCount; }
+
+  // Gets the number of component actions of the given type over all
+  //  components and slots.
+  std::size_t getTotal(Core::ActionType type) const;
+
+  // Gets the number of component actions of the given type for the component
+  //  with the given index (registration order).
+  std::size_t getComponentCount(std::size_t comp, Core::ActionType type)
+    const;
+
+  // Gets the number of samples in the time series.
+  std::size_t getSampleCount() const
+    { return mSampleCounts.size() / kNumActionTypes; }
+
+  // Gets the number of component actions of the given type in the sample with
+  //  the given index.
+  std::size_t getSampleCount(std::size_t sample, Core::ActionType type) const;
+
+  // Gets the number of slots in which any component sent in the sample with
+  //  the given index.
+  std::size_t getBusySlotCount(std::size_t sample) const;
+
+ private:
+  // The sink the summary is written to.
+  Sink* mSink;
+
+  // The number of slots per sample of the time series.
+  std::size_t mSlotsPerSample;
+
+  // The underlying network setup.
+  const Core::NetworkSetup* mSetup;
+
+  // The number of recorded slots.
+  std::size_t mSlotCount;
+
+  // The number of skipped slots, which are included in mSlotCount.
+  std::size_t mSkippedCount;
+
+  // The sample the current slot belongs to.
+  std::size_t mSample;
+
+  // The counters per component, kNumActionTypes consecutive entries per
+  //  component.
+  std::vector<std::size_t> mComponentCounts;
+
+  // The counters per sample, kNumActionTypes consecutive entries per sample.
+  std::vector<std::size_t> mSampleCounts;
+
+  // The number of slots in which any component sent, per sample.
+  std::vector<std::size_t> mBusySlots;
+
+  // Notify the module of the beginning of the simulation.
+  void doSimulationBegin(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology) override;
+
+  // Notify the module of the beginning slot.
+  void doSlotBegin(std::size_t slotNumber) override;
+
+  // Notify the module of the chosen intention assignment
+  void doIntentChosen(const Core::IntentionAssignment& intent) override {}
+
+  // Notify the module of the possible results of transitioning.
+  void doTransitionComputed(const std::vector<Core::NetworkState>& outcomes)
+    override {}
+
+  // Notify the module of the chosen result of transitioning.
+  void doResultChosen(const Core::NetworkState& state) override;
+
+  // Notify the module of the ending slot.
+  void doSlotEnd() override {}
+
+  // Notify the module of skipped slots.
+  void doSlotsSkipped(std::size_t firstSlot, std::size_t count,
+    const std::vector<Core::NetworkState>& cycle) override;
+
   // Notify the module of the ending simulation.
-  void doSimulationEnd() override;
+  void doSimulationEnd(std::size_t numSlots) override;
+
+  // Notify the module of the resumed simulation.
+  void doSimulationResume(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology, std::size_t firstSlot) override;
+
+  // Checkpoint callbacks.
+  bool doSaveState(Core::CheckpointWriter* writer) override;
+  bool doLoadState(Core::CheckpointReader* reader) override;
+};
+
+
+// An output module that writes a sidecar index of the byte offsets at which
+//  the slots of a child module's output begin. The index allows jumping to a
+//  slot range of a large trace (see TraceReader) without scanning it.
+//
+//  The index is binary and uses the native byte order. It starts with the
+//  8-byte magic kMagic and the number of slots per entry (64 bit). Then
+//  follow entries of a slot number and an offset (64 bit each), where the
+//  last entry has the slot number kEndSlot and the offset of the end of the
+//  last slot. Skipped slots are indexed by an entry for the first skipped slot
+//  whose offset is marked with kRangeFlag, as its output covers all slots up
+//  to the next entry, followed by an entry for the slot after them.
+class IndexOutputModule : public OutputModule {
+ public:
+  // The magic bytes at the beginning of an index.
+  static const char kMagic[8];
+
+  // The slot number of the entry that marks the end of the last slot.
+  static const std::uint64_t kEndSlot = UINT64_MAX;
+
+  // The bit of the offset that marks the entries of skipped slots.
+  static const std::uint64_t kRangeFlag = UINT64_C(1) << 63;
+
+  // Constructor. The module takes ownership of the child module, which must
+  //  write its output to the given trace sink. The index is written to the
+  //  given index sink. Neither sink is owned by the module. Only every
+  //  slotsPerEntry-th slot that the child is notified of gets an entry, which
+  //  must be greater than zero.
+  IndexOutputModule(OutputModule* module, const Sink* traceSink,
+    Sink* indexSink, std::size_t slotsPerEntry = 1);
+
+  // Destructor. Deletes the child module.
+  ~IndexOutputModule() override;
+
+  // The module owns its child, thus it must not be copied.
+  IndexOutputModule(const IndexOutputModule&) = delete;
+  IndexOutputModule& operator=(const IndexOutputModule&) = delete;
+
+ private:
+  // The child module.
+  OutputModule* mModule;
+
+  // The sink the child module writes to.
+  const Sink* mTraceSink;
+
+  // The sink the index is written to.
+  Sink* mIndexSink;
+
+  // The number of slots per index entry.
+  std::size_t mSlotsPerEntry;
+
+  // The number of slots seen so far.
+  std::size_t mSlotCount;
+
+  // The slot that already has an entry as it follows skipped slots, or
+  //  kEndSlot if there is none.
+  std::uint64_t mIndexedSlot;
+
+  // Writes an index entry.
+  void writeEntry(std::uint64_t slot, std::uint64_t offset);
+
+  // Notify the module of the beginning of the simulation.
+  void doSimulationBegin(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology) override;
+
+  // Notify the module of the beginning slot.
+  void doSlotBegin(std::size_t slotNumber) override;
+
+  // Notify the module of the chosen intention assignment
+  void doIntentChosen(const Core::IntentionAssignment& intent) override
+    { mModule->onIntentChosen(intent); }
+
+  // Notify the module of the possible results of transitioning.
+  void doTransitionComputed(const std::vector<Core::NetworkState>& outcomes)
+    override { mModule->onTransitionComputed(outcomes); }
+
+  // Notify the module of the chosen result of transitioning.
+  void doResultChosen(const Core::NetworkState& state) override
+    { mModule->onResultChosen(state); }
+
+  // Notify the module of a protocol log message.
+  void doProtocolLog(const std::string& componentId,
+    const std::string& message) override
+    { mModule->onProtocolLog(componentId, message); }
+
+  // Notify the module of the ending slot.
+  void doSlotEnd() override { mModule->onSlotEnd(); }
+
+  // Notify the module of skipped slots.
+  void doSlotsSkipped(std::size_t firstSlot, std::size_t count,
+    const std::vector<Core::NetworkState>& cycle) override;
+
+  // Notify the module of the ending simulation.
+  void doSimulationEnd(std::size_t numSlots) override;
+
+  // Notify the module of the resumed simulation.
+  void doSimulationResume(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology, std::size_t firstSlot) override;
+
+  // Checkpoint callbacks.
+  bool doSaveState(Core::CheckpointWriter* writer) override;
+  bool doLoadState(Core::CheckpointReader* reader) override;
+};
+
+
+// An output module that records the chosen intention assignments in the
+//  compact intent log format (see Core::IntentLog), which can be replayed
+//  without the protocols using Core::IntentLogReplayer.
+class IntentLogOutputModule : public OutputModule {
+ public:
+  // Constructor. The log is written to the given sink, which defaults to the
+  //  STDOUT sink (nullptr). The sink is not owned by the module.
+  explicit IntentLogOutputModule(Sink* sink = nullptr);
+
+ private:
+  // The sink the log is written to.
+  Sink* mSink;
+
+  // The underlying network setup.
+  const Core::NetworkSetup* mSetup;
+
+  // The number of the current slot.
+  std::size_t mSlot;
+
+  // The indices of the messages that were already defined in the log.
+  std::unordered_map<const Core::Message*, std::size_t> mMessageIndices;
+
+  // The buffers the records of a slot are encoded into. Message definitions
+  //  must precede the slot record that uses them.
+  std::string mDefinitions;
+  std::string mBuffer;
+
+  // Gets the index of a message, defining it in the log on first use.
+  std::size_t getMessageIndex(const Core::Message* msg);
+
+  // Notify the module of the beginning of the simulation.
+  void doSimulationBegin(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology) override;
+
+  // Notify the module of the beginning slot.
+  void doSlotBegin(std::size_t slotNumber) override { mSlot = slotNumber; }
+
+  // Notify the module of the chosen intention assignment
+  void doIntentChosen(const Core::IntentionAssignment& intent) override;
+
+  // Notify the module of the possible results of transitioning.
+  void doTransitionComputed(const std::vector<Core::NetworkState>& outcomes)
+    override {}
+
+  // Notify the module of the chosen result of transitioning.
+  void doResultChosen(const Core::NetworkState& state) override {}
+
+  // Notify the module of the ending slot.
+  void doSlotEnd() override {}
+
+  // Notify the module of skipped slots.
+  void doSlotsSkipped(std::size_t firstSlot, std::size_t count,
+    const std::vector<Core::NetworkState>& cycle) override;
+
+  // Notify the module of the ending simulation.
+  void doSimulationEnd(std::size_t numSlots) override;
+
+  // Notify the module of the resumed simulation.
+  void doSimulationResume(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology, std::size_t firstSlot) override;
+
+  // Checkpoint callbacks.
+  bool doSaveState(Core::CheckpointWriter* writer) override;
+  bool doLoadState(Core::CheckpointReader* reader) override;
+};
+
+
+// An implementation of the output module that writes flat records for bulk
+//  ingestion. There is one record per component and slot, consisting of the
+//  slot number, the component ID, the chosen intention, the resulting
+//  component action, and the tic and message of the component action (if
+//  any). Only the chosen results are recorded. Skipped slots (see
+//  OutputModule::onSlotsSkipped) are marked instead of recorded: by a JSON
+//  object with the first slot, the number of skipped slots and their period,
+//  or by a CSV row with the first slot, SKIPPED as intention and action, and
+//  the number of skipped slots in place of the tic.
+class RecordOutputModule : public OutputModule {
+ public:
+  // The supported record formats.
+  enum class Format {
+    // One JSON object per slot and line, holding the records of the slot.
+    JSON_LINES,
+
+    // One CSV row per record, preceded by a header row.
+    CSV
+  };
+
+  // Constructor. The records are written to the given sink in the given
+  //  format. The sink defaults to the STDOUT sink (nullptr) and is not owned
+  //  by the module.
+  explicit RecordOutputModule(Format format, Sink* sink = nullptr);
+
+ private:
+  // The format of the records.
+  Format mFormat;
+
+  // The sink the records are written to.
+  Sink* mSink;
+
+  // The underlying network setup.
+  const Core::NetworkSetup* mSetup;
+
+  // The number of the current slot.
+  std::size_t mSlot;
+
+  // The chosen intention assignment of the current slot. Valid until the end
+  //  of the slot.
+  const Core::IntentionAssignment* mIntent;
+
+  // The escaped component IDs, in registration order. Precomputed at the
+  //  beginning of the simulation.
+  std::vector<std::string> mComponentKeys;
+
+  // The escaped representations of registered messages, filled on first use.
+  std::unordered_map<const Core::Message*, std::string> mMessageKeys;
+
+  // The escaped representation of the last unregistered message. These are
+  //  not cached, as their addresses may be reused.
+  std::string mUncachedKey;
+
+  // The buffer the records of a slot are rendered into.
+  std::string mBuffer;
+
+  // Appends the given string to the target, escaped for the format.
+  void appendEscaped(std::string* target, const std::string& str) const;
+
+  // Gets the escaped representation of a message.
+  const std::string& getMessageKey(const Core::Message* msg);
+
+  // Appends the record of one component to the buffer.
+  void appendRecord(std::size_t comp, const Core::ComponentIntention& intent,
+    const Core::ComponentAction& action);
+
+  // Notify the module of the beginning of the simulation.
+  void doSimulationBegin(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology) override;
+
+  // Notify the module of the beginning slot.
+  void doSlotBegin(std::size_t slotNumber) override { mSlot = slotNumber; }
+
+  // Notify the module of the chosen intention assignment
+  void doIntentChosen(const Core::IntentionAssignment& intent) override
+    { mIntent = &intent; }
+
+  // Notify the module of the possible results of transitioning.
+  void doTransitionComputed(const std::vector<Core::NetworkState>& outcomes)
+    override {}
+
+  // Notify the module of the chosen result of transitioning.
+  void doResultChosen(const Core::NetworkState& state) override;
+
+  // Notify the module of the ending slot.
+  void doSlotEnd() override { mIntent = nullptr; }
+
+  // Notify the module of skipped slots.
+  void doSlotsSkipped(std::size_t firstSlot, std::size_t count,
+    const std::vector<Core::NetworkState>& cycle) override;
+
+  // Notify the module of the ending simulation.
+  void doSimulationEnd(std::size_t numSlots) override { mSink->flush(); }
+
+  // Notify the module of the resumed simulation.
+  void doSimulationResume(std::size_t numSlots, const Core::NetworkSetup* setup,
+    const Core::NetworkTopology* topology, std::size_t firstSlot) override;
+
+  // Checkpoint callbacks.
+  bool doSaveState(Core::CheckpointWriter* writer) override;
+  bool doLoadState(Core::CheckpointReader* reader) override;
 };
 
 
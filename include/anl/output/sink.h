@@ -0,0 +1,127 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#ifndef ANL_OUTPUT_SINK_H_
+#define ANL_OUTPUT_SINK_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// This file contains the declaration of output sinks.
+namespace Output {
+
+
+// A buffered destination for output that writes to a file descriptor. Output
+//  is collected in a buffer of configurable size and handed to the operating
+//  system in large writes.
+class Sink {
+ public:
+  // The default size of the buffer in bytes.
+  static const std::size_t kDefaultBufferSize = 64 * 1024;
+
+  // Constructor. Writes to the given file descriptor using a buffer of the
+  //  given size (0 disables buffering). If sync is set, the data is
+  //  synchronized to the storage device on destruction. If closeFd is set, the
+  //  file descriptor is closed on destruction.
+  Sink(int fd, std::size_t bufferSize = kDefaultBufferSize, bool sync = false,
+    bool closeFd = false);
+
+  // Destructor. Flushes the buffer.
+  ~Sink();
+
+  // The sink owns its buffer and possibly its file descriptor, thus it must
+  //  not be copied.
+  Sink(const Sink&) = delete;
+  Sink& operator=(const Sink&) = delete;
+
+  // Opens the file at the given path for writing and creates a sink for it.
+  //  The file is truncated unless requested otherwise, in which case the
+  //  output should continue after its content (see resumeAt). The sink closes
+  //  the file on destruction. Returns nullptr if the file can not be opened.
+  static Sink* openFile(const std::string& path,
+    std::size_t bufferSize = kDefaultBufferSize, bool sync = false,
+    bool truncate = true);
+
+  // Gets the process-wide sink for STDOUT with the default buffer size.
+  static Sink* getStdOut();
+
+  // Writes the given bytes.
+  void write(const char* data, std::size_t length);
+
+  // Writes the given string.
+  void write(const std::string& str) { write(str.data(), str.size()); }
+
+  // Writes formatted output like std::printf.
+  void print(const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+  // Hands all buffered output to the operating system.
+  void flush();
+
+  // Gets the size of the buffer in bytes.
+  std::size_t getBufferSize() const { return mBuffer.size(); }
+
+  // Gets the number of bytes written to this sink so far, including buffered
+  //  bytes. For files opened by openFile, this is the current file offset.
+  std::size_t getPosition() const { return mFlushed + mUsed; }
+
+  // Continues the output at the given position, which was reported by
+  //  getPosition before. Output after the position is discarded from regular
+  //  files, other destinations (e.g. pipes) are only appended to. Returns false
+  //  if the file ends before the position.
+  bool resumeAt(std::size_t position);
+
+ private:
+  // The file descriptor that is written to.
+  int mFd;
+
+  // The buffer.
+  std::vector<char> mBuffer;
+
+  // The number of used bytes in the buffer.
+  std::size_t mUsed;
+
+  // The number of bytes handed to the operating system.
+  std::size_t mFlushed;
+
+  // Whether or not to synchronize the data on destruction.
+  bool mSync;
+
+  // Whether or not to close the file descriptor on destruction.
+  bool mCloseFd;
+
+  // Writes the given bytes directly to the file descriptor.
+  void writeFd(const char* data, std::size_t length);
+};
+
+
+}  // namespace Output
+
+#endif  // ANL_OUTPUT_SINK_H_
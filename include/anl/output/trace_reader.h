@@ -0,0 +1,118 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#ifndef ANL_OUTPUT_TRACE_READER_H_
+#define ANL_OUTPUT_TRACE_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// This file contains the declaration of the trace reader.
+namespace Output {
+
+
+// Provides random access to the slots of a trace using the sidecar index
+//  written by IndexOutputModule. The trace is memory-mapped, thus only the
+//  requested parts are read from the storage device.
+class TraceReader {
+ public:
+  // Opens the trace and index at the given paths. Returns nullptr if a file
+  //  can not be opened or the index is invalid, i.e. if an offset lies outside
+  //  of the trace or the slots or offsets of its entries decrease.
+  static TraceReader* open(const std::string& tracePath,
+    const std::string& indexPath);
+
+  // Destructor. Unmaps the files.
+  ~TraceReader();
+
+  // The reader owns its mappings, thus it must not be copied.
+  TraceReader(const TraceReader&) = delete;
+  TraceReader& operator=(const TraceReader&) = delete;
+
+  // Gets the number of slots per index entry.
+  std::size_t getSlotsPerEntry() const { return mSlotsPerEntry; }
+
+  // Gets the number of index entries, not counting the end entry.
+  std::size_t getEntryCount() const { return mEntryCount; }
+
+  // Gets the slot number of the given index entry.
+  std::size_t getEntrySlot(std::size_t entry) const;
+
+  // Finds the part of the trace that contains the slots [first, last] and sets
+  //  its length. If the index has more than one slot per entry, the part may
+  //  additionally contain the other slots of the first and last entry. Skipped
+  //  slots are found as the record that covers all of them. Returns
+  //  nullptr and sets the length to zero if the part is empty. The data is
+  //  valid for as long as the reader is.
+  const char* findSlots(std::size_t first, std::size_t last,
+    std::size_t* length) const;
+
+ private:
+  // Constructor. Only used by open.
+  TraceReader();
+
+  // The mapped trace.
+  const char* mTrace;
+
+  // The size of the mapped trace.
+  std::size_t mTraceSize;
+
+  // The mapped index.
+  const char* mIndex;
+
+  // The size of the mapped index.
+  std::size_t mIndexSize;
+
+  // The entries of the index: slot number and offset, alternating. Points
+  //  into the mapped index.
+  const std::uint64_t* mEntries;
+
+  // The number of index entries, not counting the end entry.
+  std::size_t mEntryCount;
+
+  // The offset of the end of the last slot.
+  std::size_t mEndOffset;
+
+  // The number of slots per index entry.
+  std::size_t mSlotsPerEntry;
+
+  // Maps the file at the given path. Returns false on failure. Empty files
+  //  are mapped to nullptr.
+  static bool mapFile(const std::string& path, const char** data,
+    std::size_t* size);
+
+  // Gets the offset at which the given index entry begins.
+  std::size_t getEntryOffset(std::size_t entry) const;
+};
+
+
+}  // namespace Output
+
+#endif  // ANL_OUTPUT_TRACE_READER_H_
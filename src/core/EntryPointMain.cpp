@@ -28,6 +28,7 @@
 // Part of ANL-Impl.
 
 #include <getopt.h>
+#include <unistd.h>
 // cpplint forbids this header for some reason. Quick research of the problem
 //  shows that this seems to be related to chromium, which we do not use.
 #include <chrono>  // NOLINT
@@ -35,8 +36,14 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
 #include "anl/core/entry_point.h"
+#include "anl/core/replay.h"
 #include "anl/core/simulator.h"
+#include "anl/core/sweep.h"
+#include "anl/misc/log.h"
 
 using std::chrono::milliseconds;
 
@@ -59,15 +66,14 @@ EntryPointLoader::EntryPointLoader(EntryPointFunction cb) {
 
 // _____________________________________________________________________________
 static void printHeader() {
-  std::fprintf(stderr, "[ INFO ] ******************** ANL-Impl ANL simulator "
-    "v0.1.0 ********************\n");
-  std::fprintf(stderr, "[ INFO ] This is free and unencumbered software "
-    "released into the public domain.\n");
-  std::fprintf(stderr, "[ INFO ] For the full license text, visit "
-    "<https://unlicense.org/>\n");
-  std::fprintf(stderr, "[ INFO ] ***************************************"
-    "********************************\n");
-  std::fprintf(stderr, "[ INFO ]\n");
+  ANL_LOG(INFO, "******************** ANL-Impl ANL simulator "
+    "v0.1.0 ********************");
+  ANL_LOG(INFO, "This is free and unencumbered software released into the "
+    "public domain.");
+  ANL_LOG(INFO, "For the full license text, visit <https://unlicense.org/>");
+  ANL_LOG(INFO, "***************************************"
+    "********************************");
+  ANL_LOG(INFO, "%s", "");
 }
 
 
@@ -78,22 +84,290 @@ void printUsage(const char* binName) {
   std::fprintf(stderr, "  -h, --help:    Shows this help.\n");
   std::fprintf(stderr, "  -x, --xml:     Outputs the simulation execution "
     "using XML unless the\n                 simulation overrides this.\n");
+  std::fprintf(stderr, "  -O, --out <format>[:<path>]:\n                 "
+    "Outputs the simulation execution in the given format\n                 "
+    "(txt, xml, stats, jsonl, csv, or intents) to the given\n"
+    "                 file (STDOUT if omitted). May be given multiple times "
+    "to\n                 produce several outputs in a single run.\n");
+  std::fprintf(stderr, "  -o, --output <path>:\n                 Writes "
+    "outputs without an explicit path to the given\n                 file "
+    "instead of STDOUT.\n");
+  std::fprintf(stderr, "  --buffer <bytes>:\n                 Sets the "
+    "output buffer size (default: %zu, 0 disables\n                 "
+    "buffering).\n", Output::Sink::kDefaultBufferSize);
+  std::fprintf(stderr, "  --sync:        Synchronizes output files to the "
+    "storage device at the end.\n");
+  std::fprintf(stderr, "  --slots <first>[:[<last>]]:\n                 "
+    "Records only the given slot (range).\n");
+  std::fprintf(stderr, "  --stride <k>:  Records only every k-th slot of the "
+    "slot range.\n");
+  std::fprintf(stderr, "  --index <k>:   Writes an index of every k-th slot "
+    "to <path>.idx for\n                 outputs with an explicit path.\n");
+  std::fprintf(stderr, "  --sample <k>:  Combines k slots into one sample of "
+    "the statistics time\n                 series (default: 1, 0 disables "
+    "the time series).\n");
+  std::fprintf(stderr, "  --replay <path>:\n                 Replays the "
+    "intent log at the given path instead of\n                 running the "
+    "simulation entry point.\n");
+  std::fprintf(stderr, "  --semantics <naive|canonical>:\n                 "
+    "Sets the ANL semantics of the replay (default: naive).\n");
+  std::fprintf(stderr, "  --protocol-log <path|merge>:\n                 "
+    "Writes the protocol log to the given file, or merges\n                 "
+    "it into the outputs (default: logged to STDERR).\n");
+  std::fprintf(stderr, "  --quiescence <off|stop|skip>:\n                 "
+    "Stops the simulation once the network is quiescent, or\n"
+    "                 skips the remaining slots (default: off).\n");
+  std::fprintf(stderr, "  --cycles <off|stop|extrapolate>:\n                 "
+    "Stops the simulation once the whole network repeats an\n"
+    "                 earlier state, or extrapolates the remaining slots "
+    "from\n                 the cycle (default: off).\n");
+  std::fprintf(stderr, "  --checkpoint <path>:\n                 Writes a "
+    "checkpoint of the simulation to the given file,\n                 from "
+    "which it can be resumed.\n");
+  std::fprintf(stderr, "  --checkpoint-every <k>:\n                 Writes "
+    "the checkpoint after every k-th slot (default:\n                 "
+    "%zu).\n", Core::gDefaultCheckpointInterval);
+  std::fprintf(stderr, "  --resume:      Resumes the simulation from the "
+    "checkpoint, if it exists,\n                 and continues the output "
+    "files instead of truncating them.\n");
+  std::fprintf(stderr, "  -p, --param <name>=<value>:\n                 "
+    "Sets a parameter of the simulation.\n");
+  std::fprintf(stderr, "  --sweep <name>=<value>[,<value>...]:\n"
+    "                 Runs the simulation once for every combination of "
+    "the\n                 values of the swept parameters. Output paths "
+    "get the\n                 number of the run appended.\n");
+  std::fprintf(stderr, "  -j, --jobs <n>:\n                 Performs up to n "
+    "runs of a sweep at the same time\n                 (default: one per "
+    "processor).\n");
+  std::fprintf(stderr, "  --results <path>:\n                 Writes the "
+    "results table of a sweep to the given file\n                 instead "
+    "of STDOUT.\n");
+  std::fprintf(stderr, "  -q, --quiet:   Logs only warnings and errors.\n");
+  std::fprintf(stderr, "  --log-level <level>:\n                 Logs only "
+    "messages of at least the given level (fine,\n                 info, "
+    "protocol, warning, severe, or off; default: info).\n");
   std::fprintf(stderr, "  -v, --version: Shows only information about "
     "ANL-Impl\n");
 }
 
 
+// _____________________________________________________________________________
+// The sinks that were created for output modules. They are deleted (and thus
+//  flushed) at the end.
+static std::vector<Output::Sink*> gOutputSinks;
+
+// The sink used for outputs without an explicit path.
+static Output::Sink* gDefaultSink = nullptr;
+
+// The path of the default sink (STDOUT if empty).
+static std::string gDefaultPath;
+
+// The buffer size of created sinks.
+static std::size_t gBufferSize = Output::Sink::kDefaultBufferSize;
+
+// Whether or not created sinks are synchronized at the end.
+static bool gSync = false;
+
+// The range of recorded slots.
+static std::size_t gFirstSlot = 0;
+static std::size_t gLastSlot = std::numeric_limits<std::size_t>::max();
+
+// The stride of recorded slots.
+static std::size_t gStride = 1;
+
+// The number of slots per sample of statistics outputs.
+static std::size_t gSlotsPerSample = 1;
+
+// The number of slots per entry of slot indices (0 disables indices).
+static std::size_t gSlotsPerIndexEntry = 0;
+
+// The path of the intent log to replay (no replay if empty).
+static std::string gReplayPath;
+
+// The ANL semantics of the replay.
+static Core::ANLSemantics gReplaySemantics = Core::ANLSemantics::NAIVE;
+
+// The path of the protocol log ("merge" merges it into the outputs, STDERR is
+//  used if empty).
+static std::string gProtocolLogPath;
+
+// Whether or not created sinks continue the existing files of a resumed
+//  simulation instead of truncating them.
+static bool gContinueFiles = false;
+
+
+// _____________________________________________________________________________
+// The requested outputs, each given as format and optional path.
+static std::vector<std::string> gOutputSpecs;
+
+
+// _____________________________________________________________________________
+// The requested parameter sweep. Without swept parameters, the simulation
+//  entry point is invoked directly.
+static Core::ParameterSweep gSweep;
+
+
+// _____________________________________________________________________________
+// The number of runs of the sweep that are performed at the same time (0 for
+//  one per processor).
+static std::size_t gJobs = 0;
+
+
+// _____________________________________________________________________________
+// The path of the results table of the sweep (STDOUT if empty).
+static std::string gResultsPath;
+
+
+// _____________________________________________________________________________
+// The suffix of the paths of all files written by the current run. It keeps
+//  the files of the runs of a sweep apart.
+static std::string gRunSuffix;
+
+
+// _____________________________________________________________________________
+std::size_t parseSize(const char* str, const char* what, const char* binName) {
+  char* end = nullptr;
+  std::size_t result = std::strtoull(str, &end, 10);
+  if (*str == '\0' || *end != '\0') {
+    ANL_LOG(SEVERE, "Invalid %s: %s", what, str);
+    printUsage(binName);
+    std::exit(1);
+  }
+  return result;
+}
+
+
+// _____________________________________________________________________________
+Output::Sink* createSink(const std::string& path) {
+  Output::Sink* sink = nullptr;
+  if (path.empty()) {
+    sink = new Output::Sink(STDOUT_FILENO, gBufferSize);
+  } else {
+    sink = Output::Sink::openFile(path + gRunSuffix, gBufferSize, gSync,
+      !gContinueFiles);
+    if (sink == nullptr) {
+      ANL_LOG(SEVERE, "Could not open output file: %s%s", path.c_str(),
+        gRunSuffix.c_str());
+      std::exit(1);
+    }
+  }
+  gOutputSinks.push_back(sink);
+  return sink;
+}
+
+
+// _____________________________________________________________________________
+// Splits the given output specification into format and path (empty if
+//  omitted). Fails on unknown formats.
+void parseOutputSpec(const std::string& spec, const char* binName,
+    std::string* format, std::string* path) {
+  std::size_t sep = spec.find(':');
+  *format = spec.substr(0, sep);
+  *path = (sep == std::string::npos) ? "" : spec.substr(sep + 1);
+  if (*format != "txt" && *format != "xml" && *format != "stats"
+      && *format != "jsonl" && *format != "csv" && *format != "intents") {
+    ANL_LOG(SEVERE, "Unknown output format: %s", format->c_str());
+    printUsage(binName);
+    std::exit(1);
+  }
+}
+
+
+// _____________________________________________________________________________
+Output::OutputModule* createOutputModule(const std::string& spec,
+    const char* binName) {
+  std::string format;
+  std::string path;
+  parseOutputSpec(spec, binName, &format, &path);
+
+  // Determine the destination. Outputs without a path share the default sink.
+  Output::Sink* sink = nullptr;
+  if (path.empty()) {
+    if (gDefaultSink == nullptr) {
+      gDefaultSink = createSink(gDefaultPath);
+    }
+    sink = gDefaultSink;
+  } else {
+    sink = createSink(path);
+  }
+
+  Output::OutputModule* module = nullptr;
+  if (format == "xml") {
+    module = new Output::XMLOutputModule(sink);
+  } else if (format == "stats") {
+    module = new Output::StatisticsOutputModule(sink, gSlotsPerSample);
+  } else if (format == "jsonl") {
+    module = new Output::RecordOutputModule(
+      Output::RecordOutputModule::Format::JSON_LINES, sink);
+  } else if (format == "csv") {
+    module = new Output::RecordOutputModule(
+      Output::RecordOutputModule::Format::CSV, sink);
+  } else if (format == "intents") {
+    module = new Output::IntentLogOutputModule(sink);
+  } else {
+    module = new Output::StdOutOutputModule(sink);
+  }
+
+  // Index the output, if requested. Only outputs with their own file can be
+  //  indexed, as shared sinks interleave the outputs.
+  if (gSlotsPerIndexEntry > 0 && !path.empty()) {
+    module = new Output::IndexOutputModule(module, sink,
+      createSink(path + ".idx"), gSlotsPerIndexEntry);
+  }
+  return module;
+}
+
+
+// _____________________________________________________________________________
+// Splits the given assignment "<name>=<value>" into name and value.
+void parseAssignment(const char* str, const char* what, const char* binName,
+    std::string* name, std::string* value) {
+  std::string assignment(str);
+  std::size_t sep = assignment.find('=');
+  if (sep == 0 || sep == std::string::npos) {
+    ANL_LOG(SEVERE, "Invalid %s: %s", what, str);
+    printUsage(binName);
+    std::exit(1);
+  }
+  *name = assignment.substr(0, sep);
+  *value = assignment.substr(sep + 1);
+}
+
+
 // _____________________________________________________________________________
 void parseCommandLineArguments(int argc, char** argv) {
   struct option options[] = {
     { "xml", 0, NULL, 'x' },
+    { "out", 1, NULL, 'O' },
+    { "output", 1, NULL, 'o' },
+    { "buffer", 1, NULL, 'b' },
+    { "sync", 0, NULL, 's' },
+    { "slots", 1, NULL, 'r' },
+    { "stride", 1, NULL, 'k' },
+    { "sample", 1, NULL, 'S' },
+    { "index", 1, NULL, 'i' },
+    { "replay", 1, NULL, 'R' },
+    { "semantics", 1, NULL, 'M' },
+    { "protocol-log", 1, NULL, 'P' },
+    { "quiescence", 1, NULL, 'Q' },
+    { "cycles", 1, NULL, 'C' },
+    { "checkpoint", 1, NULL, 'c' },
+    { "checkpoint-every", 1, NULL, 'e' },
+    { "resume", 0, NULL, 'u' },
+    { "param", 1, NULL, 'p' },
+    { "sweep", 1, NULL, 'w' },
+    { "jobs", 1, NULL, 'j' },
+    { "results", 1, NULL, 'T' },
+    { "quiet", 0, NULL, 'q' },
+    { "log-level", 1, NULL, 'L' },
     { "version", 0, NULL, 'v' },
     { "help", 0, NULL, 'h' },
     { NULL, 0, NULL, 0 }
   };
   optind = 1;
   while (true) {
-    char c = getopt_long(argc, argv, "xvh", options, NULL);
+    char c = getopt_long(argc, argv,
+      "xO:o:b:sr:k:S:i:R:M:P:Q:C:c:e:up:w:j:T:qL:vh", options, NULL);
     if (c == -1) {
       // No more options.
       break;
@@ -107,7 +381,188 @@ void parseCommandLineArguments(int argc, char** argv) {
         break;
       case 'x':
         // Requesting XML.
-        Core::gDefaultOutModule = new Output::XMLOutputModule();
+        gOutputSpecs.push_back("xml");
+        break;
+      case 'O':
+        // Requesting an additional output.
+        {
+          std::string format;
+          std::string path;
+          parseOutputSpec(optarg, argv[0], &format, &path);
+          gOutputSpecs.push_back(optarg);
+        }
+        break;
+      case 'o':
+        // Requesting a default destination other than STDOUT.
+        gDefaultPath = optarg;
+        break;
+      case 'b':
+        // Requesting a buffer size.
+        gBufferSize = parseSize(optarg, "buffer size", argv[0]);
+        break;
+      case 's':
+        // Requesting synchronization of output files.
+        gSync = true;
+        break;
+      case 'r':
+        // Requesting a slot range.
+        {
+          std::string range(optarg);
+          std::size_t sep = range.find(':');
+          if (sep == std::string::npos) {
+            gFirstSlot = gLastSlot = parseSize(optarg, "slot", argv[0]);
+          } else {
+            gFirstSlot = parseSize(range.substr(0, sep).c_str(), "slot",
+              argv[0]);
+            if (sep + 1 < range.size()) {
+              gLastSlot = parseSize(range.substr(sep + 1).c_str(), "slot",
+                argv[0]);
+            }
+          }
+          if (gFirstSlot > gLastSlot) {
+            ANL_LOG(SEVERE, "Empty slot range: %s", optarg);
+            std::exit(1);
+          }
+        }
+        break;
+      case 'S':
+        // Requesting a sample size for statistics.
+        gSlotsPerSample = parseSize(optarg, "sample size", argv[0]);
+        break;
+      case 'i':
+        // Requesting slot indices.
+        gSlotsPerIndexEntry = parseSize(optarg, "index interval", argv[0]);
+        break;
+      case 'R':
+        // Requesting a replay.
+        gReplayPath = optarg;
+        break;
+      case 'M':
+        // Requesting replay semantics.
+        if (std::string(optarg) == "naive") {
+          gReplaySemantics = Core::ANLSemantics::NAIVE;
+        } else if (std::string(optarg) == "canonical") {
+          gReplaySemantics = Core::ANLSemantics::CANONICAL;
+        } else {
+          ANL_LOG(SEVERE, "Unknown semantics: %s", optarg);
+          printUsage(argv[0]);
+          std::exit(1);
+        }
+        break;
+      case 'k':
+        // Requesting a stride.
+        gStride = parseSize(optarg, "stride", argv[0]);
+        if (gStride == 0) {
+          ANL_LOG(SEVERE, "Stride must be greater than zero.");
+          std::exit(1);
+        }
+        break;
+      case 'P':
+        // Requesting a protocol log destination.
+        gProtocolLogPath = optarg;
+        break;
+      case 'Q':
+        // Requesting quiescence detection.
+        if (std::string(optarg) == "off") {
+          Core::gDefaultQuiescenceMode = Core::QuiescenceMode::OFF;
+        } else if (std::string(optarg) == "stop") {
+          Core::gDefaultQuiescenceMode = Core::QuiescenceMode::STOP;
+        } else if (std::string(optarg) == "skip") {
+          Core::gDefaultQuiescenceMode = Core::QuiescenceMode::FAST_FORWARD;
+        } else {
+          ANL_LOG(SEVERE, "Unknown quiescence mode: %s", optarg);
+          printUsage(argv[0]);
+          std::exit(1);
+        }
+        break;
+      case 'C':
+        // Requesting cycle detection.
+        if (std::string(optarg) == "off") {
+          Core::gDefaultCycleMode = Core::CycleMode::OFF;
+        } else if (std::string(optarg) == "stop") {
+          Core::gDefaultCycleMode = Core::CycleMode::STOP;
+        } else if (std::string(optarg) == "extrapolate") {
+          Core::gDefaultCycleMode = Core::CycleMode::EXTRAPOLATE;
+        } else {
+          ANL_LOG(SEVERE, "Unknown cycle mode: %s", optarg);
+          printUsage(argv[0]);
+          std::exit(1);
+        }
+        break;
+      case 'c':
+        // Requesting checkpoints.
+        Core::gDefaultCheckpointPath = optarg;
+        break;
+      case 'e':
+        // Requesting a checkpoint interval.
+        Core::gDefaultCheckpointInterval = parseSize(optarg,
+          "checkpoint interval", argv[0]);
+        if (Core::gDefaultCheckpointInterval == 0) {
+          ANL_LOG(SEVERE, "Checkpoint interval must be greater than zero.");
+          std::exit(1);
+        }
+        break;
+      case 'u':
+        // Requesting to resume from the checkpoint.
+        Core::gDefaultResume = true;
+        break;
+      case 'p':
+        // Requesting a parameter value.
+        {
+          std::string name;
+          std::string value;
+          parseAssignment(optarg, "parameter", argv[0], &name, &value);
+          Core::Parameters::set(name, value);
+        }
+        break;
+      case 'w':
+        // Requesting a swept parameter.
+        {
+          std::string name;
+          std::string list;
+          parseAssignment(optarg, "sweep", argv[0], &name, &list);
+          for (std::size_t p = 0; p < gSweep.getParameterCount(); p++) {
+            if (gSweep.getParameterName(p) == name) {
+              ANL_LOG(SEVERE, "Parameter swept twice: %s", name.c_str());
+              std::exit(1);
+            }
+          }
+          std::vector<std::string> values;
+          std::size_t begin = 0;
+          while (true) {
+            std::size_t end = list.find(',', begin);
+            values.push_back(list.substr(begin, end - begin));
+            if (end == std::string::npos) {
+              break;
+            }
+            begin = end + 1;
+          }
+          gSweep.addParameter(name, values);
+        }
+        break;
+      case 'j':
+        // Requesting a number of concurrent runs.
+        gJobs = parseSize(optarg, "number of jobs", argv[0]);
+        break;
+      case 'T':
+        // Requesting a destination for the results table.
+        gResultsPath = optarg;
+        break;
+      case 'q':
+        // Requesting only warnings and errors.
+        Misc::Log::setLevel(Misc::LogLevel::WARNING);
+        break;
+      case 'L':
+        // Requesting a log level.
+        {
+          Misc::LogLevel level = Misc::LogLevel::INFO;
+          if (!Misc::Log::parseLevel(optarg, &level)) {
+            ANL_LOG(SEVERE, "Unknown log level: %s", optarg);
+            printUsage(argv[0]);
+            std::exit(1);
+          }
+          Misc::Log::setLevel(level);
+        }
         break;
       case 'v':
         // Requesting header only.
@@ -116,6 +571,177 @@ void parseCommandLineArguments(int argc, char** argv) {
         break;
     }
   }
+
+  // A resumed simulation needs a checkpoint to resume from.
+  if (Core::gDefaultResume && Core::gDefaultCheckpointPath.empty()) {
+    ANL_LOG(SEVERE, "Resuming requires a checkpoint.");
+    std::exit(1);
+  }
+
+  // The runs of a sweep write their outputs to distinct files, while their
+  //  results are collected in a single table.
+  if (gSweep.getParameterCount() > 0) {
+    if (!gReplayPath.empty()) {
+      ANL_LOG(SEVERE, "A replay can not be swept.");
+      std::exit(1);
+    }
+    for (const std::string& spec : gOutputSpecs) {
+      std::string format;
+      std::string path;
+      parseOutputSpec(spec, argv[0], &format, &path);
+      if (path.empty() && gDefaultPath.empty()) {
+        ANL_LOG(SEVERE, "Outputs of a sweep need a path: %s", spec.c_str());
+        std::exit(1);
+      }
+    }
+  }
+}
+
+
+// _____________________________________________________________________________
+// Prepares the outputs of the simulation run, i.e. of the whole simulation or
+//  of a single run of the sweep.
+void prepareRun(const char* binName) {
+  // A resumed simulation continues its output files. Without a checkpoint, it
+  //  starts from scratch.
+  if (!Core::gDefaultCheckpointPath.empty()) {
+    Core::gDefaultCheckpointPath += gRunSuffix;
+  }
+  if (Core::gDefaultResume) {
+    gContinueFiles = ::access(Core::gDefaultCheckpointPath.c_str(), F_OK) == 0;
+  }
+
+  // Create the requested output modules. Plain text is used if nothing else
+  //  was requested (runs of a sweep only produce the requested outputs). A
+  //  single output is used directly, multiple outputs are combined using a
+  //  tee.
+  if (gOutputSpecs.empty() && gSweep.getParameterCount() == 0) {
+    gOutputSpecs.push_back("txt");
+  }
+  if (gOutputSpecs.size() == 1) {
+    Core::gDefaultOutModule = createOutputModule(gOutputSpecs.front(),
+      binName);
+  } else if (gOutputSpecs.size() > 1) {
+    Output::TeeOutputModule* tee = new Output::TeeOutputModule();
+    for (const std::string& spec : gOutputSpecs) {
+      tee->addModule(createOutputModule(spec, binName));
+    }
+    Core::gDefaultOutModule = tee;
+  }
+
+  // Redirect the protocol log, if requested.
+  if (gProtocolLogPath == "merge") {
+    Core::gDefaultMergeProtocolLog = true;
+  } else if (!gProtocolLogPath.empty()) {
+    Core::gDefaultProtocolLogSink = createSink(gProtocolLogPath);
+  }
+
+  // Restrict the recorded slots, if requested.
+  if (Core::gDefaultOutModule != nullptr && (gFirstSlot != 0
+      || gLastSlot != std::numeric_limits<std::size_t>::max()
+      || gStride != 1)) {
+    Output::FilterOutputModule* filter =
+      new Output::FilterOutputModule(Core::gDefaultOutModule);
+    filter->setSlotRange(gFirstSlot, gLastSlot);
+    filter->setStride(gStride);
+    Core::gDefaultOutModule = filter;
+  }
+}
+
+
+// _____________________________________________________________________________
+// Removes the outputs of the simulation run, which flushes them.
+void finishRun() {
+  // Remove any created output module.
+  if (Core::gDefaultOutModule != nullptr) {
+    delete Core::gDefaultOutModule;
+    Core::gDefaultOutModule = nullptr;
+  }
+
+  // Remove (and thus flush and close) any created sink.
+  for (Output::Sink* sink : gOutputSinks) {
+    delete sink;
+  }
+  gOutputSinks.clear();
+}
+
+
+// _____________________________________________________________________________
+// Performs the given run of the sweep in a process of its own. Writes the
+//  slot count, the totals of the component actions and the duration of the
+//  run as a row of the results table to the given sink.
+int performRun(std::size_t run, Output::Sink* results, int argc, char** argv,
+    const char* binName) {
+  auto startTime = std::chrono::high_resolution_clock::now();
+  gRunSuffix = "." + std::to_string(run);
+  prepareRun(binName);
+
+  // The totals are collected alongside the requested outputs, over all slots.
+  Output::Sink* nullSink = Output::Sink::openFile("/dev/null", 0);
+  Output::StatisticsOutputModule* stats =
+    new Output::StatisticsOutputModule(nullSink, 0);
+  Output::TeeOutputModule* tee = new Output::TeeOutputModule();
+  if (Core::gDefaultOutModule != nullptr) {
+    tee->addModule(Core::gDefaultOutModule);
+  }
+  tee->addModule(stats);
+  Core::gDefaultOutModule = tee;
+
+  int result = Core::gEntryPointPtr(argc, argv);
+  auto endTime = std::chrono::high_resolution_clock::now();
+  milliseconds diffTime =
+    std::chrono::duration_cast<milliseconds>(endTime - startTime);
+  results->print("%zu %zu", stats->getSlotCount(), stats->getSkippedCount());
+  for (std::size_t type = 0;
+      type < Output::StatisticsOutputModule::kNumActionTypes; type++) {
+    results->print(" %zu",
+      stats->getTotal(static_cast<Core::ActionType>(type)));
+  }
+  results->print(" %" PRId64 "\n", static_cast<std::int64_t>(diffTime.count()));
+
+  finishRun();
+  delete nullSink;
+  return result;
+}
+
+
+// _____________________________________________________________________________
+// Performs all runs of the sweep and writes the results table. Returns
+//  non-zero if any run failed.
+int runSweep(int argc, char** argv, const char* binName) {
+  ANL_LOG(INFO, "Sweeping %zu parameter(s) in %zu runs.",
+    gSweep.getParameterCount(), gSweep.getRunCount());
+  std::vector<Core::ParameterSweep::Result> results = gSweep.run(gJobs,
+    [argc, argv, binName](std::size_t run, Output::Sink* sink) {
+      return performRun(run, sink, argc, argv, binName);
+    });
+
+  // One row per run, containing its parameters, exit status and totals. The
+  //  totals of runs that did not report them are replaced by '-'.
+  Output::Sink* sink = createSink(gResultsPath);
+  sink->print("# Results of %zu runs.\n", results.size());
+  sink->print("%s", gSweep.getTableHeader({ "status", "slots", "skipped",
+    "IDLE", "SILENCE", "COLLISION", "RECEIVED", "SENT", "CANCELLED", "ms"
+  }).c_str());
+  int result = 0;
+  for (std::size_t run = 0; run < results.size(); run++) {
+    sink->print("%zu", run);
+    for (std::size_t param = 0; param < gSweep.getParameterCount(); param++) {
+      sink->print(" %s", gSweep.getValue(run, param).c_str());
+    }
+    sink->print(" %d", results[run].status);
+    if (results[run].output.empty()) {
+      sink->print(" - - - - - - - - -\n");
+    } else {
+      sink->print(" %s", results[run].output.c_str());
+    }
+    if (results[run].status != 0) {
+      ANL_LOG(WARNING, "Run %zu of the sweep failed: %d", run,
+        results[run].status);
+      result = 1;
+    }
+  }
+  return result;
 }
 
 
@@ -123,47 +749,64 @@ void parseCommandLineArguments(int argc, char** argv) {
 int main(int argc, char** argv) {
   auto startTime = std::chrono::high_resolution_clock::now();
 
-  // Parse the command line.
+  // Parse the command line. The outputs of a sweep are prepared per run.
   parseCommandLineArguments(argc, argv);
-
-  // Set the default output module to the plain STDOUT module if none was set.
-  if (Core::gDefaultOutModule == nullptr) {
-    Core::gDefaultOutModule = new Output::StdOutOutputModule();
+  const char* binName = argv[0];
+  if (gSweep.getParameterCount() == 0) {
+    prepareRun(binName);
   }
 
   printHeader();
-  std::fprintf(stderr, "[ INFO ] Starting ANL-Impl ANL simulator.\n");
+  ANL_LOG(INFO, "Starting ANL-Impl ANL simulator.");
 
-  // Check that an entry point was set.
-  if (Core::gEntryPointPtr == &Core::dummy) {
-    std::fprintf(stderr, "[SEVERE] No entry point for simulation "
-      "(ANLIMPL_MAIN) declared!\n");
-    return 1;
-  }
+  int result = 0;
+  if (!gReplayPath.empty()) {
+    // A replay does not need the simulation, thus any binary linked against
+    //  the library can replay intent logs.
+    Core::IntentLogReplayer* replayer =
+      Core::IntentLogReplayer::open(gReplayPath);
+    if (replayer == nullptr) {
+      ANL_LOG(SEVERE, "Could not read intent log: %s", gReplayPath.c_str());
+      return 1;
+    }
+    std::size_t numSlots = replayer->run(Core::gDefaultOutModule,
+      gReplaySemantics);
+    ANL_LOG(INFO, "Replayed %zu slots.", numSlots);
+    delete replayer;
+  } else {
+    // Check that an entry point was set.
+    if (Core::gEntryPointPtr == &Core::dummy) {
+      ANL_LOG(SEVERE, "No entry point for simulation (ANLIMPL_MAIN) "
+        "declared!");
+      return 1;
+    }
 
-  // Remove "our" arguments from the command line for the case the simulation
-  //  parses these on its own.
-  argc -= optind - 1;
-  argv = &argv[optind - 1];
+    // Remove "our" arguments from the command line for the case the
+    //  simulation parses these on its own.
+    argc -= optind - 1;
+    argv = &argv[optind - 1];
 
-  // Invoke the simulation entry point.
-  int result = Core::gEntryPointPtr(argc, argv);
-  if (result != 0) {
-    std::fprintf(stderr, "[ WARN ] Result of simulation entry point is "
-      "non-zero: %d\n", result);
+    // Invoke the simulation entry point, once per run of a sweep.
+    if (gSweep.getParameterCount() > 0) {
+      result = runSweep(argc, argv, binName);
+    } else {
+      result = Core::gEntryPointPtr(argc, argv);
+    }
+    if (result != 0) {
+      ANL_LOG(WARNING, "Result of simulation entry point is non-zero: %d",
+        result);
+    }
   }
 
   // Notify the user of the simulation's end.
   auto endTime = std::chrono::high_resolution_clock::now();
   milliseconds diffTime =
     std::chrono::duration_cast<milliseconds>(endTime - startTime);
-  std::fprintf(stderr, "[ INFO ] Simulation completed in %" PRId64 "ms.\n",
+  ANL_LOG(INFO, "Simulation completed in %" PRId64 "ms.",
     static_cast<std::int64_t>(diffTime.count()));
 
-  // Remove any created output module.
-  if (Core::gDefaultOutModule != nullptr) {
-    delete Core::gDefaultOutModule;
-  }
+  // Remove the outputs.
+  finishRun();
 
   // Return the return value from the wrapped main function.
   return result;
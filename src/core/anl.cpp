@@ -28,10 +28,14 @@
 // Part of ANL-Impl.
 
 #include "anl/core/anl.h"
-#include <cstdio>
-#include <sstream>
+#include <string>
+#include <vector>
 #include "anl/core/anl_algorithm.h"
+#include "anl/core/message_pool.h"
+#include "anl/core/protocol_log.h"
 #include "anl/misc/asserts.h"
+#include "anl/misc/log.h"
+#include "anl/misc/strings.h"
 
 using std::size_t;
 
@@ -40,7 +44,7 @@ namespace Core {
 
 
 // _____________________________________________________________________________
-static std::string getSymbolForType(ActionType type) {
+static const char* getSymbolForType(ActionType type) {
   switch (type) {
     case ActionType::IDLE: return "IDL";
     case ActionType::SILENCE: return "SIL";
@@ -54,7 +58,7 @@ static std::string getSymbolForType(ActionType type) {
 }
 
 // _____________________________________________________________________________
-static std::string getSymbolForType(IntentionType type) {
+static const char* getSymbolForType(IntentionType type) {
   switch (type) {
     case IntentionType::IDLE: return "IDL";
     case IntentionType::LISTEN: return "LST";
@@ -75,7 +79,8 @@ NetworkSetup::NetworkSetup(size_t ticsPerSlot) : mTicsPerSlot(ticsPerSlot) {
 void NetworkSetup::registerMessage(const Message* msg) {
   Misc::Asserts::require(!isMessage(msg), "duplicate message registered");
   Misc::Asserts::require(msg != nullptr, "can not register nullptr as message");
-  mMessages.insert(msg);
+  mMessages.emplace(msg, MessageCache());
+  mRegisteredMessages.push_back(msg);
 }
 
 // _____________________________________________________________________________
@@ -83,22 +88,91 @@ void NetworkSetup::registerComponent(Component* comp) {
   Misc::Asserts::require(comp != nullptr, "can not register nullptr as "
     "component");
   Misc::Asserts::require(!isComponent(*comp), "duplicate component registered");
+  mComponentIndices.emplace(comp, mComponents.size());
   mComponents.push_back(comp);
+  mComponentIds.push_back(comp->getId());
+  mComponentXML.push_back(comp->toXML());
 }
 
 // _____________________________________________________________________________
-bool NetworkSetup::isMessage(const Message* msg) const {
-  return mMessages.find(msg) != mMessages.end();
+void NetworkSetup::registerMessageFamily(const MessageFamily* family) {
+  Misc::Asserts::require(family != nullptr, "can not register nullptr as "
+    "message family");
+  mMessageFamilies.push_back(family);
 }
 
 // _____________________________________________________________________________
-bool NetworkSetup::isComponent(const Component& comp) const {
-  for (const Component* elem : mComponents) {
-    if (elem == &comp) {
-      return true;
+NetworkSetup::MessageCache* NetworkSetup::findMessage(const Message* msg)
+    const {
+  auto entry = mMessages.find(msg);
+  if (entry != mMessages.end()) {
+    return &entry->second;
+  }
+
+  // Register the message lazily if one of the families knows it.
+  for (const MessageFamily* family : mMessageFamilies) {
+    if (msg != nullptr && family->contains(msg)) {
+      return &mMessages.emplace(msg, MessageCache()).first->second;
     }
   }
-  return false;
+  return nullptr;
+}
+
+// _____________________________________________________________________________
+const std::string& NetworkSetup::getMessageString(const Message* msg) const {
+  const std::string* str = findMessageString(msg);
+  Misc::Asserts::require(str != nullptr, "message not registered with the "
+    "network setup");
+  return *str;
+}
+
+// _____________________________________________________________________________
+const std::vector<std::string>& NetworkSetup::getMessageXML(
+    const Message* msg) const {
+  const std::vector<std::string>* xml = findMessageXML(msg);
+  Misc::Asserts::require(xml != nullptr, "message not registered with the "
+    "network setup");
+  return *xml;
+}
+
+// _____________________________________________________________________________
+const std::string* NetworkSetup::findMessageString(const Message* msg) const {
+  MessageCache* cache = findMessage(msg);
+  if (cache == nullptr) {
+    return nullptr;
+  }
+  if (!cache->mHasString) {
+    cache->mString = msg->toString();
+    cache->mHasString = true;
+  }
+  return &cache->mString;
+}
+
+// _____________________________________________________________________________
+const std::vector<std::string>* NetworkSetup::findMessageXML(
+    const Message* msg) const {
+  MessageCache* cache = findMessage(msg);
+  if (cache == nullptr) {
+    return nullptr;
+  }
+  if (!cache->mHasXML) {
+    cache->mXML = msg->toXML();
+    cache->mHasXML = true;
+  }
+  return &cache->mXML;
+}
+
+// _____________________________________________________________________________
+bool NetworkSetup::isComponent(const Component& comp) const {
+  return mComponentIndices.find(&comp) != mComponentIndices.end();
+}
+
+// _____________________________________________________________________________
+std::size_t NetworkSetup::getComponentIndex(const Component* comp) const {
+  auto entry = mComponentIndices.find(comp);
+  Misc::Asserts::require(entry != mComponentIndices.end(), "component not "
+    "registered with the network setup");
+  return entry->second;
 }
 
 // _____________________________________________________________________________
@@ -114,67 +188,89 @@ template<class T>
 ComponentTrait<T>::ComponentTrait(const NetworkSetup& setup, T type,
     std::size_t tic, const Message* message) : mType(type), mTic(tic),
       mMessage(message) {
-  // Assert tic number < maxTic.
-  Misc::Asserts::require(setup.getTicsPerSlot() > tic,
+  // Assert tic number < maxTic. Tics chosen by protocols are checked by the
+  //  ANLView already.
+  ANL_DEBUG_REQUIRE(setup.getTicsPerSlot() > tic,
     "invalid tic number: too big");
 
   // We expect that existing messages are registered. But we allow them not to
   // be.
-  if (message != nullptr) {
-    Misc::Asserts::expect(setup.isMessage(message),
-      "message not registered with the network setup!");
-  }
+  ANL_DEBUG_EXPECT(message == nullptr || setup.isMessage(message),
+    "message not registered with the network setup!");
 }
 
 // _____________________________________________________________________________
 template<class T>
 std::string ComponentTrait<T>::toString() const {
-  if (mMessage == nullptr) {
-    // Only show the symbol for the type.
-    return getSymbolForType(mType);
-  } else {
-    // Show the symbol together with message and tic.
-    std::stringstream sstr;
-    sstr << getSymbolForType(mType);
-    sstr << "[";
-    sstr << mMessage->toString();
-    sstr << ", ";
-    sstr << mTic;
-    sstr << "]";
-    return sstr.str();
+  std::string buffer;
+  appendText(&buffer, nullptr);
+  return buffer;
+}
+
+// _____________________________________________________________________________
+template<class T>
+void ComponentTrait<T>::appendText(std::string* buffer,
+    const NetworkSetup* setup) const {
+  buffer->append(getSymbolForType(mType));
+  if (mMessage != nullptr) {
+    // Show the symbol together with message and tic. Unregistered messages
+    //  are tolerated (see constructor), but are not cached.
+    buffer->push_back('[');
+    const std::string* str = setup == nullptr ? nullptr
+      : setup->findMessageString(mMessage);
+    if (str != nullptr) {
+      buffer->append(*str);
+    } else {
+      mMessage->appendText(buffer);
+    }
+    buffer->append(", ");
+    Misc::Strings::appendNumber(buffer, mTic);
+    buffer->push_back(']');
   }
 }
 
 // _____________________________________________________________________________
 template<class T>
 std::vector<std::string> ComponentTrait<T>::toXML() const {
-  std::vector<std::string> res;
-  std::stringstream sstr;
+  std::string buffer;
+  appendXML(&buffer, 0, nullptr);
+  return Misc::Strings::splitLines(buffer);
+}
 
-  res.push_back("<trait>");
+// _____________________________________________________________________________
+template<class T>
+void ComponentTrait<T>::appendXML(std::string* buffer, std::size_t indent,
+    const NetworkSetup* setup) const {
+  Misc::Strings::appendIndent(buffer, indent);
+  buffer->append("<trait>\n");
 
-  sstr << "  <type>" << getSymbolForType(mType) << "</type>";
-  res.push_back(sstr.str());
-  sstr.str("");
+  Misc::Strings::appendIndent(buffer, indent + 2);
+  buffer->append("<type>");
+  buffer->append(getSymbolForType(mType));
+  buffer->append("</type>\n");
 
   if (mMessage != nullptr) {
-    res.push_back("  <msg>");
-    std::vector<std::string> xmlRepr = mMessage->toXML();
-    for (const std::string& rpr : xmlRepr) {
-      sstr << "    " << rpr;
-      res.push_back(sstr.str());
-      sstr.str("");
+    Misc::Strings::appendIndent(buffer, indent + 2);
+    buffer->append("<msg>\n");
+    // Unregistered messages are tolerated, but are not cached.
+    const std::vector<std::string>* xml = setup == nullptr ? nullptr
+      : setup->findMessageXML(mMessage);
+    if (xml != nullptr) {
+      Misc::Strings::appendLines(buffer, *xml, indent + 4);
+    } else {
+      mMessage->appendXML(buffer, indent + 4);
     }
-    res.push_back("  </msg>");
+    Misc::Strings::appendIndent(buffer, indent + 2);
+    buffer->append("</msg>\n");
 
-    sstr << "  <tic>" << mTic << "</tic>";
-    res.push_back(sstr.str());
-    sstr.str("");
+    Misc::Strings::appendIndent(buffer, indent + 2);
+    buffer->append("<tic>");
+    Misc::Strings::appendNumber(buffer, mTic);
+    buffer->append("</tic>\n");
   }
 
-  res.push_back("</trait>");
-
-  return res;
+  Misc::Strings::appendIndent(buffer, indent);
+  buffer->append("</trait>\n");
 }
 
 // _____________________________________________________________________________
@@ -191,7 +287,7 @@ bool ComponentTrait<T>::operator==(const ComponentTrait<T>& other) const {
 // _____________________________________________________________________________
 template<class T>
 TraitMapping<T>::TraitMapping(const NetworkSetup* setup) : mSetup(setup),
-  mPartial(true) {}
+  mCount(0), mPartial(true) {}
 
 // _____________________________________________________________________________
 template<class T>
@@ -199,92 +295,184 @@ const ComponentTrait<T>& TraitMapping<T>::getTraitFor(const Component* comp)
     const {
   Misc::Asserts::require(!mPartial,
     "attempting to get trait for partial trait mapping");
-  Misc::Asserts::require(mSetup->isComponent(*comp),
+  ANL_PARANOID_REQUIRE(mSetup->isComponent(*comp),
     "not a valid component for associated network setup");
 
   // An invariant of trait mappings is that if mPartial == false, then every
-  // valid component is mapped. Thus this can not throw.
-  return mMapping.at(comp);
+  // valid component is mapped.
+  return mTraits[mSetup->getComponentIndex(comp)];
 }
 
 // _____________________________________________________________________________
 template<class T>
 void TraitMapping<T>::setTraitFor(const Component* comp,
     const ComponentTrait<T>& action) {
-  Misc::Asserts::require(mSetup->isComponent(*comp),
+  ANL_PARANOID_REQUIRE(mSetup->isComponent(*comp),
     "not a valid component for associated network setup");
 
-  // Add the entry, if it is no duplicate.
-  auto entry = mMapping.find(comp);
-  Misc::Asserts::require(entry == mMapping.end(), "can not override component "
-    "trait for component");
-  mMapping.emplace(comp, action);
+  // The storage is created on first use, for all components at once.
+  std::size_t index = mSetup->getComponentIndex(comp);
+  if (index >= mTraits.size()) {
+    mTraits.resize(mSetup->getComponentCount(), ComponentTrait<T>(*mSetup, T(),
+      0, nullptr));
+    mIsSet.resize(mSetup->getComponentCount(), false);
+  }
+
+  // Set the entry, if it is no duplicate.
+  Misc::Asserts::require(!mIsSet[index], "can not override component trait "
+    "for component");
+  mTraits[index] = action;
+  mIsSet[index] = true;
+  mCount++;
 
   // Check whether or not the trait mapping is still partial.
-  if (mMapping.size() == mSetup->getComponentCount()) {
-    // Every component has a value as only components can be in mMapping.
+  if (mCount == mSetup->getComponentCount()) {
+    // Every component has a value as only components can be set.
     mPartial = false;
   }
 }
 
+// _____________________________________________________________________________
+template<class T>
+bool TraitMapping<T>::hasTraitFor(const Component* comp) const {
+  std::size_t index = mSetup->getComponentIndex(comp);
+  return index < mIsSet.size() && mIsSet[index];
+}
+
+// _____________________________________________________________________________
+template<class T>
+const ComponentTrait<T>& TraitMapping<T>::getTraitAt(std::size_t index) const {
+  Misc::Asserts::require(!mPartial,
+    "attempting to get trait for partial trait mapping");
+  return mTraits.at(index);
+}
+
+// _____________________________________________________________________________
+template<class T>
+void TraitMapping<T>::replaceTraitFor(const Component* comp,
+    const ComponentTrait<T>& trait) {
+  Misc::Asserts::require(hasTraitFor(comp), "can not replace missing "
+    "component trait for component");
+  mTraits[mSetup->getComponentIndex(comp)] = trait;
+}
+
+// _____________________________________________________________________________
+template<class T>
+void TraitMapping<T>::forEachTrait(
+    std::function<void(const Component*, const ComponentTrait<T>&)> cb)
+    const {
+  Misc::Asserts::require(!mPartial,
+    "attempting to iterate partial trait mapping");
+  std::size_t index = 0;
+  mSetup->forEachComponent([this, &cb, &index](const Component* comp) {
+    cb(comp, mTraits[index++]);
+  });
+}
+
+// _____________________________________________________________________________
+template<class T>
+bool TraitMapping<T>::operator==(const TraitMapping<T>& other) const {
+  return mCount == other.mCount && mIsSet == other.mIsSet
+    && mTraits == other.mTraits;
+}
+
+// _____________________________________________________________________________
+template<class T>
+void TraitMapping<T>::hashState(StateHasher* hasher) const {
+  hasher->addValue(mCount);
+  for (const ComponentTrait<T>& trait : mTraits) {
+    hasher->addValue(trait.getType());
+    hasher->addValue(trait.getTic());
+    hasher->addPointer(trait.getMessage());
+  }
+}
+
 // _____________________________________________________________________________
 template<class T>
 std::string TraitMapping<T>::toString() const {
+  std::string buffer;
+  appendText(&buffer);
+  return buffer;
+}
+
+// _____________________________________________________________________________
+template<class T>
+void TraitMapping<T>::appendText(std::string* buffer) const {
   Misc::Asserts::require(!mPartial,
     "attempting to get string for partial trait mapping");
-  std::string result("(");
+  buffer->push_back('(');
 
-  std::size_t nCompsDone = 0;
-  mSetup->forEachComponent([this, &result, &nCompsDone](const Component* comp) {
-    result += mMapping.at(comp).toString();
+  for (std::size_t i = 0; i < mCount; i++) {
+    mTraits[i].appendText(buffer, mSetup);
 
-    if (++nCompsDone != mMapping.size()) {
+    if (i + 1 != mCount) {
       // There are more to come.
-      result += ", ";
+      buffer->append(", ");
     }
-  });
+  }
 
-  result += ")";
-  return result;
+  buffer->push_back(')');
 }
 
 // _____________________________________________________________________________
 template<class T>
 std::vector<std::string> TraitMapping<T>::toXML() const {
+  std::string buffer;
+  appendXML(&buffer, 0);
+  return Misc::Strings::splitLines(buffer);
+}
+
+// _____________________________________________________________________________
+template<class T>
+void TraitMapping<T>::appendXML(std::string* buffer, std::size_t indent)
+    const {
   Misc::Asserts::require(!mPartial,
     "attempting to get XML for partial trait mapping");
-  std::vector<std::string> res;
-
-  mSetup->forEachComponent([this, &res](const Component* comp) {
-    res.push_back("<entry>");
-    std::stringstream sstr;
 
-    sstr << "  <for>" << comp->getId() << "</for>";
-    res.push_back(sstr.str());
-    sstr.str("");
+  for (std::size_t i = 0; i < mCount; i++) {
+    Misc::Strings::appendIndent(buffer, indent);
+    buffer->append("<entry>\n");
 
-    std::vector<std::string> xmlRepr = mMapping.at(comp).toXML();
-    for (const std::string& rpr : xmlRepr) {
-      sstr << "  " << rpr;
-      res.push_back(sstr.str());
-      sstr.str("");
-    }
+    Misc::Strings::appendIndent(buffer, indent + 2);
+    buffer->append("<for>");
+    buffer->append(mSetup->getComponentIdAt(i));
+    buffer->append("</for>\n");
 
-    res.push_back("</entry>");
-  });
+    mTraits[i].appendXML(buffer, indent + 2, mSetup);
 
-  return res;
+    Misc::Strings::appendIndent(buffer, indent);
+    buffer->append("</entry>\n");
+  }
 }
 
 // _____________________________________________________________________________
 ANL::ANL(const NetworkSetup* setup, ANLSemantics semantics) : mSetup(setup),
-    mSemantics(semantics) {}
+    mSemantics(semantics), mProtocolLog(nullptr), mScratchArena(nullptr) {}
+
+// _____________________________________________________________________________
+ANL::~ANL() {}
+
+// _____________________________________________________________________________
+void ANL::useIncrementalTransitions(bool incremental) {
+  if (!incremental) {
+    mIncremental.reset();
+    return;
+  }
+  Misc::Asserts::require(mSemantics == ANLSemantics::NAIVE, "incremental "
+    "transitions require deterministic semantics");
+  mIncremental.reset(new IncrementalANLComputer(mSetup, ANLFilterNaive));
+}
 
 // _____________________________________________________________________________
 std::vector<NetworkState> ANL::transition(const NetworkTopology* topo,
     const IntentionAssignment* intent) const {
   // Everything is contained in anl_algorithm.h -- nothing here in order to
   //  seperate algorithm interface and algorithm implementation.
+  if (mIncremental) {
+    return std::vector<NetworkState>(1,
+      mIncremental->transition(topo, intent, mScratchArena));
+  }
+
   FilterFunction filter;
   if (mSemantics == ANLSemantics::CANONICAL) {
     filter = ANLFilterNothing;
@@ -294,7 +482,7 @@ std::vector<NetworkState> ANL::transition(const NetworkTopology* topo,
     Misc::Asserts::require(false, "unknown semantics");
   }
 
-  ANLComputer anlComputer(mSetup, topo, intent, filter);
+  ANLComputer anlComputer(mSetup, topo, intent, filter, mScratchArena);
   return anlComputer.transition();
 }
 
@@ -307,14 +495,14 @@ void ANL::runSlot(std::size_t slot, const NetworkState* prevState,
       if (prevState != nullptr) {
         // Create the view with the previous action.
         ANLView view(mSetup, slot, comp, prevState->getTraitFor(comp),
-          targetIntent);
+          targetIntent, mProtocolLog);
         comp->onAct(&view);
 
         Misc::Asserts::require(view.hasActed(), "component did not choose "
           "component intent for slot");
       } else {
         // Create the view without a previous action.
-        ANLView view(mSetup, slot, comp, targetIntent);
+        ANLView view(mSetup, slot, comp, targetIntent, mProtocolLog);
         comp->onAct(&view);
 
         Misc::Asserts::require(view.hasActed(), "component did not choose "
@@ -326,20 +514,22 @@ void ANL::runSlot(std::size_t slot, const NetworkState* prevState,
 // _____________________________________________________________________________
 ANLView::ANLView(const NetworkSetup* setup, std::size_t slot,
     const Component* comp, const ComponentAction& prev,
-    IntentionAssignment* targetIntent) : mSetup(setup), mSlot(slot),
-      mComponent(comp), mPreviousAction(prev), mHasPreviousAction(true),
-      mTargetIntent(targetIntent), mActed(false) {
-  Misc::Asserts::require(mSetup->isComponent(*mComponent), "component unknown "
+    IntentionAssignment* targetIntent, ProtocolLog* log) : mSetup(setup),
+      mSlot(slot), mComponent(comp), mPreviousAction(prev),
+      mHasPreviousAction(true), mTargetIntent(targetIntent), mActed(false),
+      mProtocolLog(log) {
+  ANL_PARANOID_REQUIRE(mSetup->isComponent(*mComponent), "component unknown "
     "to setup!");
 }
 
 // _____________________________________________________________________________
 ANLView::ANLView(const NetworkSetup* setup, std::size_t slot,
-    const Component* comp, IntentionAssignment* targetIntent) : mSetup(setup),
-      mSlot(slot), mComponent(comp),
+    const Component* comp, IntentionAssignment* targetIntent, ProtocolLog* log)
+      : mSetup(setup), mSlot(slot), mComponent(comp),
       mPreviousAction(*setup, ActionType::IDLE, 0, nullptr),
-      mHasPreviousAction(false), mTargetIntent(targetIntent), mActed(false) {
-  Misc::Asserts::require(mSetup->isComponent(*mComponent), "component unknown "
+      mHasPreviousAction(false), mTargetIntent(targetIntent), mActed(false),
+      mProtocolLog(log) {
+  ANL_PARANOID_REQUIRE(mSetup->isComponent(*mComponent), "component unknown "
     "to setup!");
 }
 
@@ -354,6 +544,8 @@ void ANLView::idle() {
 // _____________________________________________________________________________
 void ANLView::send(const Message* msg, std::size_t tic, bool carrierSensing) {
   Misc::Asserts::require(!mActed, "already acted in slot");
+  ANL_REQUIRE(msg != nullptr, "can not send nullptr as message");
+  ANL_REQUIRE(mSetup->getTicsPerSlot() > tic, "invalid tic number: too big");
   IntentionType type =
     carrierSensing ? IntentionType::SEND : IntentionType::SEND_FORCE;
   mTargetIntent->setTraitFor(mComponent, ComponentIntention(*mSetup, type, tic,
@@ -377,7 +569,11 @@ ComponentAction ANLView::getPreviousAction() const {
 
 // _____________________________________________________________________________
 void ANLView::logProtocol(const std::string& msg) const {
-  std::fprintf(stderr, "[ PROT ] Log: %s\n", msg.c_str());
+  if (mProtocolLog != nullptr) {
+    mProtocolLog->add(mSlot, mComponent, msg);
+  } else {
+    ANL_LOG(PROTOCOL, "Log: %s", msg.c_str());
+  }
 }
 
 // _____________________________________________________________________________
@@ -30,6 +30,9 @@
 #include "anl/core/anl_algorithm.h"
 #include <algorithm>
 #include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
 #include "anl/misc/asserts.h"
 
 using std::placeholders::_1;
@@ -41,20 +44,24 @@ namespace Core {
 
 // _____________________________________________________________________________
 SenderSetComputer::SenderSetComputer(const NetworkSetup* setup,
-    const NetworkTopology* topo, const IntentionAssignment* intent)
-      : mSetup(setup), mTopology(topo), mIntent(intent), mResult(setup) {
+    const NetworkTopology* topo, const IntentionAssignment* intent,
+    Misc::Arena* scratch) : mSetup(setup), mTopology(topo), mIntent(intent),
+      mSensed(Misc::ArenaAllocator<bool>(scratch)),
+      mNewlySendingComponents(Misc::ArenaAllocator<const Component*>(scratch)),
+      mResult(setup) {
   Misc::Asserts::require(setup != nullptr, "setup is nullptr");
   Misc::Asserts::require(topo != nullptr, "topology is nullptr");
   Misc::Asserts::require(intent != nullptr, "intent is nullptr");
   Misc::Asserts::require(!intent->isPartial(), "intent is partial and thus "
     "not usable");
+  mSensed.assign(setup->getComponentCount(), false);
 }
 
 // _____________________________________________________________________________
 SenderSetRepresentation SenderSetComputer::getSenderSet() {
   for (size_t tic = 0; tic < mSetup->getTicsPerSlot(); tic++) {
     initializeIteration();
-    Misc::Asserts::require(mNewlySendingComponents.size() == 0, "iteration not "
+    ANL_DEBUG_REQUIRE(mNewlySendingComponents.size() == 0, "iteration not "
       "initialized!");
     computeTicSet(tic);
     completeIteration();
@@ -71,13 +78,13 @@ void SenderSetComputer::initializeIteration() {
 
 // _____________________________________________________________________________
 void SenderSetComputer::computeTicSet(std::size_t tic) {
-  Misc::Asserts::require(tic < mSetup->getTicsPerSlot(), "invalid tic");
+  ANL_DEBUG_REQUIRE(tic < mSetup->getTicsPerSlot(), "invalid tic");
   mIterationTic = tic;
   std::function<void(const Component*)> cb =
     std::bind(&Core::SenderSetComputer::updateTicSetForComponent, this,
       _1);
   mSetup->forEachComponent(cb);
-  Misc::Asserts::require(mIterationTic == tic, "iteration tic has changed");
+  ANL_DEBUG_REQUIRE(mIterationTic == tic, "iteration tic has changed");
 }
 
 // _____________________________________________________________________________
@@ -90,7 +97,7 @@ void SenderSetComputer::updateTicSetForComponent(const Component* comp) {
     // The component can not be part of the sender set.
     return;
   }
-  Misc::Asserts::require(intent.getMessage() != nullptr, "invalid message: "
+  ANL_DEBUG_REQUIRE(intent.getMessage() != nullptr, "invalid message: "
     "no message");
 
   // Second, we check that the current tic is matching, i.e. the component
@@ -107,7 +114,7 @@ void SenderSetComputer::updateTicSetForComponent(const Component* comp) {
   // First case: The component intends to send without carrier sensing
   //  (SEND_FORCE). In this case, we just add it to the sender set.
   if (intent.getType() == IntentionType::SEND_FORCE) {
-    mNewlySendingComponents.insert(comp);
+    mNewlySendingComponents.push_back(comp);
     mResult.setTraitFor(comp, ComponentAction(*mSetup, ActionType::SENT,
       mIterationTic, intent.getMessage()));
     return;
@@ -119,26 +126,27 @@ void SenderSetComputer::updateTicSetForComponent(const Component* comp) {
   //  already sending components can reach this component. If so, carrier
   //  sensing detects an occupied medium and the component does not send.
   //  Otherwise the medium is detected as free and the component does send.
-  for (const Component* alreadySending : mSendingComponents) {
-    if (mTopology->canReach(alreadySending, comp)) {
-      // Component "alreadySending" is detected by carrier sensing.
-      //  Thus, "comp" does not send.
-      return;
-    }
+  if (mSensed[mSetup->getComponentIndex(comp)]) {
+    // An already sending component is detected by carrier sensing. Thus,
+    //  "comp" does not send.
+    return;
   }
 
   // No component has been detected by carrier sensing. Thus "comp" does send.
-  mNewlySendingComponents.insert(comp);
+  mNewlySendingComponents.push_back(comp);
   mResult.setTraitFor(comp, ComponentAction(*mSetup, ActionType::SENT,
     mIterationTic, intent.getMessage()));
 }
 
 // _____________________________________________________________________________
 void SenderSetComputer::completeIteration() {
-  // We add all the newly sending components *now* to the set of sending
-  //  components in order to not influence the now-finished iteration.
-  for (const Component* newlySending : mNewlySendingComponents) {
-    mSendingComponents.insert(newlySending);
+  // We mark the components reached by the newly sending components *now* in
+  //  order to not influence the now-finished iteration.
+  for (const Component* sender : mNewlySendingComponents) {
+    mTopology->forEachReachable(*mSetup, sender,
+      [this](const Component* rcvr) {
+        mSensed[mSetup->getComponentIndex(rcvr)] = true;
+    });
   }
 }
 
@@ -147,7 +155,7 @@ void SenderSetComputer::finishAlgorithm() {
   // We still need to assign a sentinel value ("IDLE" type) to each uncovered
   //  component.
   mSetup->forEachComponent([this](const Component* comp) {
-    if (mSendingComponents.count(comp) > 0) {
+    if (mResult.hasTraitFor(comp)) {
       // This component is sending and thus already has something assigned to
       //  it.
       return;
@@ -162,8 +170,9 @@ void SenderSetComputer::finishAlgorithm() {
 
 // _____________________________________________________________________________
 ANLComputer::ANLComputer(const NetworkSetup* setup, const NetworkTopology* topo,
-    const IntentionAssignment* intent, FilterFunction filter) : mSetup(setup),
-      mTopology(topo), mIntent(intent), mFilter(filter), mSenderSet(setup) {}
+    const IntentionAssignment* intent, FilterFunction filter,
+    Misc::Arena* scratch) : mSetup(setup), mTopology(topo), mIntent(intent),
+      mFilter(filter), mScratch(scratch), mSenderSet(setup) {}
 
 // _____________________________________________________________________________
 std::vector<NetworkState> ANLComputer::transition() {
@@ -180,9 +189,24 @@ std::vector<NetworkState> ANLComputer::transition() {
   //  scenarios with |C| > 7. The exact merging algorithm is described below.
 
   // Phase 1. We determine the sender set.
-  SenderSetComputer SenderSetComputer(mSetup, mTopology, mIntent);
+  SenderSetComputer SenderSetComputer(mSetup, mTopology, mIntent, mScratch);
   mSenderSet = SenderSetComputer.getSenderSet();
 
+  // We collect the sending neighbors of every component by enumerating the
+  //  components each sender can reach. As the senders are visited in
+  //  registration order, so are the neighbors of every component.
+  mSendingNeighbors.assign(mSetup->getComponentCount(),
+    std::vector<const Component*>());
+  mSetup->forEachComponent([this](const Component* sender) {
+    if (mSenderSet.getTraitFor(sender).getType() != ActionType::SENT) {
+      return;
+    }
+    mTopology->forEachReachable(*mSetup, sender,
+      [this, sender](const Component* rcvr) {
+        mSendingNeighbors[mSetup->getComponentIndex(rcvr)].push_back(sender);
+    });
+  });
+
   // Phase 2. We determine possible actions and build up a set of partial
   //  network states. For merging, we use the filter to determine all
   //  component actions that we will consider for a given component. We then
@@ -208,7 +232,7 @@ std::vector<NetworkState> ANLComputer::transition() {
       //  that we intend can be implemented using only this information (i.e.
       //  trivial, counting senders).
       mFilter(*mSetup, &possibleActions);
-      Misc::Asserts::require(possibleActions.size() > 0, "filter removed all "
+      ANL_DEBUG_REQUIRE(possibleActions.size() > 0, "filter removed all "
         "possibilities");
 
       // Sub-step 3. We clone the results for each of the component actions.
@@ -271,24 +295,19 @@ std::vector<ComponentAction> ANLComputer::getPossibleActions(
     //  empty. In this case, every transmission of the sending neighbors has a
     //  possibility to be received.
     bool hasMessages = false;
-    mSetup->forEachComponent(
-      [this, &actions, &comp, &hasMessages](const Component* potential) {
-        if (mTopology->canReach(potential, comp)) {
-          const ComponentAction& potentialQuery =
-            mSenderSet.getTraitFor(potential);
-          if (potentialQuery.getType() == ActionType::SENT) {
-            // Sending neighbor. Add message to the possibilities.
-            actions.emplace_back(*mSetup, ActionType::RECEIVED,
-              potentialQuery.getTic(), potentialQuery.getMessage());
-
-            // If not yet happened, add a collision to the possibilities.
-            if (!hasMessages) {
-              hasMessages = true;
-              actions.emplace_back(*mSetup, ActionType::COLLISION, 0, nullptr);
-            }
-          }
-        }
-    });
+    for (const Component* sender
+        : mSendingNeighbors[mSetup->getComponentIndex(comp)]) {
+      // Sending neighbor. Add message to the possibilities.
+      const ComponentAction& senderQuery = mSenderSet.getTraitFor(sender);
+      actions.emplace_back(*mSetup, ActionType::RECEIVED, senderQuery.getTic(),
+        senderQuery.getMessage());
+
+      // If not yet happened, add a collision to the possibilities.
+      if (!hasMessages) {
+        hasMessages = true;
+        actions.emplace_back(*mSetup, ActionType::COLLISION, 0, nullptr);
+      }
+    }
 
     // Add silence if no message was possible.
     if (!hasMessages) {
@@ -303,6 +322,237 @@ std::vector<ComponentAction> ANLComputer::getPossibleActions(
   return actions;
 }
 
+// _____________________________________________________________________________
+// Checks whether or not the component intention is an intention to send.
+static bool isSendIntention(const ComponentIntention& intent) {
+  return intent.getType() == IntentionType::SEND
+    || intent.getType() == IntentionType::SEND_FORCE;
+}
+
+// _____________________________________________________________________________
+IncrementalANLComputer::IncrementalANLComputer(const NetworkSetup* setup,
+    FilterFunction filter) : mSetup(setup), mFilter(filter),
+      mTopology(nullptr), mTopologyGeneration(0), mIntent(setup),
+      mState(setup), mRecomputed(0) {
+  Misc::Asserts::require(setup != nullptr, "setup is nullptr");
+}
+
+// _____________________________________________________________________________
+NetworkState IncrementalANLComputer::transition(const NetworkTopology* topo,
+    const IntentionAssignment* intent, Misc::Arena* scratch) {
+  Misc::Asserts::require(topo != nullptr, "topology is nullptr");
+  Misc::Asserts::require(intent != nullptr, "intent is nullptr");
+  Misc::Asserts::require(!intent->isPartial(), "intent is partial and thus "
+    "not usable");
+
+  // There is nothing to patch before the first transition, and a new or
+  //  changed topology changes the reachability of every component.
+  if (topo != mTopology || topo->getGeneration() != mTopologyGeneration
+      || mAffected.size() != mSetup->getComponentCount()) {
+    transitionFully(topo, intent, scratch);
+    return mState;
+  }
+
+  // Step 1. We diff the intention assignment against the previous one. The
+  //  components with a changed intention that intend to send count the
+  //  senders they hear again, and they are decided again if they intend to
+  //  send or were in the sender set, from the earlier of both tics on.
+  IndexList changed((Misc::ArenaAllocator<std::size_t>(scratch)));
+  DecisionQueue queue((std::greater<DecisionKey>()),
+    DecisionList(Misc::ArenaAllocator<DecisionKey>(scratch)));
+  for (size_t i = 0; i < mAffected.size(); i++) {
+    const ComponentIntention& next = intent->getTraitAt(i);
+    const ComponentIntention& prev = mIntent.getTraitAt(i);
+    if (next == prev) {
+      continue;
+    }
+    changed.push_back(i);
+    mIntent.replaceTraitFor(mSetup->getComponentAt(i), next);
+
+    std::size_t tic = std::numeric_limits<std::size_t>::max();
+    if (isSendIntention(next)) {
+      mHeard[i] = countHeard(i);
+      tic = next.getTic();
+    }
+    if (mSenders[i].sends) {
+      tic = std::min(tic, mSenders[i].tic);
+    }
+    if (tic != std::numeric_limits<std::size_t>::max()) {
+      queue.push(DecisionKey(tic, i));
+    }
+  }
+  if (changed.empty()) {
+    mRecomputed = 0;
+    return mState;
+  }
+
+  // Step 2. Every component with a changed intention is affected. If the
+  //  sender set changes, the senders with changed entries are affected, and so
+  //  are the components they can reach, as their reception changes.
+  IndexList affected((Misc::ArenaAllocator<std::size_t>(scratch)));
+  std::function<void(std::size_t)> mark = [this, &affected](std::size_t i) {
+    if (!mAffected[i]) {
+      mAffected[i] = true;
+      affected.push_back(i);
+    }
+  };
+  for (std::size_t index : changed) {
+    mark(index);
+  }
+  decideSenders(&queue, mark);
+
+  // Step 3. We patch the previous network state for the affected components.
+  for (std::size_t index : affected) {
+    mState.replaceTraitFor(mSetup->getComponentAt(index),
+      computeAction(index));
+    mAffected[index] = false;
+  }
+  mRecomputed = affected.size();
+  return mState;
+}
+
+// _____________________________________________________________________________
+void IncrementalANLComputer::transitionFully(const NetworkTopology* topo,
+    const IntentionAssignment* intent, Misc::Arena* scratch) {
+  std::size_t count = mSetup->getComponentCount();
+  mTopology = topo;
+  mTopologyGeneration = topo->getGeneration();
+  mIntent = *intent;
+
+  // Decide carrier sensing for all intended senders, starting from an empty
+  //  sender set.
+  mSenders.assign(count, Sender{false, 0, nullptr});
+  mHeard.assign(count, 0);
+  mReachingSenders.assign(count, std::vector<std::size_t>());
+  DecisionQueue queue((std::greater<DecisionKey>()),
+    DecisionList(Misc::ArenaAllocator<DecisionKey>(scratch)));
+  for (std::size_t i = 0; i < count; i++) {
+    const ComponentIntention& next = mIntent.getTraitAt(i);
+    if (isSendIntention(next)) {
+      queue.push(DecisionKey(next.getTic(), i));
+    }
+  }
+  decideSenders(&queue, [](std::size_t) {});
+
+  mState = NetworkState(mSetup);
+  for (std::size_t i = 0; i < count; i++) {
+    mState.setTraitFor(mSetup->getComponentAt(i), computeAction(i));
+  }
+  mAffected.assign(count, false);
+  mRecomputed = count;
+}
+
+// _____________________________________________________________________________
+std::size_t IncrementalANLComputer::countHeard(std::size_t index) const {
+  std::size_t tic = mIntent.getTraitAt(index).getTic();
+  std::size_t heard = 0;
+  for (std::size_t senderIndex : mReachingSenders[index]) {
+    if (mSenders[senderIndex].tic < tic) {
+      heard++;
+    }
+  }
+  return heard;
+}
+
+// _____________________________________________________________________________
+void IncrementalANLComputer::decideSenders(DecisionQueue* queue,
+    const std::function<void(std::size_t)>& mark) {
+  // A component can only be heard by components starting to send in a later
+  //  tic, thus deciding in the order of tics decides every component at most
+  //  once, unless it was queued for the earlier tic of its previous entry.
+  while (!queue->empty()) {
+    std::size_t index = queue->top().second;
+    queue->pop();
+
+    const ComponentIntention& intent = mIntent.getTraitAt(index);
+    Sender next{false, 0, nullptr};
+    if (intent.getType() == IntentionType::SEND_FORCE
+        || (intent.getType() == IntentionType::SEND && mHeard[index] == 0)) {
+      next = Sender{true, intent.getTic(), intent.getMessage()};
+    }
+    Sender prev = mSenders[index];
+    if (prev.sends == next.sends && (!next.sends
+        || (prev.tic == next.tic && prev.message == next.message))) {
+      continue;
+    }
+    mSenders[index] = next;
+    mark(index);
+
+    // The receptions of the components the sender can reach change, and so do
+    //  the counts of the intended senders of later tics among them.
+    mTopology->forEachReachable(*mSetup, mSetup->getComponentAt(index),
+      [this, index, &prev, &next, queue, &mark](const Component* rcvr) {
+        std::size_t r = mSetup->getComponentIndex(rcvr);
+        mark(r);
+        if (prev.sends != next.sends) {
+          std::vector<std::size_t>& reaching = mReachingSenders[r];
+          auto pos = std::lower_bound(reaching.begin(), reaching.end(), index);
+          if (prev.sends) {
+            reaching.erase(pos);
+          } else {
+            reaching.insert(pos, index);
+          }
+        }
+
+        const ComponentIntention& rIntent = mIntent.getTraitAt(r);
+        if (!isSendIntention(rIntent)) {
+          return;
+        }
+        bool heardBefore = prev.sends && prev.tic < rIntent.getTic();
+        bool heardAfter = next.sends && next.tic < rIntent.getTic();
+        if (heardBefore == heardAfter) {
+          return;
+        }
+        if (heardAfter) {
+          mHeard[r]++;
+        } else {
+          mHeard[r]--;
+        }
+        if (rIntent.getType() == IntentionType::SEND
+            && mHeard[r] == (heardAfter ? 1 : 0)) {
+          queue->push(DecisionKey(rIntent.getTic(), r));
+        }
+    });
+  }
+}
+
+// _____________________________________________________________________________
+ComponentAction IncrementalANLComputer::computeAction(std::size_t index) const {
+  const ComponentIntention& intent = mIntent.getTraitAt(index);
+
+  // IDLE, see ANLComputer::getPossibleActions.
+  if (intent.getType() == IntentionType::IDLE) {
+    return ComponentAction(*mSetup, ActionType::IDLE, 0, nullptr);
+  }
+
+  // SENT and CANCELLED.
+  if (isSendIntention(intent)) {
+    return ComponentAction(*mSetup,
+      mSenders[index].sends ? ActionType::SENT : ActionType::CANCELLED,
+      intent.getTic(), intent.getMessage());
+  }
+
+  // COLLISION, SILENCE, and RECEIVED. Only the senders that can reach the
+  //  component contribute, in the same order as by the ANLComputer.
+  std::vector<ComponentAction> actions;
+  for (std::size_t senderIndex : mReachingSenders[index]) {
+    const Sender& sender = mSenders[senderIndex];
+    actions.emplace_back(*mSetup, ActionType::RECEIVED, sender.tic,
+      sender.message);
+    if (actions.size() == 1) {
+      actions.emplace_back(*mSetup, ActionType::COLLISION, 0, nullptr);
+    }
+  }
+  if (actions.empty()) {
+    actions.emplace_back(*mSetup, ActionType::SILENCE, 0, nullptr);
+  }
+
+  mFilter(*mSetup, &actions);
+  ANL_REQUIRE(actions.size() == 1, "incremental transitions require a "
+    "deterministic filter");
+  return actions.front();
+}
+
 // _____________________________________________________________________________
 void ANLFilterNothing(const NetworkSetup& setup,
     std::vector<ComponentAction>* inout) {
@@ -361,7 +611,7 @@ void ANLFilterNaive(const NetworkSetup& setup,
   // Case 2. Exactly one sending neighbor.
   // We have no receiving duplicates, at this point those should already be
   //  converted to collisions by the statements above.
-  Misc::Asserts::require(sendingNeighbors == 1, "this should be 1, as above "
+  ANL_DEBUG_REQUIRE(sendingNeighbors == 1, "this should be 1, as above "
     "conditions are exhaustive");
 
   // As there is only one RECEIVED, we just remove every other type.
@@ -369,7 +619,7 @@ void ANLFilterNaive(const NetworkSetup& setup,
     [](const ComponentAction& action) {
       return action.getType() != ActionType::RECEIVED;
     }), inout->end());
-  Misc::Asserts::require(inout->size() == 1, "more than one result left after "
+  ANL_DEBUG_REQUIRE(inout->size() == 1, "more than one result left after "
     "removing for single sender");
 }
 
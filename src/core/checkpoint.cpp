@@ -0,0 +1,212 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+
+#include "anl/core/checkpoint.h"
+#include <string>
+#include <utility>
+#include "anl/core/message_pool.h"
+#include "anl/misc/strings.h"
+
+// This file contains the checkpoints of simulations from the CORE module.
+namespace Core {
+
+
+// _____________________________________________________________________________
+const char Checkpoint::kMagic[8] = { 'A', 'N', 'L', 'C', 'H', 'K', '0', '1' };
+const std::uint64_t Checkpoint::kNoMessage;
+const std::uint64_t Checkpoint::kRegisteredMessage;
+const std::uint64_t Checkpoint::kFamilyMessage;
+
+// _____________________________________________________________________________
+CheckpointWriter::CheckpointWriter(const NetworkSetup* setup) : mSetup(setup) {
+  for (std::size_t i = 0; i < setup->getRegisteredMessageCount(); i++) {
+    mMessageIndices.emplace(setup->getRegisteredMessageAt(i), i);
+  }
+}
+
+// _____________________________________________________________________________
+void CheckpointWriter::writeMagic() {
+  mData.append(Checkpoint::kMagic, sizeof(Checkpoint::kMagic));
+}
+
+// _____________________________________________________________________________
+void CheckpointWriter::writeNumber(std::uint64_t value) {
+  Misc::Strings::appendVarint(&mData, value);
+}
+
+// _____________________________________________________________________________
+void CheckpointWriter::writeString(const std::string& str) {
+  writeNumber(str.size());
+  mData.append(str);
+}
+
+// _____________________________________________________________________________
+void CheckpointWriter::writeComponent(const Component* comp) {
+  writeNumber(comp == nullptr ? 0 : mSetup->getComponentIndex(comp) + 1);
+}
+
+// _____________________________________________________________________________
+bool CheckpointWriter::writeMessage(const Message* msg) {
+  if (msg == nullptr) {
+    writeNumber(Checkpoint::kNoMessage);
+    return true;
+  }
+  auto entry = mMessageIndices.find(msg);
+  if (entry != mMessageIndices.end()) {
+    writeNumber(Checkpoint::kRegisteredMessage);
+    writeNumber(entry->second);
+    return true;
+  }
+
+  // Families that share an arena may all claim the message, thus the next
+  //  family is tried if one can not find its key.
+  std::size_t start = mData.size();
+  for (std::size_t i = 0; i < mSetup->getMessageFamilyCount(); i++) {
+    const MessageFamily* family = mSetup->getMessageFamilyAt(i);
+    if (family->contains(msg)) {
+      writeNumber(Checkpoint::kFamilyMessage);
+      writeNumber(i);
+      if (family->saveMessage(msg, this)) {
+        return true;
+      }
+      mData.resize(start);
+    }
+  }
+  return false;
+}
+
+// _____________________________________________________________________________
+bool CheckpointWriter::writeState(const NetworkState& state) {
+  bool success = true;
+  state.forEachTrait([this, &success](const Component* comp,
+      const ComponentAction& action) {
+    writeNumber(static_cast<std::uint64_t>(action.getType()));
+    writeNumber(action.getTic());
+    success = success && writeMessage(action.getMessage());
+  });
+  return success;
+}
+
+// _____________________________________________________________________________
+CheckpointReader::CheckpointReader(const NetworkSetup* setup,
+    std::string&& data) : mSetup(setup), mData(std::move(data)), mPos(0) {}
+
+// _____________________________________________________________________________
+bool CheckpointReader::readMagic() {
+  if (mData.compare(mPos, sizeof(Checkpoint::kMagic), Checkpoint::kMagic,
+      sizeof(Checkpoint::kMagic)) != 0) {
+    return false;
+  }
+  mPos += sizeof(Checkpoint::kMagic);
+  return true;
+}
+
+// _____________________________________________________________________________
+bool CheckpointReader::readNumber(std::uint64_t* value) {
+  *value = 0;
+  for (unsigned int shift = 0; shift < 64; shift += 7) {
+    if (mPos >= mData.size()) {
+      return false;
+    }
+    unsigned char byte = static_cast<unsigned char>(mData[mPos++]);
+    *value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// _____________________________________________________________________________
+bool CheckpointReader::readString(std::string* str) {
+  std::uint64_t length = 0;
+  if (!readNumber(&length) || length > mData.size() - mPos) {
+    return false;
+  }
+  str->assign(mData, mPos, length);
+  mPos += length;
+  return true;
+}
+
+// _____________________________________________________________________________
+bool CheckpointReader::readComponent(const Component** comp) {
+  std::uint64_t index = 0;
+  if (!readNumber(&index) || index > mSetup->getComponentCount()) {
+    return false;
+  }
+  *comp = index == 0 ? nullptr : mSetup->getComponentAt(index - 1);
+  return true;
+}
+
+// _____________________________________________________________________________
+bool CheckpointReader::readMessage(const Message** msg) {
+  std::uint64_t tag = 0;
+  std::uint64_t index = 0;
+  if (!readNumber(&tag)) {
+    return false;
+  }
+  switch (tag) {
+    case Checkpoint::kNoMessage:
+      *msg = nullptr;
+      return true;
+    case Checkpoint::kRegisteredMessage:
+      if (!readNumber(&index) || index >= mSetup->getRegisteredMessageCount()) {
+        return false;
+      }
+      *msg = mSetup->getRegisteredMessageAt(index);
+      return true;
+    case Checkpoint::kFamilyMessage:
+      if (!readNumber(&index) || index >= mSetup->getMessageFamilyCount()) {
+        return false;
+      }
+      *msg = mSetup->getMessageFamilyAt(index)->loadMessage(this);
+      return *msg != nullptr;
+    default:
+      return false;
+  }
+}
+
+// _____________________________________________________________________________
+bool CheckpointReader::readState(NetworkState* state) {
+  for (std::size_t i = 0; i < mSetup->getComponentCount(); i++) {
+    std::uint64_t type = 0;
+    std::uint64_t tic = 0;
+    const Message* msg = nullptr;
+    if (!readNumber(&type) || type > static_cast<std::uint64_t>(
+          ActionType::CANCELLED) || !readNumber(&tic)
+        || tic >= mSetup->getTicsPerSlot() || !readMessage(&msg)) {
+      return false;
+    }
+    state->setTraitFor(mSetup->getComponentAt(i), ComponentAction(*mSetup,
+      static_cast<ActionType>(type), tic, msg));
+  }
+  return true;
+}
+
+
+}  // namespace Core
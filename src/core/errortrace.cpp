@@ -31,21 +31,29 @@
 #include <cstdio>
 #include <cstdlib>
 #include "anl/misc/asserts.h"
+#include "anl/misc/log.h"
 
 // This file contains the error tracing helper from the CORE module.
 namespace Core {
 
 
 // _____________________________________________________________________________
-void ErrorTracer::enter(const std::string& name) {
-  Misc::Asserts::require(name.size() > 0, "empty section name");
-  mSections.push_back(name);
+const std::size_t ErrorTracer::kMaxDepth;
+
+// _____________________________________________________________________________
+void ErrorTracer::enter(const char* name) {
+  Misc::Asserts::require(name != nullptr && name[0] != '\0',
+    "empty section name");
+  if (mDepth < kMaxDepth) {
+    mSections[mDepth] = name;
+  }
+  mDepth++;
 }
 
 // _____________________________________________________________________________
 void ErrorTracer::leave() {
-  Misc::Asserts::require(mSections.size() > 0, "empty section stack");
-  mSections.pop_back();
+  Misc::Asserts::require(mDepth > 0, "empty section stack");
+  mDepth--;
 }
 
 // _____________________________________________________________________________
@@ -54,11 +62,16 @@ void ErrorTracer::require(bool expr, const char* message) {
 
   // Print a backtrace and fail, if required.
   if (!expr) {
+    Misc::Log::flush();
     std::fprintf(stderr, "An error occurred: %s\n", message);
-    if (mSections.size() > 0) {
+    if (mDepth > 0) {
       std::fprintf(stderr, "This error occurred from:\n");
-      for (const std::string& str : mSections) {
-        std::fprintf(stderr, "  => %s\n", str.c_str());
+      std::size_t printed = mDepth < kMaxDepth ? mDepth : kMaxDepth;
+      for (std::size_t i = 0; i < printed; i++) {
+        std::fprintf(stderr, "  => %s\n", mSections[i]);
+      }
+      if (mDepth > printed) {
+        std::fprintf(stderr, "  => (%zu more sections)\n", mDepth - printed);
       }
     }
     std::fprintf(stderr, "The program will be terminated.\n");
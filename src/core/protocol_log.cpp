@@ -0,0 +1,87 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include "anl/core/protocol_log.h"
+#include "anl/misc/asserts.h"
+#include "anl/misc/log.h"
+
+// This file contains the protocol log from the CORE module.
+namespace Core {
+
+
+// _____________________________________________________________________________
+const std::size_t ProtocolLog::kDefaultCapacity;
+
+// _____________________________________________________________________________
+ProtocolLog::ProtocolLog(const NetworkSetup* setup, std::size_t capacity)
+    : mSetup(setup), mRecords(capacity), mSize(0), mSink(nullptr),
+      mModule(nullptr) {
+  Misc::Asserts::require(setup != nullptr, "protocol log requires a setup");
+  Misc::Asserts::require(capacity > 0, "protocol log capacity must be greater "
+    "than zero");
+}
+
+// _____________________________________________________________________________
+void ProtocolLog::add(std::size_t slot, const Component* comp,
+    const std::string& message) {
+  if (mModule == nullptr && mSink == nullptr
+      && !Misc::Log::isEnabled(Misc::LogLevel::PROTOCOL)) {
+    return;
+  }
+  if (mSize == mRecords.size()) {
+    flush();
+  }
+
+  // Assigning keeps the capacity of the reused string.
+  ProtocolLogRecord& record = mRecords[mSize++];
+  record.slot = slot;
+  record.component = mSetup->getComponentIndex(comp);
+  record.message.assign(message);
+}
+
+// _____________________________________________________________________________
+void ProtocolLog::flush() {
+  for (std::size_t i = 0; i < mSize; i++) {
+    const ProtocolLogRecord& record = mRecords[i];
+    const std::string& id = mSetup->getComponentIdAt(record.component);
+    if (mModule != nullptr) {
+      mModule->onProtocolLog(id, record.message);
+    } else if (mSink != nullptr) {
+      mSink->print("[%zu] %s: %s\n", record.slot, id.c_str(),
+        record.message.c_str());
+    } else {
+      ANL_LOG(PROTOCOL, "Log: [%zu] %s: %s", record.slot, id.c_str(),
+        record.message.c_str());
+    }
+  }
+  mSize = 0;
+}
+
+
+}  // namespace Core
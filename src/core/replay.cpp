@@ -0,0 +1,356 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include "anl/core/replay.h"
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "anl/misc/asserts.h"
+
+// This file contains the intent log replay from the CORE module.
+namespace Core {
+
+
+// _____________________________________________________________________________
+const char IntentLog::kMagic[8] = { 'A', 'N', 'L', 'I', 'N', 'T', '0', '1' };
+const char IntentLog::kMessageTag;
+const char IntentLog::kSlotTag;
+const char IntentLog::kSkipTag;
+const char IntentLog::kEndTag;
+
+// _____________________________________________________________________________
+// Stand-in for a recorded component.
+class ReplayComponent : public Component {
+ public:
+  ReplayComponent(std::string&& id, std::vector<std::string>&& xml)
+    : mId(std::move(id)), mXML(std::move(xml)) {}
+
+ private:
+  std::string doGetId() const override { return mId; }
+  std::vector<std::string> doToXML() const override { return mXML; }
+
+  std::string mId;
+  std::vector<std::string> mXML;
+};
+
+// _____________________________________________________________________________
+// Stand-in for a recorded message.
+class ReplayMessage : public Message {
+ public:
+  ReplayMessage(std::string&& text, std::vector<std::string>&& xml)
+    : mText(std::move(text)), mXML(std::move(xml)) {}
+
+ private:
+  std::string doToString() const override { return mText; }
+  std::vector<std::string> doToXML() const override { return mXML; }
+
+  std::string mText;
+  std::vector<std::string> mXML;
+};
+
+// _____________________________________________________________________________
+// Reads a variable-length integer at the given position. Returns false if the
+//  data ends prematurely or the integer is too long.
+static bool readVarint(const std::string& data, std::size_t* pos,
+    std::uint64_t* value) {
+  *value = 0;
+  for (unsigned int shift = 0; shift < 64; shift += 7) {
+    if (*pos >= data.size()) {
+      return false;
+    }
+    unsigned char byte = static_cast<unsigned char>(data[(*pos)++]);
+    *value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// _____________________________________________________________________________
+// Reads a length-prefixed string at the given position.
+static bool readString(const std::string& data, std::size_t* pos,
+    std::string* str) {
+  std::uint64_t length = 0;
+  if (!readVarint(data, pos, &length) || length > data.size() - *pos) {
+    return false;
+  }
+  str->assign(data, *pos, length);
+  *pos += length;
+  return true;
+}
+
+// _____________________________________________________________________________
+// Reads a count-prefixed list of strings at the given position.
+static bool readStringList(const std::string& data, std::size_t* pos,
+    std::vector<std::string>* lines) {
+  std::uint64_t count = 0;
+  if (!readVarint(data, pos, &count) || count > data.size() - *pos) {
+    return false;
+  }
+  lines->resize(count);
+  for (std::string& line : *lines) {
+    if (!readString(data, pos, &line)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+IntentLogReplayer::IntentLogReplayer(std::string&& data,
+    std::size_t ticsPerSlot) : mData(std::move(data)), mRecordStart(0),
+      mRecordEnd(0), mIntendedSlots(0), mMaxSkipPeriod(0),
+      mSetup(ticsPerSlot) {}
+
+// _____________________________________________________________________________
+IntentLogReplayer::~IntentLogReplayer() {
+  for (Component* comp : mComponents) {
+    delete comp;
+  }
+  for (Message* msg : mMessages) {
+    delete msg;
+  }
+}
+
+// _____________________________________________________________________________
+IntentLogReplayer* IntentLogReplayer::open(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return nullptr;
+  }
+  std::stringstream sstr;
+  sstr << in.rdbuf();
+  std::string data = sstr.str();
+
+  // Check the magic and read the tics per slot, which the setup needs.
+  std::size_t pos = sizeof(IntentLog::kMagic);
+  std::uint64_t ticsPerSlot = 0;
+  if (data.compare(0, sizeof(IntentLog::kMagic), IntentLog::kMagic,
+        sizeof(IntentLog::kMagic)) != 0
+      || !readVarint(data, &pos, &ticsPerSlot) || ticsPerSlot == 0) {
+    return nullptr;
+  }
+
+  IntentLogReplayer* replayer = new IntentLogReplayer(std::move(data),
+    ticsPerSlot);
+  std::uint64_t intendedSlots = 0;
+  if (!readVarint(replayer->mData, &pos, &intendedSlots)
+      || !replayer->readComponents(&pos) || !replayer->readRecords(pos)) {
+    delete replayer;
+    return nullptr;
+  }
+  replayer->mIntendedSlots = intendedSlots;
+  return replayer;
+}
+
+// _____________________________________________________________________________
+bool IntentLogReplayer::readComponents(std::size_t* pos) {
+  std::uint64_t count = 0;
+  if (!readVarint(mData, pos, &count) || count > mData.size() - *pos) {
+    return false;
+  }
+  for (std::uint64_t i = 0; i < count; i++) {
+    std::string id;
+    std::vector<std::string> xml;
+    if (!readString(mData, pos, &id) || !readStringList(mData, pos, &xml)) {
+      return false;
+    }
+    mComponents.push_back(new ReplayComponent(std::move(id), std::move(xml)));
+    mSetup.registerComponent(mComponents.back());
+  }
+
+  // The topology, as reachable components per component.
+  for (const Component* sndr : mComponents) {
+    std::uint64_t numReachable = 0;
+    if (!readVarint(mData, pos, &numReachable)) {
+      return false;
+    }
+    for (std::uint64_t i = 0; i < numReachable; i++) {
+      std::uint64_t rcvr = 0;
+      if (!readVarint(mData, pos, &rcvr) || rcvr >= count) {
+        return false;
+      }
+      mTopology.addEdge(sndr, mComponents[rcvr]);
+    }
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+bool IntentLogReplayer::readRecords(std::size_t pos) {
+  mRecordStart = pos;
+  mRecordEnd = pos;
+  std::size_t numSlots = 0;
+  while (pos < mData.size()) {
+    char tag = mData[pos++];
+    if (tag == IntentLog::kEndTag) {
+      mRecordEnd = pos - 1;
+      return pos == mData.size();
+    }
+
+    bool complete = false;
+    std::uint64_t value = 0;
+    if (tag == IntentLog::kMessageTag) {
+      std::string text;
+      std::vector<std::string> xml;
+      complete = readVarint(mData, &pos, &value)
+        && readString(mData, &pos, &text) && readStringList(mData, &pos, &xml);
+      if (complete) {
+        // Messages are defined in the order of their indices.
+        if (value != mMessages.size()) {
+          return false;
+        }
+        mMessages.push_back(new ReplayMessage(std::move(text),
+          std::move(xml)));
+        mSetup.registerMessage(mMessages.back());
+      }
+    } else if (tag == IntentLog::kSlotTag) {
+      complete = readVarint(mData, &pos, &value)
+        && readIntentions(&pos, nullptr);
+      numSlots += complete ? 1 : 0;
+    } else if (tag == IntentLog::kSkipTag) {
+      std::uint64_t count = 0;
+      std::uint64_t period = 0;
+      complete = readVarint(mData, &pos, &value)
+        && readVarint(mData, &pos, &count) && readVarint(mData, &pos, &period);
+      if (complete) {
+        // The skipped slots repeat slots that were recorded before.
+        if (period == 0 || period > numSlots) {
+          return false;
+        }
+        mMaxSkipPeriod = std::max<std::size_t>(mMaxSkipPeriod, period);
+      }
+    } else {
+      return false;
+    }
+
+    // A truncated last record stems from an aborted simulation. The complete
+    //  records before it can still be replayed.
+    if (!complete) {
+      return true;
+    }
+    mRecordEnd = pos;
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+bool IntentLogReplayer::readIntentions(std::size_t* pos,
+    IntentionAssignment* intent) const {
+  for (const Component* comp : mComponents) {
+    std::uint64_t type = 0;
+    std::uint64_t tic = 0;
+    std::uint64_t msg = 0;
+    if (!readVarint(mData, pos, &type)
+        || type > static_cast<std::uint64_t>(IntentionType::SEND_FORCE)) {
+      return false;
+    }
+    IntentionType intentType = static_cast<IntentionType>(type);
+    bool sending = intentType == IntentionType::SEND
+      || intentType == IntentionType::SEND_FORCE;
+    if (sending && (!readVarint(mData, pos, &tic) || !readVarint(mData, pos,
+        &msg) || tic >= mSetup.getTicsPerSlot() || msg >= mMessages.size())) {
+      return false;
+    }
+    if (intent != nullptr) {
+      intent->setTraitFor(comp, ComponentIntention(mSetup, intentType, tic,
+        sending ? mMessages[msg] : nullptr));
+    }
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+std::size_t IntentLogReplayer::run(Output::OutputModule* outModule,
+    ANLSemantics semantics) {
+  Misc::Asserts::require(outModule != nullptr, "output module must not be "
+    "nullptr");
+  ANL anl(&mSetup, semantics);
+  outModule->onSimulationBegin(mIntendedSlots, &mSetup, &mTopology);
+
+  // The records were checked by open, thus only slots need to be decoded.
+  //  Skipped slots repeat the most recent network states.
+  std::size_t numSlots = 0;
+  std::deque<NetworkState> recentStates;
+  std::size_t pos = mRecordStart;
+  while (pos < mRecordEnd) {
+    char tag = mData[pos++];
+    std::uint64_t value = 0;
+    if (tag == IntentLog::kMessageTag) {
+      std::string text;
+      std::vector<std::string> xml;
+      readVarint(mData, &pos, &value);
+      readString(mData, &pos, &text);
+      readStringList(mData, &pos, &xml);
+      continue;
+    }
+    if (tag == IntentLog::kSkipTag) {
+      std::uint64_t count = 0;
+      std::uint64_t period = 0;
+      readVarint(mData, &pos, &value);
+      readVarint(mData, &pos, &count);
+      readVarint(mData, &pos, &period);
+      std::vector<NetworkState> cycle(recentStates.end() - period,
+        recentStates.end());
+      outModule->onSlotsSkipped(value, count, cycle);
+      numSlots += count;
+      continue;
+    }
+
+    readVarint(mData, &pos, &value);
+    IntentionAssignment intent(&mSetup);
+    readIntentions(&pos, &intent);
+
+    outModule->onSlotBegin(value);
+    outModule->onIntentChosen(intent);
+    std::vector<NetworkState> outcomes = anl.transition(&mTopology, &intent);
+    outModule->onTransitionComputed(outcomes);
+    outModule->onResultChosen(outcomes.front());
+    outModule->onSlotEnd();
+    numSlots++;
+
+    if (mMaxSkipPeriod > 0) {
+      recentStates.push_back(outcomes.front());
+      if (recentStates.size() > mMaxSkipPeriod) {
+        recentStates.pop_front();
+      }
+    }
+  }
+
+  outModule->onSimulationEnd(numSlots);
+  return numSlots;
+}
+
+
+}  // namespace Core
@@ -29,9 +29,14 @@
 
 #include "anl/core/simulator.h"
 #include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <vector>
+#include "anl/core/checkpoint.h"
 #include "anl/core/entry_point.h"
 #include "anl/misc/asserts.h"
+#include "anl/misc/log.h"
 
 // This file contains the simulator from the CORE module.
 namespace Core {
@@ -40,120 +45,383 @@ namespace Core {
 // _____________________________________________________________________________
 Output::OutputModule* gDefaultOutModule = nullptr;
 
+// _____________________________________________________________________________
+Output::Sink* gDefaultProtocolLogSink = nullptr;
+bool gDefaultMergeProtocolLog = false;
+
+// _____________________________________________________________________________
+QuiescenceMode gDefaultQuiescenceMode = QuiescenceMode::OFF;
+
+// _____________________________________________________________________________
+CycleMode gDefaultCycleMode = CycleMode::OFF;
+
+// _____________________________________________________________________________
+std::string gDefaultCheckpointPath;
+std::size_t gDefaultCheckpointInterval = 1000;
+bool gDefaultResume = false;
+
 // _____________________________________________________________________________
 Simulator::Simulator(std::size_t ticsPerSlot) :
     mOutputModule(gDefaultOutModule), mSetup(ticsPerSlot), mTopology(nullptr),
     mSlotNumber(0), mPreviousState(&mSetup),
-    mANL(&mSetup, ANLSemantics::NAIVE), mHasBegun(false) {}
+    mANL(&mSetup, ANLSemantics::NAIVE), mHasBegun(false),
+    mProtocolLog(&mSetup), mMergeProtocolLog(gDefaultMergeProtocolLog),
+    mQuiescenceMode(gDefaultQuiescenceMode), mQuiescencePeriod(2),
+    mQuiescent(false), mCycleMode(gDefaultCycleMode), mHistorySize(1024),
+    mCyclePeriod(0), mCheckpointPath(gDefaultCheckpointPath),
+    mCheckpointInterval(gDefaultCheckpointInterval),
+    mResumePath(gDefaultResume ? gDefaultCheckpointPath : std::string()) {
+  mProtocolLog.setSink(gDefaultProtocolLogSink);
+  mANL.useProtocolLog(&mProtocolLog);
+  mANL.useScratchArena(&mSlotArena);
+}
 
 // _____________________________________________________________________________
 void Simulator::useTopology(const NetworkTopology* topo) {
-  mErrorTracer.enter("Simulator::useTopology()");
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::useTopology()");
   mErrorTracer.require(topo != nullptr, "Topology must not be 'nullptr'.");
   mTopology = topo;
-  mErrorTracer.leave();
 }
 
 // _____________________________________________________________________________
 void Simulator::useOutputModule(Output::OutputModule* outModule) {
-  mErrorTracer.enter("Simulator::useOutputModule()");
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::useOutputModule()");
   mErrorTracer.require(outModule != nullptr, "Output module must not be "
     "'nullptr'.");
   mOutputModule = outModule;
-  mErrorTracer.leave();
+}
+
+// _____________________________________________________________________________
+void Simulator::useProtocolLogSink(Output::Sink* sink) {
+  mProtocolLog.setSink(sink);
+}
+
+// _____________________________________________________________________________
+void Simulator::mergeProtocolLog(bool merge) {
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::mergeProtocolLog()");
+  mErrorTracer.require(!mHasBegun, "Protocol log merging must be set before "
+    "the simulation.");
+  mMergeProtocolLog = merge;
+}
+
+// _____________________________________________________________________________
+void Simulator::useIncrementalTransitions(bool incremental) {
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::useIncrementalTransitions()");
+  mErrorTracer.require(!mHasBegun, "Incremental transitions must be set before "
+    "the simulation.");
+  mANL.useIncrementalTransitions(incremental);
+}
+
+// _____________________________________________________________________________
+void Simulator::useQuiescence(QuiescenceMode mode, std::size_t period) {
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::useQuiescence()");
+  mErrorTracer.require(!mHasBegun, "Quiescence detection must be set before "
+    "the simulation.");
+  mErrorTracer.require(period != 0, "Quiescence period must be greater than "
+    "zero.");
+  mQuiescenceMode = mode;
+  mQuiescencePeriod = period;
+}
+
+// _____________________________________________________________________________
+void Simulator::useCycleDetection(CycleMode mode, std::size_t historySize) {
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::useCycleDetection()");
+  mErrorTracer.require(!mHasBegun, "Cycle detection must be set before the "
+    "simulation.");
+  mErrorTracer.require(historySize != 0, "Cycle history size must be greater "
+    "than zero.");
+  mCycleMode = mode;
+  mHistorySize = historySize;
+}
+
+// _____________________________________________________________________________
+void Simulator::useSeed(std::uint64_t seed) {
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::useSeed()");
+  mErrorTracer.require(!mHasBegun, "Seed must be set before the simulation.");
+  mRandom.seed(seed);
+}
+
+// _____________________________________________________________________________
+void Simulator::useCheckpoints(const std::string& path,
+    std::size_t interval) {
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::useCheckpoints()");
+  mErrorTracer.require(!mHasBegun, "Checkpoints must be set before the "
+    "simulation.");
+  mErrorTracer.require(!path.empty(), "Checkpoint path must not be empty.");
+  mErrorTracer.require(interval != 0, "Checkpoint interval must be greater "
+    "than zero.");
+  mCheckpointPath = path;
+  mCheckpointInterval = interval;
+}
+
+// _____________________________________________________________________________
+void Simulator::resumeFrom(const std::string& path) {
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::resumeFrom()");
+  mErrorTracer.require(!mHasBegun, "Resuming must be set before the "
+    "simulation.");
+  mResumePath = path;
 }
 
 // _____________________________________________________________________________
 void Simulator::useComponents(Component* const* compStart, std::size_t count) {
-  mErrorTracer.enter("Simulator::useComponents()");
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::useComponents()");
   mErrorTracer.require(compStart != nullptr, "Component pointer array must not "
     "be 'nullptr'.");
   for (std::size_t i = 0; i < count; i++) {
-    mErrorTracer.enter("Stepping through component pointer array");
+    ANL_TRACE_SECTION(&mErrorTracer,
+      "Stepping through component pointer array");
     mErrorTracer.require(compStart[i] != nullptr, "Component pointer must not "
       "be 'nullptr'.");
     mErrorTracer.require(!mSetup.isComponent(*compStart[i]), "Components must "
       "not be registered more than once.");
     mSetup.registerComponent(compStart[i]);
-    mErrorTracer.leave();
   }
-  mErrorTracer.leave();
 }
 
 // _____________________________________________________________________________
 void Simulator::useMessages(const Message* const* msgStart, std::size_t count) {
-  mErrorTracer.enter("Simulator::useMessages()");
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::useMessages()");
   mErrorTracer.require(msgStart != nullptr, "Message pointer array must not "
     "be 'nullptr'.");
   for (std::size_t i = 0; i < count; i++) {
-    mErrorTracer.enter("Stepping through message pointer array");
+    ANL_TRACE_SECTION(&mErrorTracer, "Stepping through message pointer array");
     mErrorTracer.require(msgStart[i] != nullptr, "Message pointer must not be "
       "'nullptr'.");
     mErrorTracer.require(!mSetup.isMessage(msgStart[i]), "Messages must not be "
       "registered more than once.");
     mSetup.registerMessage(msgStart[i]);
-    mErrorTracer.leave();
   }
-  mErrorTracer.leave();
+}
+
+// _____________________________________________________________________________
+void Simulator::useMessageFamily(const MessageFamily* family) {
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::useMessageFamily()");
+  mErrorTracer.require(family != nullptr, "Message family must not be "
+    "'nullptr'.");
+  mSetup.registerMessageFamily(family);
 }
 
 // _____________________________________________________________________________
 void Simulator::run(std::size_t numSlots) {
-  mErrorTracer.enter("Simulator::run()");
-  mErrorTracer.enter("Checking prerequisites");
-  mErrorTracer.require(numSlots != 0, "Simulation duration must be greater "
-    "than zero.");
-  mErrorTracer.leave();
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::run()");
+  runUntil(StopPredicate(), numSlots);
+}
+
+// _____________________________________________________________________________
+std::size_t Simulator::runUntil(StopPredicate predicate,
+    std::size_t maxSlots) {
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::runUntil()");
+  {
+    ANL_TRACE_SECTION(&mErrorTracer, "Checking prerequisites");
+    mErrorTracer.require(maxSlots != 0, "Simulation duration must be greater "
+      "than zero.");
+  }
 
-  for (std::size_t i = 0; i < numSlots; i++) {
-    runSingle(numSlots);
+  // A resumed simulation continues after the slot of its checkpoint.
+  if (!mHasBegun) {
+    checkPrerequisites();
+    beginSimulation(maxSlots);
+  }
+  while (mSlotNumber < maxSlots) {
+    runSingle(maxSlots);
+    if (predicate && predicate(mPreviousState, mSlotNumber - 1)) {
+      ANL_LOG(INFO, "Stop condition fulfilled after slot %zu.",
+        mSlotNumber - 1);
+      break;
+    }
+    if (!mRepetition.empty()) {
+      skipSlots(predicate, maxSlots - mSlotNumber);
+      break;
+    }
   }
   endSingle();
-  mErrorTracer.leave();
+  return mSlotNumber;
 }
 
 // _____________________________________________________________________________
 void Simulator::runSingle(std::size_t intendedSlots) {
-  mErrorTracer.enter("Simulator::runSingle()");
-  mErrorTracer.enter("Checking prerequisites");
-  mErrorTracer.require(mTopology != nullptr, "Network topology must be set.");
-  mErrorTracer.require(mOutputModule != nullptr, "Output module must be set.");
-  mErrorTracer.leave();
-
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::runSingle()");
+  checkPrerequisites();
   if (!mHasBegun) {
-    mHasBegun = true;
-    std::fprintf(stderr, "[ INFO ] Simulating %zu slots.\n", intendedSlots);
-    mOutputModule->onSimulationBegin(intendedSlots, &mSetup, mTopology);
+    beginSimulation(intendedSlots);
   }
   runSlot();
   mSlotNumber++;
 
-  mErrorTracer.leave();
+  if (!mCheckpointPath.empty() && mSlotNumber % mCheckpointInterval == 0
+      && !writeCheckpoint()) {
+    ANL_LOG(WARNING, "Checkpoints disabled, as not all parts of the "
+      "simulation support them.");
+    mCheckpointPath.clear();
+  }
+}
+
+// _____________________________________________________________________________
+void Simulator::checkPrerequisites() {
+  ANL_TRACE_SECTION(&mErrorTracer, "Checking prerequisites");
+  mErrorTracer.require(mTopology != nullptr, "Network topology must be set.");
+  mErrorTracer.require(mOutputModule != nullptr, "Output module must be "
+    "set.");
+}
+
+// _____________________________________________________________________________
+void Simulator::beginSimulation(std::size_t intendedSlots) {
+  mHasBegun = true;
+  if (mMergeProtocolLog) {
+    mProtocolLog.setOutputModule(mOutputModule);
+  }
+  if (!mResumePath.empty() && readCheckpoint(intendedSlots)) {
+    return;
+  }
+  ANL_LOG(INFO, "Simulating %zu slots.", intendedSlots);
+  mOutputModule->onSimulationBegin(intendedSlots, &mSetup, mTopology);
+}
+
+// _____________________________________________________________________________
+bool Simulator::writeCheckpoint() {
+  ANL_TRACE_SECTION(&mErrorTracer, "Writing checkpoint");
+  CheckpointWriter writer(&mSetup);
+  writer.writeMagic();
+  writer.writeNumber(mSetup.getTicsPerSlot());
+  writer.writeNumber(mSetup.getComponentCount());
+  writer.writeNumber(mSlotNumber);
+  std::ostringstream random;
+  random << mRandom;
+  writer.writeString(random.str());
+  bool success = writer.writeState(mPreviousState);
+  mSetup.forEachComponent([&writer, &success](const Component* comp) {
+    success = success && comp->saveState(&writer);
+  });
+
+  // The protocol log is not part of the checkpoint, but it should be written
+  //  up to the checkpoint like the output.
+  mProtocolLog.flush();
+  success = success && mOutputModule->saveState(&writer);
+  if (!success) {
+    return false;
+  }
+
+  // The previous checkpoint is only replaced once the new one is complete.
+  std::string tmpPath = mCheckpointPath + ".tmp";
+  Output::Sink* sink = Output::Sink::openFile(tmpPath, 0, true);
+  mErrorTracer.require(sink != nullptr, "Could not write checkpoint.");
+  sink->write(writer.getData());
+  delete sink;
+  mErrorTracer.require(std::rename(tmpPath.c_str(),
+    mCheckpointPath.c_str()) == 0, "Could not replace checkpoint.");
+  ANL_LOG(FINE, "Checkpoint written after slot %zu.", mSlotNumber - 1);
+  return true;
+}
+
+// _____________________________________________________________________________
+bool Simulator::readCheckpoint(std::size_t intendedSlots) {
+  ANL_TRACE_SECTION(&mErrorTracer, "Reading checkpoint");
+  std::ifstream in(mResumePath, std::ios::binary);
+  if (!in) {
+    ANL_LOG(INFO, "No checkpoint to resume from at %s.", mResumePath.c_str());
+    return false;
+  }
+  std::stringstream sstr;
+  sstr << in.rdbuf();
+  CheckpointReader reader(&mSetup, sstr.str());
+
+  // The checkpoint must have been written by the same simulation.
+  std::uint64_t ticsPerSlot = 0;
+  std::uint64_t componentCount = 0;
+  std::uint64_t slot = 0;
+  std::string random;
+  mErrorTracer.require(reader.readMagic() && reader.readNumber(&ticsPerSlot)
+    && ticsPerSlot == mSetup.getTicsPerSlot()
+    && reader.readNumber(&componentCount)
+    && componentCount == mSetup.getComponentCount()
+    && reader.readNumber(&slot) && slot > 0, "Checkpoint does not match the "
+    "simulation.");
+
+  std::istringstream randomStream;
+  NetworkState state(&mSetup);
+  bool success = reader.readString(&random);
+  if (success) {
+    randomStream.str(random);
+    success = static_cast<bool>(randomStream >> mRandom);
+  }
+  success = success && reader.readState(&state);
+  mSetup.forEachComponent([&reader, &success](Component* comp) {
+    success = success && comp->loadState(&reader);
+  });
+  mErrorTracer.require(success, "Checkpoint is malformed.");
+  mSlotNumber = slot;
+  mPreviousState = state;
+
+  ANL_LOG(INFO, "Resuming after slot %zu, simulating %zu slots.",
+    mSlotNumber - 1, intendedSlots);
+  mOutputModule->onSimulationResume(intendedSlots, &mSetup, mTopology,
+    mSlotNumber);
+  mErrorTracer.require(mOutputModule->loadState(&reader) && reader.atEnd(),
+    "Checkpoint is malformed.");
+  return true;
 }
 
 // _____________________________________________________________________________
 void Simulator::endSingle() {
-  mErrorTracer.enter("Simulator::endSingle()");
-  mErrorTracer.enter("Checking prerequisites");
-  mErrorTracer.require(mOutputModule != nullptr, "Output module must be set.");
-  mErrorTracer.leave();
-  mOutputModule->onSimulationEnd();
-  mErrorTracer.leave();
+  ANL_TRACE_SECTION(&mErrorTracer, "Simulator::endSingle()");
+  {
+    ANL_TRACE_SECTION(&mErrorTracer, "Checking prerequisites");
+    mErrorTracer.require(mOutputModule != nullptr, "Output module must be "
+      "set.");
+  }
+  mProtocolLog.flush();
+  mOutputModule->onSimulationEnd(mSlotNumber);
+}
+
+// _____________________________________________________________________________
+void Simulator::skipSlots(const StopPredicate& predicate,
+    std::size_t remaining) {
+  bool skip = false;
+  if (mQuiescent) {
+    ANL_LOG(INFO, "Network quiescent after slot %zu, %zu slots remaining.",
+      mSlotNumber - 1, remaining);
+    skip = mQuiescenceMode == QuiescenceMode::FAST_FORWARD;
+  } else {
+    ANL_LOG(INFO, "Network cycles with period %zu after slot %zu, %zu "
+      "slots remaining.", mCyclePeriod, mSlotNumber - 1, remaining);
+    skip = mCycleMode == CycleMode::EXTRAPOLATE;
+  }
+  if (!skip || remaining == 0) {
+    return;
+  }
+
+  // The predicate still decides where the simulation ends, based on the
+  //  repeated network states.
+  std::size_t count = remaining;
+  if (predicate) {
+    for (std::size_t i = 0; i < remaining; i++) {
+      if (predicate(mRepetition[i % mRepetition.size()], mSlotNumber + i)) {
+        count = i + 1;
+        break;
+      }
+    }
+  }
+  mOutputModule->onSlotsSkipped(mSlotNumber, count, mRepetition);
+  mSlotNumber += count;
 }
 
 // _____________________________________________________________________________
 void Simulator::runSlot() {
-  mErrorTracer.enter("Running slot");
+  ANL_TRACE_SECTION(&mErrorTracer, "Running slot");
   mOutputModule->onSlotBegin(mSlotNumber);
 
   IntentionAssignment targetIntent(&mSetup);
   NetworkState* oldState = (mSlotNumber == 0) ? nullptr : &mPreviousState;
 
   // Run the protocols.
-  std::fprintf(stderr, "[ INFO ] Running network protocol for slot %zu.\n",
-    mSlotNumber);
+  ANL_LOG(FINE, "Running network protocol for slot %zu.", mSlotNumber);
   mANL.runSlot(mSlotNumber, oldState, &targetIntent);
 
+  // A merged protocol log must be written before the slot is continued.
+  if (mMergeProtocolLog) {
+    mProtocolLog.flush();
+  }
+
   // Ensure the intent is not partial.
   mErrorTracer.require(!targetIntent.isPartial(), "Protocol produced a partial "
     "intention assignment.");
@@ -175,7 +443,123 @@ void Simulator::runSlot() {
   mOutputModule->onResultChosen(mPreviousState);
 
   mOutputModule->onSlotEnd();
-  mErrorTracer.leave();
+
+  mRepetition.clear();
+  if (mQuiescenceMode != QuiescenceMode::OFF) {
+    updateQuiescence();
+  }
+  if (mCycleMode != CycleMode::OFF) {
+    updateCycles();
+  }
+
+  // Recycle the temporary data of the slot.
+  mSlotArena.release();
+}
+
+// _____________________________________________________________________________
+void Simulator::updateQuiescence() {
+  // Comparing the network states is cheap compared to asking every component,
+  //  thus it is done first.
+  std::size_t distance = 0;
+  for (std::size_t i = 0; i < mRecentStates.size() && distance == 0; i++) {
+    if (mRecentStates[mRecentStates.size() - i - 1] == mPreviousState) {
+      distance = i + 1;
+    }
+  }
+  mQuiescent = distance > 0;
+  if (mQuiescent) {
+    mSetup.forEachComponent([this](const Component* comp) {
+      mQuiescent = mQuiescent && comp->isStable();
+    });
+  }
+
+  mRecentStates.push_back(mPreviousState);
+  if (mRecentStates.size() > mQuiescencePeriod) {
+    mRecentStates.pop_front();
+  }
+
+  // The following slots repeat the states since the matching one.
+  if (mQuiescent) {
+    mRepetition.assign(mRecentStates.end() - distance, mRecentStates.end());
+  }
+}
+
+// _____________________________________________________________________________
+void Simulator::updateCycles() {
+  ANL_TRACE_SECTION(&mErrorTracer, "Detecting cycles");
+  StateHasher hasher;
+  mPreviousState.hashState(&hasher);
+  bool exposed = true;
+  mSetup.forEachComponent([&hasher, &exposed](const Component* comp) {
+    exposed = exposed && comp->hashState(&hasher);
+  });
+  if (!exposed) {
+    ANL_LOG(WARNING, "Cycle detection disabled, as not all components expose "
+      "their state.");
+    mCycleMode = CycleMode::OFF;
+    return;
+  }
+
+  // A repeated global state closes a cycle once the whole period repeated.
+  std::size_t hash = hasher.getHash();
+  std::unordered_map<std::size_t, std::size_t>::iterator it =
+    mHistoryIndex.find(hash);
+  mCyclePeriod = 0;
+  if (it != mHistoryIndex.end()
+      && isCycleConfirmed(hash, mSlotNumber - it->second)) {
+    mCyclePeriod = mSlotNumber - it->second;
+    if (mRepetition.empty()) {
+      // The following slots repeat the slots after the matching one.
+      for (std::size_t i = mHistory.size() - (mCyclePeriod - 1);
+          i < mHistory.size(); i++) {
+        mRepetition.push_back(mHistory[i].state);
+      }
+      mRepetition.push_back(mPreviousState);
+    }
+  }
+
+  // Remember the global state, forgetting the oldest one if necessary.
+  //  This also replaces a colliding global state.
+  mHistoryIndex[hash] = mSlotNumber;
+  mHistory.push_back(HistoryEntry{hash, mSlotNumber, mPreviousState});
+  if (mHistory.size() > mHistorySize) {
+    it = mHistoryIndex.find(mHistory.front().hash);
+    if (it != mHistoryIndex.end() && it->second == mHistory.front().slot) {
+      mHistoryIndex.erase(it);
+    }
+    mHistory.pop_front();
+  }
+}
+
+// _____________________________________________________________________________
+bool Simulator::isCycleConfirmed(std::size_t hash, std::size_t period) const {
+  // The states of the components are only known by their hash, thus a hash
+  //  collision could fake a cycle. A collision is detected if the network
+  //  states differ, and made unlikely otherwise by requiring the states of
+  //  the whole period to repeat. The remembered slots are consecutive unless
+  //  slots were skipped.
+  std::size_t size = mHistory.size();
+  if (period == 0 || size < 2 * period - 1) {
+    return false;
+  }
+  const HistoryEntry& matched = mHistory[size - period];
+  if (matched.slot + period != mSlotNumber || matched.hash != hash) {
+    return false;
+  }
+  if (matched.state != mPreviousState) {
+    ANL_LOG(WARNING, "Global states after slots %zu and %zu have equal hashes "
+      "but different network states.", matched.slot, mSlotNumber);
+    return false;
+  }
+  for (std::size_t i = 1; i < period; i++) {
+    const HistoryEntry& later = mHistory[size - i];
+    const HistoryEntry& earlier = mHistory[size - i - period];
+    if (later.slot != earlier.slot + period || later.hash != earlier.hash
+        || later.state != earlier.state) {
+      return false;
+    }
+  }
+  return true;
 }
 
 
@@ -0,0 +1,236 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include "anl/core/sweep.h"
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include "anl/misc/asserts.h"
+#include "anl/misc/log.h"
+
+// This file contains the parameter sweeps from the CORE module.
+namespace Core {
+
+
+// _____________________________________________________________________________
+// The parameters of the current simulation run.
+static std::map<std::string, std::string> gParameters;
+
+// _____________________________________________________________________________
+void Parameters::set(const std::string& name, const std::string& value) {
+  gParameters[name] = value;
+}
+
+// _____________________________________________________________________________
+bool Parameters::has(const std::string& name) {
+  return gParameters.find(name) != gParameters.end();
+}
+
+// _____________________________________________________________________________
+std::string Parameters::get(const std::string& name,
+    const std::string& defaultValue) {
+  auto it = gParameters.find(name);
+  return it == gParameters.end() ? defaultValue : it->second;
+}
+
+// _____________________________________________________________________________
+std::size_t Parameters::getSize(const std::string& name,
+    std::size_t defaultValue) {
+  auto it = gParameters.find(name);
+  if (it == gParameters.end()) {
+    return defaultValue;
+  }
+  const char* str = it->second.c_str();
+  char* end = nullptr;
+  std::size_t result = std::strtoull(str, &end, 10);
+  Misc::Asserts::require(*str != '\0' && *end == '\0',
+    "parameter is not a size");
+  return result;
+}
+
+// _____________________________________________________________________________
+void Parameters::clear() {
+  gParameters.clear();
+}
+
+// _____________________________________________________________________________
+void ParameterSweep::addParameter(const std::string& name,
+    const std::vector<std::string>& values) {
+  Misc::Asserts::require(!values.empty(), "parameter needs values");
+  for (const std::string& other : mNames) {
+    Misc::Asserts::require(other != name, "parameter is already swept");
+  }
+  mNames.push_back(name);
+  mValues.push_back(values);
+}
+
+// _____________________________________________________________________________
+const std::string& ParameterSweep::getParameterName(std::size_t param) const {
+  Misc::Asserts::require(param < mNames.size(), "parameter out of range");
+  return mNames[param];
+}
+
+// _____________________________________________________________________________
+std::size_t ParameterSweep::getRunCount() const {
+  std::size_t result = 1;
+  for (const std::vector<std::string>& values : mValues) {
+    result *= values.size();
+  }
+  return result;
+}
+
+// _____________________________________________________________________________
+const std::string& ParameterSweep::getValue(std::size_t run,
+    std::size_t param) const {
+  Misc::Asserts::require(run < getRunCount(), "run out of range");
+  Misc::Asserts::require(param < mNames.size(), "parameter out of range");
+
+  // The run index is a mixed-radix number with one digit per parameter, the
+  //  last parameter being the least significant digit.
+  for (std::size_t p = mValues.size() - 1; p > param; p--) {
+    run /= mValues[p].size();
+  }
+  return mValues[param][run % mValues[param].size()];
+}
+
+// _____________________________________________________________________________
+std::string ParameterSweep::getTableHeader(
+    const std::vector<std::string>& resultColumns) const {
+  std::string header = "run";
+  for (const std::string& name : mNames) {
+    header += " param:" + name;
+  }
+  for (const std::string& column : resultColumns) {
+    Misc::Asserts::require(column.find(':') == std::string::npos,
+      "result column contains ':'");
+    header += " " + column;
+  }
+  return header + "\n";
+}
+
+// _____________________________________________________________________________
+void ParameterSweep::applyRun(std::size_t run) const {
+  for (std::size_t param = 0; param < mNames.size(); param++) {
+    Parameters::set(mNames[param], getValue(run, param));
+  }
+}
+
+// _____________________________________________________________________________
+std::vector<ParameterSweep::Result> ParameterSweep::run(std::size_t jobs,
+    const RunFunction& function) const {
+  if (jobs == 0) {
+    auto processors = ::sysconf(_SC_NPROCESSORS_ONLN);
+    jobs = processors > 0 ? static_cast<std::size_t>(processors) : 1;
+  }
+
+  // The running processes with their runs and the read ends of the pipes
+  //  their results are written to.
+  std::size_t numRuns = getRunCount();
+  std::vector<Result> results(numRuns, Result{0, ""});
+  std::vector<pid_t> pids;
+  std::vector<std::size_t> runs;
+  std::vector<struct pollfd> fds;
+
+  std::size_t next = 0;
+  while (next < numRuns || !pids.empty()) {
+    // Start runs until the pool is saturated.
+    while (next < numRuns && pids.size() < jobs) {
+      int pipeFds[2];
+      Misc::Asserts::require(::pipe(pipeFds) == 0, "could not create pipe");
+
+      // Buffered output would be written by both processes otherwise.
+      Misc::Log::flush();
+      Output::Sink::getStdOut()->flush();
+      std::fflush(nullptr);
+      pid_t pid = ::fork();
+      Misc::Asserts::require(pid >= 0, "could not fork process");
+      if (pid == 0) {
+        // The child only writes to its own pipe. Its buffers are flushed
+        //  explicitly, as it must not run the exit handlers of the parent.
+        ::close(pipeFds[0]);
+        for (const struct pollfd& fd : fds) {
+          ::close(fd.fd);
+        }
+        applyRun(next);
+        int status = 0;
+        {
+          Output::Sink sink(pipeFds[1], Output::Sink::kDefaultBufferSize,
+            false, true);
+          status = function(next, &sink);
+        }
+        Misc::Log::flush();
+        Output::Sink::getStdOut()->flush();
+        std::fflush(nullptr);
+        ::_exit(status);
+      }
+      ::close(pipeFds[1]);
+      pids.push_back(pid);
+      runs.push_back(next);
+      fds.push_back({ pipeFds[0], POLLIN, 0 });
+      next++;
+    }
+
+    // Collect the results. A run has ended once its pipe is closed.
+    if (::poll(fds.data(), fds.size(), -1) < 0) {
+      Misc::Asserts::require(errno == EINTR, "could not poll pipes");
+      continue;
+    }
+    for (std::size_t i = fds.size(); i-- > 0;) {
+      if (fds[i].revents == 0) {
+        continue;
+      }
+      char buffer[4096];
+      ssize_t length = ::read(fds[i].fd, buffer, sizeof(buffer));
+      if (length > 0) {
+        results[runs[i]].output.append(buffer, length);
+        continue;
+      } else if (length < 0 && errno == EINTR) {
+        continue;
+      }
+      ::close(fds[i].fd);
+      int status = 0;
+      while (::waitpid(pids[i], &status, 0) < 0 && errno == EINTR) {}
+      results[runs[i]].status = WIFEXITED(status) ? WEXITSTATUS(status)
+        : 128 + WTERMSIG(status);
+      pids.erase(pids.begin() + i);
+      runs.erase(runs.begin() + i);
+      fds.erase(fds.begin() + i);
+    }
+  }
+  return results;
+}
+
+
+}  // namespace Core
@@ -28,14 +28,28 @@
 // Part of ANL-Impl.
 
 #include "anl/core/topologies.h"
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+#include "anl/core/anl.h"
+#include "anl/misc/asserts.h"
 
 // This file contains the default topologies in the CORE module.
 namespace Core {
 
 
+// _____________________________________________________________________________
+void TrivialNetworkTopology::doForEachReachable(const NetworkSetup& setup,
+    const Component* sndr, std::function<void(const Component*)> cb) const {
+  setup.forEachComponent(cb);
+}
+
 // _____________________________________________________________________________
 void ExplicitNetworkTopology::addEdge(const Component* from,
     const Component* to) {
+  markChanged();
   if (mStorage.count(from) > 0) {
     mStorage.at(from).insert(to);
   } else {
@@ -54,5 +68,221 @@ bool ExplicitNetworkTopology::doCanReach(const Component* sndr,
   return false;
 }
 
+// _____________________________________________________________________________
+void ExplicitNetworkTopology::doForEachReachable(const NetworkSetup& setup,
+    const Component* sndr, std::function<void(const Component*)> cb) const {
+  auto entry = mStorage.find(sndr);
+  if (entry == mStorage.end()) {
+    return;
+  }
+
+  // The edges are not stored in registration order. We sort the registered
+  //  neighbors by their index, skipping components unknown to the setup.
+  std::vector<std::pair<std::size_t, const Component*>> neighbors;
+  neighbors.reserve(entry->second.size());
+  for (const Component* rcvr : entry->second) {
+    if (setup.isComponent(*rcvr)) {
+      neighbors.emplace_back(setup.getComponentIndex(rcvr), rcvr);
+    }
+  }
+  std::sort(neighbors.begin(), neighbors.end());
+  for (const auto& neighbor : neighbors) {
+    cb(neighbor.second);
+  }
+}
+
+
+// _____________________________________________________________________________
+UnitDiskNetworkTopology::UnitDiskNetworkTopology(double range)
+  : mRange(range), mIs3D(false), mBuilt(true), mNeighborBegins(1, 0),
+    mOrderedSetup(nullptr), mOrderedCount(0) {
+  Misc::Asserts::require(range > 0, "range must be positive");
+}
+
+// _____________________________________________________________________________
+// The largest grid cell coordinate, leaving room for the adjacent cells.
+static const double kMaxGridCell = 4611686018427387904.0;  // 2^62
+
+// _____________________________________________________________________________
+void UnitDiskNetworkTopology::addComponent(const Component* comp, double x,
+    double y, double z) {
+  Misc::Asserts::require(mIndices.count(comp) == 0,
+    "component is already placed");
+  for (double coord : { x, y, z }) {
+    Misc::Asserts::require(std::isfinite(coord), "coordinates must be finite");
+    Misc::Asserts::require(std::fabs(coord / mRange) < kMaxGridCell,
+      "coordinates are too large for the range");
+  }
+  mIndices[comp] = mComps.size();
+  mComps.push_back(comp);
+  mCoords.push_back(x);
+  mCoords.push_back(y);
+  mCoords.push_back(z);
+  mIs3D = mIs3D || z != 0;
+  mBuilt = false;
+  markChanged();
+}
+
+// _____________________________________________________________________________
+std::size_t UnitDiskNetworkTopology::getNeighborCount(const Component* comp)
+    const {
+  auto entry = mIndices.find(comp);
+  if (entry == mIndices.end()) {
+    return 0;
+  }
+  buildNeighbors();
+  return mNeighborBegins[entry->second + 1] - mNeighborBegins[entry->second];
+}
+
+// _____________________________________________________________________________
+bool UnitDiskNetworkTopology::doCanReach(const Component* sndr,
+    const Component* rcvr) const {
+  auto from = mIndices.find(sndr);
+  auto to = mIndices.find(rcvr);
+  return from != mIndices.end() && to != mIndices.end()
+    && isInRange(from->second, to->second);
+}
+
+// _____________________________________________________________________________
+bool UnitDiskNetworkTopology::isInRange(std::size_t from, std::size_t to)
+    const {
+  if (from == to) {
+    return false;
+  }
+  const double* a = &mCoords[3 * from];
+  const double* b = &mCoords[3 * to];
+  double dx = a[0] - b[0];
+  double dy = a[1] - b[1];
+  double dz = a[2] - b[2];
+  return dx * dx + dy * dy + dz * dz <= mRange * mRange;
+}
+
+// _____________________________________________________________________________
+void UnitDiskNetworkTopology::doForEachReachable(const NetworkSetup& setup,
+    const Component* sndr, std::function<void(const Component*)> cb) const {
+  auto entry = mIndices.find(sndr);
+  if (entry == mIndices.end()) {
+    return;
+  }
+  buildNeighbors();
+  orderNeighbors(setup);
+  for (std::size_t i = mOrderedBegins[entry->second];
+      i < mOrderedBegins[entry->second + 1]; i++) {
+    cb(mOrdered[i]);
+  }
+}
+
+// _____________________________________________________________________________
+// The coordinates of a cell of the grid.
+struct GridCell {
+  std::int64_t x;
+  std::int64_t y;
+  std::int64_t z;
+
+  bool operator==(const GridCell& other) const
+    { return x == other.x && y == other.y && z == other.z; }
+};
+
+// _____________________________________________________________________________
+// Hashes cells of the grid.
+struct GridCellHasher {
+  std::size_t operator()(const GridCell& cell) const {
+    std::uint64_t hash = static_cast<std::uint64_t>(cell.x);
+    hash = hash * 0x9E3779B97F4A7C15ull + static_cast<std::uint64_t>(cell.y);
+    hash = hash * 0x9E3779B97F4A7C15ull + static_cast<std::uint64_t>(cell.z);
+    return static_cast<std::size_t>(hash ^ (hash >> 32));
+  }
+};
+
+// _____________________________________________________________________________
+void UnitDiskNetworkTopology::buildNeighbors() const {
+  if (mBuilt) {
+    return;
+  }
+
+  // Sort the components into cells as large as the range. Components in range
+  //  of each other are in the same or in adjacent cells.
+  std::size_t numComps = mComps.size();
+  std::vector<GridCell> cells;
+  cells.reserve(numComps);
+  std::unordered_map<GridCell, std::vector<std::size_t>, GridCellHasher> grid;
+  grid.reserve(numComps);
+  for (std::size_t i = 0; i < numComps; i++) {
+    GridCell cell = {
+      static_cast<std::int64_t>(std::floor(mCoords[3 * i] / mRange)),
+      static_cast<std::int64_t>(std::floor(mCoords[3 * i + 1] / mRange)),
+      static_cast<std::int64_t>(std::floor(mCoords[3 * i + 2] / mRange))
+    };
+    cells.push_back(cell);
+    grid[cell].push_back(i);
+  }
+
+  // Compare every component with the components of the adjacent cells. The
+  //  components of a cell are in placement order, which is kept by sorting
+  //  the neighbors of every component.
+  std::int64_t layers = mIs3D ? 1 : 0;
+  mNeighborBegins.assign(1, 0);
+  mNeighbors.clear();
+  for (std::size_t i = 0; i < numComps; i++) {
+    std::size_t begin = mNeighbors.size();
+    for (std::int64_t dx = -1; dx <= 1; dx++) {
+      for (std::int64_t dy = -1; dy <= 1; dy++) {
+        for (std::int64_t dz = -layers; dz <= layers; dz++) {
+          GridCell cell = { cells[i].x + dx, cells[i].y + dy, cells[i].z + dz };
+          auto entry = grid.find(cell);
+          if (entry == grid.end()) {
+            continue;
+          }
+          for (std::size_t j : entry->second) {
+            if (isInRange(i, j)) {
+              mNeighbors.push_back(j);
+            }
+          }
+        }
+      }
+    }
+    std::sort(mNeighbors.begin() + begin, mNeighbors.end());
+    mNeighborBegins.push_back(mNeighbors.size());
+  }
+  mBuilt = true;
+  mOrderedSetup = nullptr;
+}
+
+// _____________________________________________________________________________
+void UnitDiskNetworkTopology::orderNeighbors(const NetworkSetup& setup) const {
+  if (mOrderedSetup == &setup && mOrderedCount == setup.getComponentCount()) {
+    return;
+  }
+
+  // The registration index of every placed component that is registered.
+  std::size_t numComps = mComps.size();
+  std::vector<std::size_t> registered(numComps, setup.getComponentCount());
+  for (std::size_t i = 0; i < numComps; i++) {
+    if (setup.isComponent(*mComps[i])) {
+      registered[i] = setup.getComponentIndex(mComps[i]);
+    }
+  }
+
+  std::vector<std::pair<std::size_t, const Component*>> neighbors;
+  mOrderedBegins.assign(1, 0);
+  mOrdered.clear();
+  for (std::size_t i = 0; i < numComps; i++) {
+    neighbors.clear();
+    for (std::size_t n = mNeighborBegins[i]; n < mNeighborBegins[i + 1]; n++) {
+      std::size_t j = mNeighbors[n];
+      if (registered[j] < setup.getComponentCount()) {
+        neighbors.emplace_back(registered[j], mComps[j]);
+      }
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    for (const auto& neighbor : neighbors) {
+      mOrdered.push_back(neighbor.second);
+    }
+    mOrderedBegins.push_back(mOrdered.size());
+  }
+  mOrderedSetup = &setup;
+  mOrderedCount = setup.getComponentCount();
+}
+
 
 }  // namespace Core
@@ -29,7 +29,10 @@
 
 #include "anl/core/types.h"
 #include <string>
+#include <vector>
+#include "anl/core/anl.h"
 #include "anl/misc/asserts.h"
+#include "anl/misc/strings.h"
 
 // This file contains the types for the CORE module.
 namespace Core {
@@ -50,17 +53,82 @@ void Component::onAct(ANLView* view) {
 // _____________________________________________________________________________
 void Component::doAct(ANLView* view) {}
 
+// _____________________________________________________________________________
+std::vector<std::string> Component::toXML() const {
+  std::string buffer;
+  appendXML(&buffer, 0);
+  return Misc::Strings::splitLines(buffer);
+}
+
+// _____________________________________________________________________________
+void Component::doAppendXML(std::string* buffer, std::size_t indent) const {
+  Misc::Strings::appendLines(buffer, doToXML(), indent);
+}
+
+// _____________________________________________________________________________
+std::string Component::getId() const {
+  std::string buffer;
+  appendId(&buffer);
+  return buffer;
+}
+
+// _____________________________________________________________________________
+void Component::doAppendId(std::string* buffer) const {
+  buffer->append(doGetId());
+}
+
 // _____________________________________________________________________________
 bool Message::equals(const Message& other) const {
   // Just compare the addresses of the two messages.
   return this == &other;
 }
 
+// _____________________________________________________________________________
+std::string Message::toString() const {
+  std::string buffer;
+  appendText(&buffer);
+  return buffer;
+}
+
+// _____________________________________________________________________________
+void Message::doAppendText(std::string* buffer) const {
+  buffer->append(doToString());
+}
+
+// _____________________________________________________________________________
+std::vector<std::string> Message::toXML() const {
+  std::string buffer;
+  appendXML(&buffer, 0);
+  return Misc::Strings::splitLines(buffer);
+}
+
+// _____________________________________________________________________________
+void Message::doAppendXML(std::string* buffer, std::size_t indent) const {
+  Misc::Strings::appendLines(buffer, doToXML(), indent);
+}
+
 // _____________________________________________________________________________
 bool NetworkTopology::canReach(const Component* sndr, const Component* rcvr)
     const {
   return doCanReach(sndr, rcvr);
 }
 
+// _____________________________________________________________________________
+void NetworkTopology::forEachReachable(const NetworkSetup& setup,
+    const Component* sndr, std::function<void(const Component*)> cb) const {
+  doForEachReachable(setup, sndr, cb);
+}
+
+// _____________________________________________________________________________
+void NetworkTopology::doForEachReachable(const NetworkSetup& setup,
+    const Component* sndr, std::function<void(const Component*)> cb) const {
+  // Fallback for topologies that only know canReach: probe every component.
+  setup.forEachComponent([this, sndr, &cb](const Component* rcvr) {
+    if (canReach(sndr, rcvr)) {
+      cb(rcvr);
+    }
+  });
+}
+
 
 }  // namespace Core
@@ -0,0 +1,110 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include "anl/misc/arena.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "anl/misc/asserts.h"
+
+namespace Misc {
+
+
+// _____________________________________________________________________________
+constexpr std::size_t Arena::kDefaultBlockSize;
+
+// _____________________________________________________________________________
+Arena::Arena(std::size_t blockSize) : mCurrent(0), mUsed(0),
+    mNextBlockSize(blockSize), mAllocated(0) {
+  Asserts::require(blockSize != 0, "arena block size must not be zero");
+}
+
+// _____________________________________________________________________________
+Arena::~Arena() {
+  for (const Block& block : mBlocks) {
+    delete[] block.data;
+  }
+}
+
+// _____________________________________________________________________________
+void* Arena::allocate(std::size_t size, std::size_t align) {
+  Asserts::require(align != 0 && (align & (align - 1)) == 0, "arena alignment "
+    "must be a power of two");
+
+  while (mCurrent < mBlocks.size()) {
+    // Try the current block.
+    const Block& block = mBlocks[mCurrent];
+    std::uintptr_t start = reinterpret_cast<std::uintptr_t>(block.data);
+    std::size_t offset = static_cast<std::size_t>(
+      ((start + mUsed + align - 1) & ~(align - 1)) - start);
+    if (offset + size <= block.size) {
+      mUsed = offset + size;
+      mAllocated += size;
+      return block.data + offset;
+    }
+
+    // Continue with the next block that is free after a release, if it is
+    //  large enough for the request even in the worst case of alignment.
+    if (mCurrent + 1 == mBlocks.size()
+        || mBlocks[mCurrent + 1].size < size + align) {
+      break;
+    }
+    mCurrent++;
+    mUsed = 0;
+  }
+
+  // Start a new block behind the current one.
+  while (mNextBlockSize < size + align) {
+    mNextBlockSize *= 2;
+  }
+  Block block = {new char[mNextBlockSize], mNextBlockSize};
+  std::size_t position = mBlocks.empty() ? 0 : mCurrent + 1;
+  mBlocks.insert(mBlocks.begin() + position, block);
+  mNextBlockSize *= 2;
+  mCurrent = position;
+  mUsed = 0;
+  return allocate(size, align);
+}
+
+// _____________________________________________________________________________
+bool Arena::owns(const void* ptr) const {
+  // The blocks grow geometrically, thus there are only logarithmically many.
+  const char* p = static_cast<const char*>(ptr);
+  std::less<const char*> less;
+  for (std::size_t i = 0; i <= mCurrent && i < mBlocks.size(); i++) {
+    const Block& block = mBlocks[i];
+    if (!less(p, block.data) && less(p, block.data + block.size)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+}  // namespace Misc
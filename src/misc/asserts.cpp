@@ -30,6 +30,7 @@
 #include "anl/misc/asserts.h"
 #include <cstdio>
 #include <cstdlib>
+#include "anl/misc/log.h"
 
 namespace Misc {
 
@@ -37,6 +38,8 @@ namespace Misc {
 // _____________________________________________________________________________
 void Asserts::require(bool cond, const char* msg) {
   if (!cond) {
+    // Keep the order of pending log messages and the failure.
+    Log::flush();
     fprintf(stderr, "Assertion failed: %s\n", msg);
     std::exit(1);
   }
@@ -47,6 +50,7 @@ void Asserts::expect(bool cond, const char* msg) {
 #ifdef DEBUG
 #ifndef NDEBUG
   if (!cond) {
+    Log::flush();
     fprintf(stderr, "Expectation not met: %s\n", msg);
   }
 #endif
@@ -0,0 +1,166 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include "anl/misc/log.h"
+#include <unistd.h>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>  // NOLINT
+#include <vector>
+
+namespace Misc {
+
+
+// _____________________________________________________________________________
+LogLevel Log::sThreshold = LogLevel::INFO;
+
+// The buffered messages and the number of buffered bytes. The buffer is
+//  shared by all threads and guarded by the mutex.
+static char gBuffer[Log::kBufferSize];
+static std::size_t gUsed = 0;
+static std::mutex gMutex;
+
+// The file descriptor that messages are written to.
+static int gFd = STDERR_FILENO;
+
+// Whether or not the buffer is flushed at program exit.
+static bool gFlushAtExit = false;
+
+// The prefixes of the levels, indexed by level.
+static const char* const kPrefixes[] = {
+  "[ FINE ] ", "[ INFO ] ", "[ PROT ] ", "[ WARN ] ", "[SEVERE] "
+};
+static const std::size_t kPrefixLength = 9;
+
+// _____________________________________________________________________________
+static void writeFd(const char* data, std::size_t length) {
+  while (length > 0) {
+    ssize_t written = ::write(gFd, data, length);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      // Logging must never fail the program, thus the message is dropped.
+      return;
+    }
+    data += written;
+    length -= static_cast<std::size_t>(written);
+  }
+}
+
+// _____________________________________________________________________________
+static void flushLocked() {
+  writeFd(gBuffer, gUsed);
+  gUsed = 0;
+}
+
+// _____________________________________________________________________________
+bool Log::parseLevel(const char* name, LogLevel* level) {
+  static const char* const kNames[] = {
+    "fine", "info", "protocol", "warning", "severe", "off"
+  };
+  for (int i = 0; i <= static_cast<int>(LogLevel::OFF); i++) {
+    if (std::strcmp(name, kNames[i]) == 0) {
+      *level = static_cast<LogLevel>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+// _____________________________________________________________________________
+void Log::setFileDescriptor(int fd) {
+  std::lock_guard<std::mutex> lock(gMutex);
+  flushLocked();
+  gFd = fd;
+}
+
+// _____________________________________________________________________________
+void Log::write(LogLevel level, const char* format, ...) {
+  int index = static_cast<int>(level);
+  if (index < 0 || index >= static_cast<int>(LogLevel::OFF)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(gMutex);
+  if (!gFlushAtExit) {
+    gFlushAtExit = true;
+    std::atexit(&Log::flush);
+  }
+
+  // Determine the message length first, the message is then formatted into
+  //  the buffer directly if it fits.
+  va_list args;
+  va_start(args, format);
+  va_list attempt;
+  va_copy(attempt, args);
+  int length = std::vsnprintf(nullptr, 0, format, attempt);
+  va_end(attempt);
+  if (length < 0) {
+    va_end(args);
+    return;
+  }
+  // Empty messages are written without the separating space after the prefix.
+  std::size_t prefixLength = length == 0 ? kPrefixLength - 1 : kPrefixLength;
+  std::size_t total = prefixLength + static_cast<std::size_t>(length) + 1;
+  if (total > kBufferSize - gUsed) {
+    flushLocked();
+  }
+  if (total <= kBufferSize) {
+    std::memcpy(gBuffer + gUsed, kPrefixes[index], prefixLength);
+    std::vsnprintf(gBuffer + gUsed + prefixLength, length + 1, format, args);
+    gBuffer[gUsed + total - 1] = '\n';
+    gUsed += total;
+  } else {
+    // The message exceeds the buffer and is written directly.
+    std::vector<char> tmp(total + 1);
+    std::memcpy(tmp.data(), kPrefixes[index], prefixLength);
+    std::vsnprintf(tmp.data() + prefixLength, length + 1, format, args);
+    tmp[total - 1] = '\n';
+    writeFd(tmp.data(), total);
+  }
+  va_end(args);
+
+  // Important messages must not be delayed.
+  if (level >= LogLevel::WARNING) {
+    flushLocked();
+  }
+}
+
+// _____________________________________________________________________________
+void Log::flush() {
+  std::lock_guard<std::mutex> lock(gMutex);
+  flushLocked();
+}
+
+
+}  // namespace Misc
@@ -0,0 +1,110 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include "anl/misc/strings.h"
+#include <string>
+#include <vector>
+
+namespace Misc {
+
+
+// _____________________________________________________________________________
+void Strings::appendNumber(std::string* buffer, std::size_t value) {
+  // Digits are produced in reverse order into a stack buffer that is large
+  //  enough for any 64 bit value.
+  char digits[20];
+  std::size_t numDigits = 0;
+  do {
+    digits[numDigits++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  while (numDigits > 0) {
+    buffer->push_back(digits[--numDigits]);
+  }
+}
+
+// _____________________________________________________________________________
+void Strings::appendVarint(std::string* buffer, std::uint64_t value) {
+  while (value >= 0x80) {
+    buffer->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  buffer->push_back(static_cast<char>(value));
+}
+
+// _____________________________________________________________________________
+void Strings::appendEscapedXML(std::string* buffer, const std::string& text) {
+  for (char c : text) {
+    switch (c) {
+      case '&':
+        buffer->append("&amp;");
+        break;
+      case '<':
+        buffer->append("&lt;");
+        break;
+      case '>':
+        buffer->append("&gt;");
+        break;
+      case '"':
+        buffer->append("&quot;");
+        break;
+      default:
+        buffer->push_back(c);
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void Strings::appendLines(std::string* buffer,
+    const std::vector<std::string>& lines, std::size_t indent) {
+  for (const std::string& line : lines) {
+    buffer->append(indent, ' ');
+    buffer->append(line);
+    buffer->push_back('\n');
+  }
+}
+
+// _____________________________________________________________________________
+std::vector<std::string> Strings::splitLines(const std::string& buffer) {
+  std::vector<std::string> res;
+  std::size_t begin = 0;
+  while (begin < buffer.size()) {
+    std::size_t end = buffer.find('\n', begin);
+    if (end == std::string::npos) {
+      end = buffer.size();
+    }
+    res.emplace_back(buffer, begin, end - begin);
+    begin = end + 1;
+  }
+  return res;
+}
+
+
+}  // namespace Misc
@@ -0,0 +1,261 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "anl/core/checkpoint.h"
+#include "anl/misc/asserts.h"
+#include "anl/output/output.h"
+
+// This file contains an output module.
+namespace Output {
+
+
+// _____________________________________________________________________________
+FilterOutputModule::FilterOutputModule(OutputModule* module) : mModule(module),
+    mFirst(0), mLast(std::numeric_limits<std::size_t>::max()), mStride(1),
+    mBefore(0), mAfter(0), mAfterLeft(0), mSlot(0), mCandidate(false),
+    mForwarding(false), mIntent(nullptr), mOutcomes(nullptr) {
+  Misc::Asserts::require(module != nullptr, "can not filter nullptr as output "
+    "module");
+}
+
+// _____________________________________________________________________________
+FilterOutputModule::~FilterOutputModule() {
+  delete mModule;
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::setSlotRange(std::size_t first, std::size_t last) {
+  Misc::Asserts::require(first <= last, "empty slot range");
+  mFirst = first;
+  mLast = last;
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::setStride(std::size_t stride) {
+  Misc::Asserts::require(stride > 0, "stride must be greater than zero");
+  mStride = stride;
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::setPredicate(SlotPredicate predicate) {
+  mPredicate = predicate;
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::setContext(std::size_t before, std::size_t after) {
+  mBefore = before;
+  mAfter = after;
+}
+
+// _____________________________________________________________________________
+FilterOutputModule::SlotPredicate FilterOutputModule::anyAction(
+    Core::ActionType type) {
+  return [type](const Core::NetworkState& state) {
+    bool found = false;
+    state.forEachTrait([type, &found](const Core::Component* comp,
+        const Core::ComponentAction& action) {
+      found = found || action.getType() == type;
+    });
+    return found;
+  };
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::forwardSlot(std::size_t slot,
+    const std::vector<HeldLog>& logs, const Core::IntentionAssignment& intent,
+    const std::vector<Core::NetworkState>& outcomes,
+    const Core::NetworkState& state) {
+  mModule->onSlotBegin(slot);
+  for (const HeldLog& log : logs) {
+    mModule->onProtocolLog(log.componentId, log.message);
+  }
+  mModule->onIntentChosen(intent);
+  mModule->onTransitionComputed(outcomes);
+  mModule->onResultChosen(state);
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::doSimulationBegin(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology) {
+  mModule->onSimulationBegin(numSlots, setup, topology);
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::doSlotBegin(std::size_t slotNumber) {
+  mSlot = slotNumber;
+  mCandidate = slotNumber >= mFirst && slotNumber <= mLast
+    && (slotNumber - mFirst) % mStride == 0;
+  mIntent = nullptr;
+  mOutcomes = nullptr;
+  mLogs.clear();
+
+  // Without a predicate, the decision is final and we can forward right away.
+  mForwarding = mCandidate && !mPredicate;
+  if (mForwarding) {
+    mModule->onSlotBegin(slotNumber);
+  }
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::doProtocolLog(const std::string& componentId,
+    const std::string& message) {
+  if (mForwarding) {
+    mModule->onProtocolLog(componentId, message);
+  } else if (mCandidate) {
+    mLogs.push_back(HeldLog{componentId, message});
+  }
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::doIntentChosen(
+    const Core::IntentionAssignment& intent) {
+  if (mForwarding) {
+    mModule->onIntentChosen(intent);
+  } else if (mCandidate) {
+    mIntent = &intent;
+  }
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::doTransitionComputed(
+    const std::vector<Core::NetworkState>& outcomes) {
+  if (mForwarding) {
+    mModule->onTransitionComputed(outcomes);
+  } else if (mCandidate) {
+    mOutcomes = &outcomes;
+  }
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::doResultChosen(const Core::NetworkState& state) {
+  if (mForwarding) {
+    mModule->onResultChosen(state);
+    return;
+  }
+  if (!mCandidate) {
+    return;
+  }
+  Misc::Asserts::require(mIntent != nullptr && mOutcomes != nullptr,
+    "result chosen before intent and outcomes");
+
+  if (mPredicate(state)) {
+    // A match: the held back context is forwarded first.
+    for (const HeldSlot& held : mHeld) {
+      forwardSlot(held.slot, held.logs, held.intent, held.outcomes,
+        held.result);
+      mModule->onSlotEnd();
+    }
+    mHeld.clear();
+    mAfterLeft = mAfter;
+    mForwarding = true;
+  } else if (mAfterLeft > 0) {
+    // Context after a match.
+    mAfterLeft--;
+    mForwarding = true;
+  } else if (mBefore > 0) {
+    // Potential context before a match.
+    mHeld.push_back(HeldSlot{mSlot, mLogs, *mIntent, *mOutcomes, state});
+    if (mHeld.size() > mBefore) {
+      mHeld.pop_front();
+    }
+  }
+
+  if (mForwarding) {
+    forwardSlot(mSlot, mLogs, *mIntent, *mOutcomes, state);
+  }
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::doSlotEnd() {
+  if (mForwarding) {
+    mModule->onSlotEnd();
+  }
+  mForwarding = false;
+  mIntent = nullptr;
+  mOutcomes = nullptr;
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::doSlotsSkipped(std::size_t firstSlot,
+    std::size_t count, const std::vector<Core::NetworkState>& cycle) {
+  // Only the skipped slots within the slot range are forwarded, regardless of
+  //  the stride and the predicate. If leading slots are cut off, the cycle
+  //  must begin with a later network state.
+  std::size_t first = std::max(firstSlot, mFirst);
+  std::size_t last = std::min(firstSlot + count - 1, mLast);
+  if (count == 0 || first > last) {
+    return;
+  }
+  std::size_t shift = (first - firstSlot) % cycle.size();
+  if (shift == 0) {
+    mModule->onSlotsSkipped(first, last - first + 1, cycle);
+  } else {
+    std::vector<Core::NetworkState> shifted(cycle.begin() + shift,
+      cycle.end());
+    shifted.insert(shifted.end(), cycle.begin(), cycle.begin() + shift);
+    mModule->onSlotsSkipped(first, last - first + 1, shifted);
+  }
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::doSimulationEnd(std::size_t numSlots) {
+  mModule->onSimulationEnd(numSlots);
+}
+
+// _____________________________________________________________________________
+void FilterOutputModule::doSimulationResume(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology,
+    std::size_t firstSlot) {
+  mModule->onSimulationResume(numSlots, setup, topology, firstSlot);
+}
+
+// _____________________________________________________________________________
+bool FilterOutputModule::doSaveState(Core::CheckpointWriter* writer) {
+  // Held slots are not saved, thus a match right after resuming lacks the
+  //  context from before the checkpoint.
+  writer->writeNumber(mAfterLeft);
+  return mModule->saveState(writer);
+}
+
+// _____________________________________________________________________________
+bool FilterOutputModule::doLoadState(Core::CheckpointReader* reader) {
+  std::uint64_t afterLeft = 0;
+  if (!reader->readNumber(&afterLeft)) {
+    return false;
+  }
+  mAfterLeft = afterLeft;
+  mHeld.clear();
+  return mModule->loadState(reader);
+}
+
+}  // namespace Output
@@ -0,0 +1,137 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <cstdint>
+#include <vector>
+#include "anl/core/checkpoint.h"
+#include "anl/misc/asserts.h"
+#include "anl/output/output.h"
+
+// This file contains an output module.
+namespace Output {
+
+
+// _____________________________________________________________________________
+const char IndexOutputModule::kMagic[8] = {
+  'A', 'N', 'L', 'I', 'D', 'X', '0', '1'
+};
+
+// _____________________________________________________________________________
+const std::uint64_t IndexOutputModule::kEndSlot;
+const std::uint64_t IndexOutputModule::kRangeFlag;
+
+// _____________________________________________________________________________
+IndexOutputModule::IndexOutputModule(OutputModule* module,
+    const Sink* traceSink, Sink* indexSink, std::size_t slotsPerEntry)
+    : mModule(module), mTraceSink(traceSink), mIndexSink(indexSink),
+      mSlotsPerEntry(slotsPerEntry), mSlotCount(0), mIndexedSlot(kEndSlot) {
+  Misc::Asserts::require(module != nullptr, "can not index nullptr as output "
+    "module");
+  Misc::Asserts::require(traceSink != nullptr && indexSink != nullptr,
+    "index requires trace and index sinks");
+  Misc::Asserts::require(slotsPerEntry > 0, "slots per index entry must be "
+    "greater than zero");
+}
+
+// _____________________________________________________________________________
+IndexOutputModule::~IndexOutputModule() {
+  delete mModule;
+}
+
+// _____________________________________________________________________________
+void IndexOutputModule::writeEntry(std::uint64_t slot, std::uint64_t offset) {
+  std::uint64_t entry[2] = { slot, offset };
+  mIndexSink->write(reinterpret_cast<const char*>(entry), sizeof(entry));
+}
+
+// _____________________________________________________________________________
+void IndexOutputModule::doSimulationBegin(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology) {
+  mSlotCount = 0;
+  mIndexedSlot = kEndSlot;
+  mIndexSink->write(kMagic, sizeof(kMagic));
+  std::uint64_t slotsPerEntry = mSlotsPerEntry;
+  mIndexSink->write(reinterpret_cast<const char*>(&slotsPerEntry),
+    sizeof(slotsPerEntry));
+  mModule->onSimulationBegin(numSlots, setup, topology);
+}
+
+// _____________________________________________________________________________
+void IndexOutputModule::doSlotBegin(std::size_t slotNumber) {
+  // The slot begins where the child's output currently ends.
+  if (mSlotCount++ % mSlotsPerEntry == 0 && slotNumber != mIndexedSlot) {
+    writeEntry(slotNumber, mTraceSink->getPosition());
+  }
+  mModule->onSlotBegin(slotNumber);
+}
+
+// _____________________________________________________________________________
+void IndexOutputModule::doSlotsSkipped(std::size_t firstSlot,
+    std::size_t count, const std::vector<Core::NetworkState>& cycle) {
+  // The child covers the skipped slots with a single record, which is found
+  //  for each of them through the marked entry. The slots after them begin
+  //  where the record ends.
+  writeEntry(firstSlot, mTraceSink->getPosition() | kRangeFlag);
+  mModule->onSlotsSkipped(firstSlot, count, cycle);
+  mIndexedSlot = firstSlot + count;
+  writeEntry(mIndexedSlot, mTraceSink->getPosition());
+  mSlotCount = 0;
+}
+
+// _____________________________________________________________________________
+void IndexOutputModule::doSimulationEnd(std::size_t numSlots) {
+  writeEntry(kEndSlot, mTraceSink->getPosition());
+  mModule->onSimulationEnd(numSlots);
+  mIndexSink->flush();
+}
+
+// _____________________________________________________________________________
+void IndexOutputModule::doSimulationResume(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology,
+    std::size_t firstSlot) {
+  mModule->onSimulationResume(numSlots, setup, topology, firstSlot);
+}
+
+// _____________________________________________________________________________
+bool IndexOutputModule::doSaveState(Core::CheckpointWriter* writer) {
+  mIndexSink->flush();
+  writer->writeNumber(mIndexSink->getPosition());
+  writer->writeNumber(mSlotCount);
+  return mModule->saveState(writer);
+}
+
+// _____________________________________________________________________________
+bool IndexOutputModule::doLoadState(Core::CheckpointReader* reader) {
+  std::uint64_t position = 0;
+  mIndexedSlot = kEndSlot;
+  return reader->readNumber(&position) && mIndexSink->resumeAt(position)
+    && reader->readValue(&mSlotCount) && mModule->loadState(reader);
+}
+
+}  // namespace Output
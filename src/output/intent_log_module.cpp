@@ -0,0 +1,203 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "anl/core/checkpoint.h"
+#include "anl/core/replay.h"
+#include "anl/misc/strings.h"
+#include "anl/output/output.h"
+
+// This file contains an output module.
+namespace Output {
+
+
+// _____________________________________________________________________________
+// Appends a length-prefixed string to the buffer.
+static void appendString(std::string* buffer, const std::string& str) {
+  Misc::Strings::appendVarint(buffer, str.size());
+  buffer->append(str);
+}
+
+// _____________________________________________________________________________
+// Appends a count-prefixed list of strings to the buffer.
+static void appendStringList(std::string* buffer,
+    const std::vector<std::string>& lines) {
+  Misc::Strings::appendVarint(buffer, lines.size());
+  for (const std::string& line : lines) {
+    appendString(buffer, line);
+  }
+}
+
+// _____________________________________________________________________________
+IntentLogOutputModule::IntentLogOutputModule(Sink* sink)
+    : mSink(sink != nullptr ? sink : Sink::getStdOut()), mSetup(nullptr),
+      mSlot(0) {}
+
+// _____________________________________________________________________________
+std::size_t IntentLogOutputModule::getMessageIndex(const Core::Message* msg) {
+  auto entry = mMessageIndices.find(msg);
+  if (entry != mMessageIndices.end()) {
+    return entry->second;
+  }
+
+  std::size_t index = mMessageIndices.size();
+  mMessageIndices.emplace(msg, index);
+  mDefinitions.push_back(Core::IntentLog::kMessageTag);
+  Misc::Strings::appendVarint(&mDefinitions, index);
+  const std::string* str = mSetup->findMessageString(msg);
+  if (str != nullptr) {
+    appendString(&mDefinitions, *str);
+    appendStringList(&mDefinitions, *mSetup->findMessageXML(msg));
+  } else {
+    appendString(&mDefinitions, msg->toString());
+    appendStringList(&mDefinitions, msg->toXML());
+  }
+  return index;
+}
+
+// _____________________________________________________________________________
+void IntentLogOutputModule::doSimulationBegin(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology) {
+  mSetup = setup;
+  mMessageIndices.clear();
+
+  mBuffer.assign(Core::IntentLog::kMagic, sizeof(Core::IntentLog::kMagic));
+  Misc::Strings::appendVarint(&mBuffer, setup->getTicsPerSlot());
+  Misc::Strings::appendVarint(&mBuffer, numSlots);
+  Misc::Strings::appendVarint(&mBuffer, setup->getComponentCount());
+  setup->forEachComponent([this](const Core::Component* comp) {
+    appendString(&mBuffer, mSetup->getComponentId(comp));
+    appendStringList(&mBuffer, mSetup->getComponentXML(comp));
+  });
+
+  // The topology is stored explicitly, as its code is not available later.
+  std::vector<std::size_t> reachable;
+  setup->forEachComponent(
+      [this, topology, &reachable](const Core::Component* sndr) {
+    reachable.clear();
+    topology->forEachReachable(*mSetup, sndr,
+        [this, &reachable](const Core::Component* rcvr) {
+      reachable.push_back(mSetup->getComponentIndex(rcvr));
+    });
+    Misc::Strings::appendVarint(&mBuffer, reachable.size());
+    for (std::size_t rcvr : reachable) {
+      Misc::Strings::appendVarint(&mBuffer, rcvr);
+    }
+  });
+  mSink->write(mBuffer);
+}
+
+// _____________________________________________________________________________
+void IntentLogOutputModule::doIntentChosen(
+    const Core::IntentionAssignment& intent) {
+  mDefinitions.clear();
+  mBuffer.clear();
+  mBuffer.push_back(Core::IntentLog::kSlotTag);
+  Misc::Strings::appendVarint(&mBuffer, mSlot);
+  intent.forEachTrait([this](const Core::Component* comp,
+      const Core::ComponentIntention& trait) {
+    Misc::Strings::appendVarint(&mBuffer,
+      static_cast<std::uint64_t>(trait.getType()));
+    if (trait.getType() == Core::IntentionType::SEND
+        || trait.getType() == Core::IntentionType::SEND_FORCE) {
+      Misc::Strings::appendVarint(&mBuffer, trait.getTic());
+      Misc::Strings::appendVarint(&mBuffer,
+        getMessageIndex(trait.getMessage()));
+    }
+  });
+  mSink->write(mDefinitions);
+  mSink->write(mBuffer);
+}
+
+// _____________________________________________________________________________
+void IntentLogOutputModule::doSlotsSkipped(std::size_t firstSlot,
+    std::size_t count, const std::vector<Core::NetworkState>& cycle) {
+  mBuffer.clear();
+  mBuffer.push_back(Core::IntentLog::kSkipTag);
+  Misc::Strings::appendVarint(&mBuffer, firstSlot);
+  Misc::Strings::appendVarint(&mBuffer, count);
+  Misc::Strings::appendVarint(&mBuffer, cycle.size());
+  mSink->write(mBuffer);
+}
+
+// _____________________________________________________________________________
+void IntentLogOutputModule::doSimulationEnd(std::size_t numSlots) {
+  mSink->write(&Core::IntentLog::kEndTag, 1);
+  mSink->flush();
+}
+
+// _____________________________________________________________________________
+void IntentLogOutputModule::doSimulationResume(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology,
+    std::size_t firstSlot) {
+  // The defined messages are restored by loadState.
+  mSetup = setup;
+  mMessageIndices.clear();
+}
+
+// _____________________________________________________________________________
+bool IntentLogOutputModule::doSaveState(Core::CheckpointWriter* writer) {
+  mSink->flush();
+  writer->writeNumber(mSink->getPosition());
+
+  // The messages are saved in the order of their definition.
+  std::vector<const Core::Message*> messages(mMessageIndices.size());
+  for (const auto& entry : mMessageIndices) {
+    messages[entry.second] = entry.first;
+  }
+  writer->writeNumber(messages.size());
+  for (const Core::Message* msg : messages) {
+    if (!writer->writeMessage(msg)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+bool IntentLogOutputModule::doLoadState(Core::CheckpointReader* reader) {
+  std::uint64_t position = 0;
+  std::uint64_t count = 0;
+  if (!reader->readNumber(&position) || !mSink->resumeAt(position)
+      || !reader->readNumber(&count)) {
+    return false;
+  }
+  for (std::size_t i = 0; i < count; i++) {
+    const Core::Message* msg = nullptr;
+    if (!reader->readMessage(&msg)) {
+      return false;
+    }
+    mMessageIndices.emplace(msg, i);
+  }
+  return true;
+}
+
+}  // namespace Output
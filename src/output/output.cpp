@@ -65,14 +65,43 @@ void OutputModule::onResultChosen(const NetworkState& state) {
   doResultChosen(state);
 }
 
+// _____________________________________________________________________________
+void OutputModule::onProtocolLog(const std::string& componentId,
+    const std::string& message) {
+  doProtocolLog(componentId, message);
+}
+
 // _____________________________________________________________________________
 void OutputModule::onSlotEnd() {
   doSlotEnd();
 }
 
 // _____________________________________________________________________________
-void OutputModule::onSimulationEnd() {
-  doSimulationEnd();
+void OutputModule::onSlotsSkipped(std::size_t firstSlot, std::size_t count,
+    const std::vector<NetworkState>& cycle) {
+  doSlotsSkipped(firstSlot, count, cycle);
+}
+
+// _____________________________________________________________________________
+void OutputModule::onSimulationEnd(std::size_t numSlots) {
+  doSimulationEnd(numSlots);
+}
+
+// _____________________________________________________________________________
+void OutputModule::onSimulationResume(std::size_t numSlots,
+    const NetworkSetup* setup, const NetworkTopology* topology,
+    std::size_t firstSlot) {
+  doSimulationResume(numSlots, setup, topology, firstSlot);
+}
+
+// _____________________________________________________________________________
+bool OutputModule::saveState(Core::CheckpointWriter* writer) {
+  return doSaveState(writer);
+}
+
+// _____________________________________________________________________________
+bool OutputModule::loadState(Core::CheckpointReader* reader) {
+  return doLoadState(reader);
 }
 
 
@@ -0,0 +1,242 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "anl/core/checkpoint.h"
+#include "anl/misc/asserts.h"
+#include "anl/misc/strings.h"
+#include "anl/output/output.h"
+
+// This file contains an output module.
+namespace Output {
+
+
+// _____________________________________________________________________________
+// The names of the component intention types, indexed by their value.
+static const char* const kIntentNames[] = {
+  "IDLE", "LISTEN", "SEND", "SEND_FORCE"
+};
+
+// _____________________________________________________________________________
+// The names of the component action types, indexed by their value.
+static const char* const kActionNames[] = {
+  "IDLE", "SILENCE", "COLLISION", "RECEIVED", "SENT", "CANCELLED"
+};
+
+// _____________________________________________________________________________
+RecordOutputModule::RecordOutputModule(Format format, Sink* sink)
+    : mFormat(format), mSink(sink != nullptr ? sink : Sink::getStdOut()),
+      mSetup(nullptr), mSlot(0), mIntent(nullptr) {}
+
+// _____________________________________________________________________________
+void RecordOutputModule::appendEscaped(std::string* target,
+    const std::string& str) const {
+  if (mFormat == Format::JSON_LINES) {
+    target->push_back('"');
+    for (char c : str) {
+      if (c == '"' || c == '\\') {
+        target->push_back('\\');
+        target->push_back(c);
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[8];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x",
+          static_cast<unsigned int>(c));
+        target->append(escaped);
+      } else {
+        target->push_back(c);
+      }
+    }
+    target->push_back('"');
+  } else {
+    // CSV fields are only quoted if necessary.
+    if (str.find_first_of(",\"\r\n") == std::string::npos) {
+      target->append(str);
+      return;
+    }
+    target->push_back('"');
+    for (char c : str) {
+      if (c == '"') {
+        target->push_back('"');
+      }
+      target->push_back(c);
+    }
+    target->push_back('"');
+  }
+}
+
+// _____________________________________________________________________________
+const std::string& RecordOutputModule::getMessageKey(
+    const Core::Message* msg) {
+  auto entry = mMessageKeys.find(msg);
+  if (entry != mMessageKeys.end()) {
+    return entry->second;
+  }
+  const std::string* str = mSetup->findMessageString(msg);
+  if (str == nullptr) {
+    mUncachedKey.clear();
+    appendEscaped(&mUncachedKey, msg->toString());
+    return mUncachedKey;
+  }
+  entry = mMessageKeys.emplace(msg, std::string()).first;
+  appendEscaped(&entry->second, *str);
+  return entry->second;
+}
+
+// _____________________________________________________________________________
+void RecordOutputModule::appendRecord(std::size_t comp,
+    const Core::ComponentIntention& intent,
+    const Core::ComponentAction& action) {
+  const char* intentName = kIntentNames[static_cast<int>(intent.getType())];
+  const char* actionName = kActionNames[static_cast<int>(action.getType())];
+  const Core::Message* msg = action.getMessage();
+
+  if (mFormat == Format::JSON_LINES) {
+    mBuffer.append("{\"component\":");
+    mBuffer.append(mComponentKeys[comp]);
+    mBuffer.append(",\"intent\":\"");
+    mBuffer.append(intentName);
+    mBuffer.append("\",\"action\":\"");
+    mBuffer.append(actionName);
+    mBuffer.append("\",\"tic\":");
+    if (msg != nullptr) {
+      Misc::Strings::appendNumber(&mBuffer, action.getTic());
+      mBuffer.append(",\"message\":");
+      mBuffer.append(getMessageKey(msg));
+    } else {
+      mBuffer.append("null,\"message\":null");
+    }
+    mBuffer.push_back('}');
+  } else {
+    Misc::Strings::appendNumber(&mBuffer, mSlot);
+    mBuffer.push_back(',');
+    mBuffer.append(mComponentKeys[comp]);
+    mBuffer.push_back(',');
+    mBuffer.append(intentName);
+    mBuffer.push_back(',');
+    mBuffer.append(actionName);
+    mBuffer.push_back(',');
+    if (msg != nullptr) {
+      Misc::Strings::appendNumber(&mBuffer, action.getTic());
+      mBuffer.push_back(',');
+      mBuffer.append(getMessageKey(msg));
+    } else {
+      mBuffer.push_back(',');
+    }
+    mBuffer.push_back('\n');
+  }
+}
+
+// _____________________________________________________________________________
+void RecordOutputModule::doSimulationBegin(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology) {
+  // The module is set up like for a resumed simulation.
+  doSimulationResume(numSlots, setup, topology, 0);
+  if (mFormat == Format::CSV) {
+    mSink->write(std::string("slot,component,intent,action,tic,message\n"));
+  }
+}
+
+// _____________________________________________________________________________
+void RecordOutputModule::doResultChosen(const Core::NetworkState& state) {
+  Misc::Asserts::require(mIntent != nullptr, "result chosen without intent");
+  mBuffer.clear();
+  if (mFormat == Format::JSON_LINES) {
+    mBuffer.append("{\"slot\":");
+    Misc::Strings::appendNumber(&mBuffer, mSlot);
+    mBuffer.append(",\"records\":[");
+  }
+
+  std::size_t comp = 0;
+  state.forEachTrait([this, &comp](const Core::Component* c,
+      const Core::ComponentAction& action) {
+    if (mFormat == Format::JSON_LINES && comp > 0) {
+      mBuffer.push_back(',');
+    }
+    appendRecord(comp, mIntent->getTraitFor(c), action);
+    comp++;
+  });
+
+  if (mFormat == Format::JSON_LINES) {
+    mBuffer.append("]}\n");
+  }
+  mSink->write(mBuffer);
+}
+
+// _____________________________________________________________________________
+void RecordOutputModule::doSlotsSkipped(std::size_t firstSlot,
+    std::size_t count, const std::vector<Core::NetworkState>& cycle) {
+  mBuffer.clear();
+  if (mFormat == Format::JSON_LINES) {
+    mBuffer.append("{\"slot\":");
+    Misc::Strings::appendNumber(&mBuffer, firstSlot);
+    mBuffer.append(",\"skipped\":");
+    Misc::Strings::appendNumber(&mBuffer, count);
+    mBuffer.append(",\"period\":");
+    Misc::Strings::appendNumber(&mBuffer, cycle.size());
+    mBuffer.append("}\n");
+  } else {
+    Misc::Strings::appendNumber(&mBuffer, firstSlot);
+    mBuffer.append(",,SKIPPED,SKIPPED,");
+    Misc::Strings::appendNumber(&mBuffer, count);
+    mBuffer.append(",\n");
+  }
+  mSink->write(mBuffer);
+}
+
+// _____________________________________________________________________________
+void RecordOutputModule::doSimulationResume(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology,
+    std::size_t firstSlot) {
+  mSetup = setup;
+  mIntent = nullptr;
+  mMessageKeys.clear();
+  mComponentKeys.clear();
+  mComponentKeys.reserve(setup->getComponentCount());
+  setup->forEachComponent([this](const Core::Component* comp) {
+    mComponentKeys.emplace_back();
+    appendEscaped(&mComponentKeys.back(), mSetup->getComponentId(comp));
+  });
+}
+
+// _____________________________________________________________________________
+bool RecordOutputModule::doSaveState(Core::CheckpointWriter* writer) {
+  mSink->flush();
+  writer->writeNumber(mSink->getPosition());
+  return true;
+}
+
+// _____________________________________________________________________________
+bool RecordOutputModule::doLoadState(Core::CheckpointReader* reader) {
+  std::uint64_t position = 0;
+  return reader->readNumber(&position) && mSink->resumeAt(position);
+}
+
+}  // namespace Output
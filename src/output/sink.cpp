@@ -0,0 +1,167 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include "anl/output/sink.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include "anl/misc/asserts.h"
+
+// This file contains the declaration of output sinks.
+namespace Output {
+
+
+// _____________________________________________________________________________
+const std::size_t Sink::kDefaultBufferSize;
+
+// _____________________________________________________________________________
+Sink::Sink(int fd, std::size_t bufferSize, bool sync, bool closeFd) : mFd(fd),
+    mBuffer(bufferSize), mUsed(0), mFlushed(0), mSync(sync),
+    mCloseFd(closeFd) {
+  Misc::Asserts::require(fd >= 0, "invalid file descriptor");
+}
+
+// _____________________________________________________________________________
+Sink::~Sink() {
+  flush();
+  if (mSync) {
+    ::fdatasync(mFd);
+  }
+  if (mCloseFd) {
+    ::close(mFd);
+  }
+}
+
+// _____________________________________________________________________________
+Sink* Sink::openFile(const std::string& path, std::size_t bufferSize,
+    bool sync, bool truncate) {
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | (truncate ? O_TRUNC : 0),
+    0644);
+  if (fd < 0) {
+    return nullptr;
+  }
+  return new Sink(fd, bufferSize, sync, true);
+}
+
+// _____________________________________________________________________________
+Sink* Sink::getStdOut() {
+  // Destroyed (and thus flushed) at program exit.
+  static Sink stdOut(STDOUT_FILENO);
+  return &stdOut;
+}
+
+// _____________________________________________________________________________
+void Sink::write(const char* data, std::size_t length) {
+  if (length > mBuffer.size() - mUsed) {
+    flush();
+  }
+  if (length >= mBuffer.size()) {
+    // Does not fit into the buffer at all, bypass it.
+    writeFd(data, length);
+    return;
+  }
+  std::memcpy(mBuffer.data() + mUsed, data, length);
+  mUsed += length;
+}
+
+// _____________________________________________________________________________
+void Sink::print(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+
+  // First, we attempt to format directly into the free part of the buffer.
+  std::size_t space = mBuffer.size() - mUsed;
+  va_list attempt;
+  va_copy(attempt, args);
+  int length = std::vsnprintf(space > 0 ? mBuffer.data() + mUsed : nullptr,
+    space, format, attempt);
+  va_end(attempt);
+  Misc::Asserts::require(length >= 0, "invalid format string");
+  std::size_t len = static_cast<std::size_t>(length);
+  if (len < space) {
+    // It fit (including the terminating zero that we do not count).
+    mUsed += len;
+    va_end(args);
+    return;
+  }
+
+  // It did not fit. We make room and format again.
+  flush();
+  if (len < mBuffer.size()) {
+    std::vsnprintf(mBuffer.data(), mBuffer.size(), format, args);
+    mUsed = len;
+  } else {
+    std::vector<char> tmp(len + 1);
+    std::vsnprintf(tmp.data(), tmp.size(), format, args);
+    writeFd(tmp.data(), len);
+  }
+  va_end(args);
+}
+
+// _____________________________________________________________________________
+void Sink::flush() {
+  writeFd(mBuffer.data(), mUsed);
+  mUsed = 0;
+}
+
+// _____________________________________________________________________________
+bool Sink::resumeAt(std::size_t position) {
+  flush();
+  struct stat status;
+  if (::fstat(mFd, &status) == 0 && S_ISREG(status.st_mode)) {
+    if (static_cast<std::size_t>(status.st_size) < position
+        || ::ftruncate(mFd, position) != 0
+        || ::lseek(mFd, position, SEEK_SET) < 0) {
+      return false;
+    }
+  }
+  mFlushed = position;
+  return true;
+}
+
+// _____________________________________________________________________________
+void Sink::writeFd(const char* data, std::size_t length) {
+  while (length > 0) {
+    ssize_t written = ::write(mFd, data, length);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    Misc::Asserts::require(written > 0, "could not write to output");
+    data += written;
+    length -= static_cast<std::size_t>(written);
+    mFlushed += static_cast<std::size_t>(written);
+  }
+}
+
+
+}  // namespace Output
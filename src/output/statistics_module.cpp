@@ -0,0 +1,301 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <cstdint>
+#include <vector>
+#include "anl/core/checkpoint.h"
+#include "anl/misc/asserts.h"
+#include "anl/output/output.h"
+
+// This file contains an output module.
+namespace Output {
+
+
+// _____________________________________________________________________________
+// The names of the component action types, indexed by their value.
+static const char* const kActionNames[] = {
+  "IDLE", "SILENCE", "COLLISION", "RECEIVED", "SENT", "CANCELLED"
+};
+
+// _____________________________________________________________________________
+const std::size_t StatisticsOutputModule::kNumActionTypes;
+
+// _____________________________________________________________________________
+static std::size_t indexOf(Core::ActionType type) {
+  return static_cast<std::size_t>(type);
+}
+
+// _____________________________________________________________________________
+StatisticsOutputModule::StatisticsOutputModule(Sink* sink,
+    std::size_t slotsPerSample)
+    : mSink(sink != nullptr ? sink : Sink::getStdOut()),
+      mSlotsPerSample(slotsPerSample), mSetup(nullptr), mSlotCount(0),
+      mSkippedCount(0), mSample(0) {}
+
+// _____________________________________________________________________________
+std::size_t StatisticsOutputModule::getTotal(Core::ActionType type) const {
+  std::size_t total = 0;
+  for (std::size_t i = indexOf(type); i < mComponentCounts.size();
+      i += kNumActionTypes) {
+    total += mComponentCounts[i];
+  }
+  return total;
+}
+
+// _____________________________________________________________________________
+std::size_t StatisticsOutputModule::getComponentCount(std::size_t comp,
+    Core::ActionType type) const {
+  Misc::Asserts::require(comp * kNumActionTypes < mComponentCounts.size(),
+    "invalid component index");
+  return mComponentCounts[comp * kNumActionTypes + indexOf(type)];
+}
+
+// _____________________________________________________________________________
+std::size_t StatisticsOutputModule::getSampleCount(std::size_t sample,
+    Core::ActionType type) const {
+  Misc::Asserts::require(sample < getSampleCount(), "invalid sample index");
+  return mSampleCounts[sample * kNumActionTypes + indexOf(type)];
+}
+
+// _____________________________________________________________________________
+std::size_t StatisticsOutputModule::getBusySlotCount(std::size_t sample)
+    const {
+  Misc::Asserts::require(sample < getSampleCount(), "invalid sample index");
+  return mBusySlots[sample];
+}
+
+// _____________________________________________________________________________
+void StatisticsOutputModule::doSimulationBegin(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology) {
+  mSetup = setup;
+  mSlotCount = 0;
+  mSkippedCount = 0;
+  mComponentCounts.assign(setup->getComponentCount() * kNumActionTypes, 0);
+  mSampleCounts.clear();
+  mBusySlots.clear();
+  if (mSlotsPerSample > 0) {
+    mSampleCounts.reserve(
+      (numSlots / mSlotsPerSample + 1) * kNumActionTypes);
+    mBusySlots.reserve(numSlots / mSlotsPerSample + 1);
+  }
+}
+
+// _____________________________________________________________________________
+void StatisticsOutputModule::doSlotBegin(std::size_t slotNumber) {
+  mSlotCount++;
+  if (mSlotsPerSample > 0) {
+    mSample = slotNumber / mSlotsPerSample;
+    if (mSampleCounts.size() < (mSample + 1) * kNumActionTypes) {
+      mSampleCounts.resize((mSample + 1) * kNumActionTypes, 0);
+      mBusySlots.resize(mSample + 1, 0);
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void StatisticsOutputModule::doResultChosen(const Core::NetworkState& state) {
+  std::size_t* compCounts = mComponentCounts.data();
+  std::size_t* sampleCounts = mSlotsPerSample > 0
+    ? mSampleCounts.data() + mSample * kNumActionTypes : nullptr;
+  bool busy = false;
+  state.forEachTrait([&compCounts, sampleCounts, &busy](
+      const Core::Component* comp, const Core::ComponentAction& action) {
+    std::size_t type = indexOf(action.getType());
+    compCounts[type]++;
+    compCounts += kNumActionTypes;
+    if (sampleCounts != nullptr) {
+      sampleCounts[type]++;
+    }
+    busy = busy || action.getType() == Core::ActionType::SENT;
+  });
+  if (sampleCounts != nullptr && busy) {
+    mBusySlots[mSample]++;
+  }
+}
+
+// _____________________________________________________________________________
+void StatisticsOutputModule::doSlotsSkipped(std::size_t firstSlot,
+    std::size_t count, const std::vector<Core::NetworkState>& cycle) {
+  // Every network state of the cycle is counted once, weighted by the number
+  //  of skipped slots it repeats in.
+  std::size_t period = cycle.size();
+  std::vector<std::size_t> stateCounts(period * kNumActionTypes, 0);
+  for (std::size_t pos = 0; pos < period; pos++) {
+    std::size_t repeats = count / period + (pos < count % period ? 1 : 0);
+    std::size_t* compCounts = mComponentCounts.data();
+    std::size_t* counts = stateCounts.data() + pos * kNumActionTypes;
+    cycle[pos].forEachTrait([&compCounts, counts, repeats](
+        const Core::Component* comp, const Core::ComponentAction& action) {
+      std::size_t type = indexOf(action.getType());
+      compCounts[type] += repeats;
+      compCounts += kNumActionTypes;
+      counts[type]++;
+    });
+  }
+  mSlotCount += count;
+  mSkippedCount += count;
+
+  // The time series still needs every slot, but only the counts per state.
+  if (mSlotsPerSample == 0) {
+    return;
+  }
+  for (std::size_t i = 0; i < count; i++) {
+    mSample = (firstSlot + i) / mSlotsPerSample;
+    if (mSampleCounts.size() < (mSample + 1) * kNumActionTypes) {
+      mSampleCounts.resize((mSample + 1) * kNumActionTypes, 0);
+      mBusySlots.resize(mSample + 1, 0);
+    }
+    const std::size_t* counts =
+      stateCounts.data() + (i % period) * kNumActionTypes;
+    for (std::size_t type = 0; type < kNumActionTypes; type++) {
+      mSampleCounts[mSample * kNumActionTypes + type] += counts[type];
+    }
+    if (counts[indexOf(Core::ActionType::SENT)] > 0) {
+      mBusySlots[mSample]++;
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void StatisticsOutputModule::doSimulationEnd(std::size_t numSlots) {
+  Misc::Asserts::require(mSetup != nullptr, "simulation has not begun");
+  mSink->print("# Statistics of %zu slots of %zu tics with %zu components.\n",
+    mSlotCount, mSetup->getTicsPerSlot(), mSetup->getComponentCount());
+  if (mSkippedCount > 0) {
+    mSink->print("# %zu of the slots were extrapolated from repeating "
+      "slots.\n", mSkippedCount);
+  }
+
+  // Totals.
+  mSink->print("\n# Totals.\n");
+  for (std::size_t type = 0; type < kNumActionTypes; type++) {
+    mSink->print("%-9s %zu\n", kActionNames[type],
+      getTotal(static_cast<Core::ActionType>(type)));
+  }
+
+  // Per-component table.
+  mSink->print("\n# Component actions per component.\n");
+  mSink->print("component");
+  for (std::size_t type = 0; type < kNumActionTypes; type++) {
+    mSink->print(" %s", kActionNames[type]);
+  }
+  mSink->print("\n");
+  std::size_t comp = 0;
+  mSetup->forEachComponent([this, &comp](const Core::Component* c) {
+    mSink->print("%s", mSetup->getComponentId(c).c_str());
+    for (std::size_t type = 0; type < kNumActionTypes; type++) {
+      mSink->print(" %zu", mComponentCounts[comp * kNumActionTypes + type]);
+    }
+    mSink->print("\n");
+    comp++;
+  });
+
+  // Time series.
+  if (mSlotsPerSample > 0) {
+    mSink->print("\n# Component actions per %zu slot(s).\n", mSlotsPerSample);
+    mSink->print("slot");
+    for (std::size_t type = 0; type < kNumActionTypes; type++) {
+      mSink->print(" %s", kActionNames[type]);
+    }
+    mSink->print(" BUSY\n");
+    for (std::size_t sample = 0; sample < getSampleCount(); sample++) {
+      mSink->print("%zu", sample * mSlotsPerSample);
+      for (std::size_t type = 0; type < kNumActionTypes; type++) {
+        mSink->print(" %zu", mSampleCounts[sample * kNumActionTypes + type]);
+      }
+      mSink->print(" %zu\n", mBusySlots[sample]);
+    }
+  }
+  mSink->flush();
+}
+
+// _____________________________________________________________________________
+void StatisticsOutputModule::doSimulationResume(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology,
+    std::size_t firstSlot) {
+  // The counters are restored by loadState.
+  mSetup = setup;
+}
+
+// _____________________________________________________________________________
+bool StatisticsOutputModule::doSaveState(Core::CheckpointWriter* writer) {
+  mSink->flush();
+  writer->writeNumber(mSink->getPosition());
+  writer->writeNumber(mSlotCount);
+  writer->writeNumber(mSkippedCount);
+  for (std::size_t count : mComponentCounts) {
+    writer->writeNumber(count);
+  }
+  writer->writeNumber(mSampleCounts.size());
+  for (std::size_t count : mSampleCounts) {
+    writer->writeNumber(count);
+  }
+  for (std::size_t count : mBusySlots) {
+    writer->writeNumber(count);
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+bool StatisticsOutputModule::doLoadState(Core::CheckpointReader* reader) {
+  std::uint64_t position = 0;
+  if (!reader->readNumber(&position) || !mSink->resumeAt(position)
+      || !reader->readValue(&mSlotCount)
+      || !reader->readValue(&mSkippedCount)) {
+    return false;
+  }
+  mComponentCounts.resize(mSetup->getComponentCount() * kNumActionTypes);
+  for (std::size_t& count : mComponentCounts) {
+    if (!reader->readValue(&count)) {
+      return false;
+    }
+  }
+  std::size_t sampleCount = 0;
+  if (!reader->readValue(&sampleCount)
+      || sampleCount % kNumActionTypes != 0) {
+    return false;
+  }
+  mSampleCounts.clear();
+  for (std::size_t i = 0; i < sampleCount; i++) {
+    std::size_t count = 0;
+    if (!reader->readValue(&count)) {
+      return false;
+    }
+    mSampleCounts.push_back(count);
+  }
+  mBusySlots.assign(sampleCount / kNumActionTypes, 0);
+  for (std::size_t& count : mBusySlots) {
+    if (!reader->readValue(&count)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace Output
@@ -27,58 +27,108 @@
 //
 // Part of ANL-Impl.
 
-#include <cstdio>
+#include <cstdint>
+#include "anl/core/checkpoint.h"
 #include "anl/output/output.h"
 
 // This file contains an output module.
 namespace Output {
 
 
+// _____________________________________________________________________________
+StdOutOutputModule::StdOutOutputModule(Sink* sink)
+    : mSink(sink != nullptr ? sink : Sink::getStdOut()), mIntendedSlots(0) {}
+
 // _____________________________________________________________________________
 void StdOutOutputModule::doSimulationBegin(std::size_t numSlots,
     const Core::NetworkSetup* setup, const Core::NetworkTopology* topology) {
-  std::printf("# Starting simulation with %zu slots `a %zu tics.\n", numSlots,
-    setup->getTicsPerSlot());
-  std::printf("# The following components will be used in the following "
-    "order:\n");
-  setup->forEachComponent([](const Core::Component* comp) {
-    std::printf("#  - %s\n", comp->getId().c_str());
+  mIntendedSlots = numSlots;
+  mSink->print("# Starting simulation with %zu slots `a %zu tics.\n",
+    numSlots, setup->getTicsPerSlot());
+  mSink->print("# The following components will be used in the "
+    "following order:\n");
+  setup->forEachComponent([this, setup](const Core::Component* comp) {
+    mSink->print("#  - %s\n", setup->getComponentId(comp).c_str());
   });
-  std::printf("\n");
+  mSink->print("\n");
 }
 
 // _____________________________________________________________________________
 void StdOutOutputModule::doSlotBegin(std::size_t slotNumber) {
-  std::printf("# Beginning simulation of slot %zu.\n", slotNumber);
+  mSink->print("# Beginning simulation of slot %zu.\n", slotNumber);
 }
 
 // _____________________________________________________________________________
 void StdOutOutputModule::doIntentChosen(
     const Core::IntentionAssignment& intent) {
-  std::printf("# Protocol executed. Chosen intentions:\n");
-  std::printf("%s\n", intent.toString().c_str());
+  mSink->print("# Protocol executed. Chosen intentions:\n");
+  mBuffer.clear();
+  intent.appendText(&mBuffer);
+  mBuffer.push_back('\n');
+  mSink->write(mBuffer);
 }
 
 // _____________________________________________________________________________
 void StdOutOutputModule::doTransitionComputed(
     const std::vector<Core::NetworkState>& outcomes) {
-  std::printf("# ANL returned %zu possible successor states.\n",
+  mSink->print("# ANL returned %zu possible successor states.\n",
     outcomes.size());
 }
 
 // _____________________________________________________________________________
 void StdOutOutputModule::doResultChosen(const Core::NetworkState& state) {
-  std::printf("# Result chosen from possible results.\n");
-  std::printf("%s\n", state.toString().c_str());
+  mSink->print("# Result chosen from possible results.\n");
+  mBuffer.clear();
+  state.appendText(&mBuffer);
+  mBuffer.push_back('\n');
+  mSink->write(mBuffer);
+}
+
+// _____________________________________________________________________________
+void StdOutOutputModule::doProtocolLog(const std::string& componentId,
+    const std::string& message) {
+  mSink->print("# Protocol log of %s: %s\n", componentId.c_str(),
+    message.c_str());
 }
 
 // _____________________________________________________________________________
 void StdOutOutputModule::doSlotEnd() {
-  std::printf("\n");
+  mSink->print("\n");
 }
 
 // _____________________________________________________________________________
-void StdOutOutputModule::doSimulationEnd() {}
+void StdOutOutputModule::doSlotsSkipped(std::size_t firstSlot,
+    std::size_t count, const std::vector<Core::NetworkState>& cycle) {
+  mSink->print("# Skipped %zu slots beginning with slot %zu, repeating the "
+    "previous %zu slot(s).\n\n", count, firstSlot, cycle.size());
+}
+
+// _____________________________________________________________________________
+void StdOutOutputModule::doSimulationEnd(std::size_t numSlots) {
+  if (numSlots != mIntendedSlots) {
+    mSink->print("# Simulation ended after %zu slots.\n", numSlots);
+  }
+  mSink->flush();
+}
 
+// _____________________________________________________________________________
+void StdOutOutputModule::doSimulationResume(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology,
+    std::size_t firstSlot) {
+  mIntendedSlots = numSlots;
+}
+
+// _____________________________________________________________________________
+bool StdOutOutputModule::doSaveState(Core::CheckpointWriter* writer) {
+  mSink->flush();
+  writer->writeNumber(mSink->getPosition());
+  return true;
+}
+
+// _____________________________________________________________________________
+bool StdOutOutputModule::doLoadState(Core::CheckpointReader* reader) {
+  std::uint64_t position = 0;
+  return reader->readNumber(&position) && mSink->resumeAt(position);
+}
 
 }  // namespace Output
@@ -0,0 +1,150 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <vector>
+#include "anl/core/checkpoint.h"
+#include "anl/misc/asserts.h"
+#include "anl/output/output.h"
+
+// This file contains an output module.
+namespace Output {
+
+
+// _____________________________________________________________________________
+TeeOutputModule::~TeeOutputModule() {
+  for (OutputModule* module : mModules) {
+    delete module;
+  }
+}
+
+// _____________________________________________________________________________
+void TeeOutputModule::addModule(OutputModule* module) {
+  Misc::Asserts::require(module != nullptr, "can not add nullptr as output "
+    "module");
+  Misc::Asserts::require(module != this, "can not add tee to itself");
+  mModules.push_back(module);
+}
+
+// _____________________________________________________________________________
+void TeeOutputModule::doSimulationBegin(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology) {
+  for (OutputModule* module : mModules) {
+    module->onSimulationBegin(numSlots, setup, topology);
+  }
+}
+
+// _____________________________________________________________________________
+void TeeOutputModule::doSlotBegin(std::size_t slotNumber) {
+  for (OutputModule* module : mModules) {
+    module->onSlotBegin(slotNumber);
+  }
+}
+
+// _____________________________________________________________________________
+void TeeOutputModule::doIntentChosen(const Core::IntentionAssignment& intent) {
+  for (OutputModule* module : mModules) {
+    module->onIntentChosen(intent);
+  }
+}
+
+// _____________________________________________________________________________
+void TeeOutputModule::doTransitionComputed(
+    const std::vector<Core::NetworkState>& outcomes) {
+  for (OutputModule* module : mModules) {
+    module->onTransitionComputed(outcomes);
+  }
+}
+
+// _____________________________________________________________________________
+void TeeOutputModule::doResultChosen(const Core::NetworkState& state) {
+  for (OutputModule* module : mModules) {
+    module->onResultChosen(state);
+  }
+}
+
+// _____________________________________________________________________________
+void TeeOutputModule::doProtocolLog(const std::string& componentId,
+    const std::string& message) {
+  for (OutputModule* module : mModules) {
+    module->onProtocolLog(componentId, message);
+  }
+}
+
+// _____________________________________________________________________________
+void TeeOutputModule::doSlotEnd() {
+  for (OutputModule* module : mModules) {
+    module->onSlotEnd();
+  }
+}
+
+// _____________________________________________________________________________
+void TeeOutputModule::doSlotsSkipped(std::size_t firstSlot,
+    std::size_t count, const std::vector<Core::NetworkState>& cycle) {
+  for (OutputModule* module : mModules) {
+    module->onSlotsSkipped(firstSlot, count, cycle);
+  }
+}
+
+// _____________________________________________________________________________
+void TeeOutputModule::doSimulationEnd(std::size_t numSlots) {
+  for (OutputModule* module : mModules) {
+    module->onSimulationEnd(numSlots);
+  }
+}
+
+// _____________________________________________________________________________
+void TeeOutputModule::doSimulationResume(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology,
+    std::size_t firstSlot) {
+  for (OutputModule* module : mModules) {
+    module->onSimulationResume(numSlots, setup, topology, firstSlot);
+  }
+}
+
+// _____________________________________________________________________________
+bool TeeOutputModule::doSaveState(Core::CheckpointWriter* writer) {
+  for (OutputModule* module : mModules) {
+    if (!module->saveState(writer)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+bool TeeOutputModule::doLoadState(Core::CheckpointReader* reader) {
+  for (OutputModule* module : mModules) {
+    if (!module->loadState(reader)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace Output
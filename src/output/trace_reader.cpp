@@ -0,0 +1,202 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include "anl/output/trace_reader.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include "anl/misc/asserts.h"
+#include "anl/output/output.h"
+
+// This file contains the implementation of the trace reader.
+namespace Output {
+
+
+// _____________________________________________________________________________
+TraceReader::TraceReader() : mTrace(nullptr), mTraceSize(0), mIndex(nullptr),
+    mIndexSize(0), mEntries(nullptr), mEntryCount(0), mEndOffset(0),
+    mSlotsPerEntry(1) {}
+
+// _____________________________________________________________________________
+TraceReader::~TraceReader() {
+  if (mTrace != nullptr) {
+    ::munmap(const_cast<char*>(mTrace), mTraceSize);
+  }
+  if (mIndex != nullptr) {
+    ::munmap(const_cast<char*>(mIndex), mIndexSize);
+  }
+}
+
+// _____________________________________________________________________________
+bool TraceReader::mapFile(const std::string& path, const char** data,
+    std::size_t* size) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    return false;
+  }
+  *size = static_cast<std::size_t>(info.st_size);
+  *data = nullptr;
+  if (*size > 0) {
+    void* mapped = ::mmap(nullptr, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      ::close(fd);
+      return false;
+    }
+    *data = static_cast<const char*>(mapped);
+  }
+  // The mapping stays valid after closing the file descriptor.
+  ::close(fd);
+  return true;
+}
+
+// _____________________________________________________________________________
+TraceReader* TraceReader::open(const std::string& tracePath,
+    const std::string& indexPath) {
+  TraceReader* reader = new TraceReader();
+  if (!mapFile(tracePath, &reader->mTrace, &reader->mTraceSize)
+      || !mapFile(indexPath, &reader->mIndex, &reader->mIndexSize)) {
+    delete reader;
+    return nullptr;
+  }
+
+  // Check the header and the entries. An index without end entry stems from
+  //  an aborted simulation, the last slot then ends at the end of the trace.
+  const std::size_t headerSize = sizeof(IndexOutputModule::kMagic)
+    + sizeof(std::uint64_t);
+  const std::size_t entrySize = 2 * sizeof(std::uint64_t);
+  if (reader->mIndexSize < headerSize
+      || (reader->mIndexSize - headerSize) % entrySize != 0
+      || std::memcmp(reader->mIndex, IndexOutputModule::kMagic,
+        sizeof(IndexOutputModule::kMagic)) != 0) {
+    delete reader;
+    return nullptr;
+  }
+  const std::uint64_t* words = reinterpret_cast<const std::uint64_t*>(
+    reader->mIndex + sizeof(IndexOutputModule::kMagic));
+  reader->mSlotsPerEntry = words[0];
+  reader->mEntries = words + 1;
+  reader->mEntryCount = (reader->mIndexSize - headerSize) / entrySize;
+  reader->mEndOffset = reader->mTraceSize;
+  if (reader->mEntryCount > 0 && reader->mEntries[
+      2 * (reader->mEntryCount - 1)] == IndexOutputModule::kEndSlot) {
+    reader->mEntryCount--;
+    reader->mEndOffset = reader->mEntries[2 * reader->mEntryCount + 1];
+  }
+
+  // Offsets must not point outside of the trace, and neither the slots nor the
+  //  offsets of the entries may decrease. Otherwise the index is truncated or
+  //  corrupt, or belongs to another trace.
+  bool valid = reader->mEndOffset <= reader->mTraceSize;
+  for (std::size_t entry = 1; entry <= reader->mEntryCount && valid; entry++) {
+    // The offset of the entry after the last one is the end offset.
+    valid = reader->getEntryOffset(entry - 1) <= reader->getEntryOffset(entry)
+      && (entry == reader->mEntryCount
+        || reader->getEntrySlot(entry - 1) <= reader->getEntrySlot(entry));
+  }
+  if (!valid) {
+    delete reader;
+    return nullptr;
+  }
+  return reader;
+}
+
+// _____________________________________________________________________________
+std::size_t TraceReader::getEntrySlot(std::size_t entry) const {
+  Misc::Asserts::require(entry < mEntryCount, "invalid index entry");
+  return mEntries[2 * entry];
+}
+
+// _____________________________________________________________________________
+std::size_t TraceReader::getEntryOffset(std::size_t entry) const {
+  return entry < mEntryCount
+    ? mEntries[2 * entry + 1] & ~IndexOutputModule::kRangeFlag : mEndOffset;
+}
+
+// _____________________________________________________________________________
+const char* TraceReader::findSlots(std::size_t first, std::size_t last,
+    std::size_t* length) const {
+  Misc::Asserts::require(first <= last, "empty slot range");
+  *length = 0;
+
+  // The entries are sorted by slot number. The range starts at the last entry
+  //  whose slot is not after first, and ends before the first entry whose slot
+  //  is after last.
+  std::size_t lo = 0;
+  std::size_t hi = mEntryCount;
+  while (lo < hi) {
+    std::size_t mid = lo + (hi - lo) / 2;
+    if (mEntries[2 * mid] <= first) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  std::size_t begin = lo > 0 ? lo - 1 : 0;
+  if (mSlotsPerEntry == 1 && begin < mEntryCount
+      && mEntries[2 * begin] < first
+      && (mEntries[2 * begin + 1] & IndexOutputModule::kRangeFlag) == 0) {
+    // Every entry is exactly one slot unless it covers skipped slots, the
+    //  entry does not contain first.
+    begin++;
+  }
+  hi = mEntryCount;
+  while (lo < hi) {
+    std::size_t mid = lo + (hi - lo) / 2;
+    if (mEntries[2 * mid] <= last) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  std::size_t end = lo;
+  if (begin >= end) {
+    return nullptr;
+  }
+
+  std::size_t beginOffset = getEntryOffset(begin);
+  std::size_t endOffset = getEntryOffset(end);
+  Misc::Asserts::require(beginOffset <= endOffset && endOffset <= mTraceSize,
+    "corrupt trace index");
+  if (beginOffset == endOffset) {
+    return nullptr;
+  }
+  *length = endOffset - beginOffset;
+  return mTrace + beginOffset;
+}
+
+
+}  // namespace Output
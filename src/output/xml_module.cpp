@@ -27,100 +27,148 @@
 //
 // Part of ANL-Impl.
 
-#include <cstdio>
+#include <cstdint>
 #include <string>
 #include <vector>
+#include "anl/core/checkpoint.h"
+#include "anl/misc/strings.h"
 #include "anl/output/output.h"
 
 // This file contains an output module.
 namespace Output {
 
 
+// _____________________________________________________________________________
+XMLOutputModule::XMLOutputModule(Sink* sink)
+    : mSink(sink != nullptr ? sink : Sink::getStdOut()), mIntendedSlots(0) {}
+
 // _____________________________________________________________________________
 void XMLOutputModule::doSimulationBegin(std::size_t numSlots,
     const Core::NetworkSetup* setup, const Core::NetworkTopology* topology) {
-  std::printf("<?xml version=\"1.0\" encoding=\"ascii\"?>\n");
-  std::printf("<simulation>\n");
-  std::printf("  <slotcount>%zu</slotcount>\n", numSlots);
-  std::printf("  <ticsperslot>%zu</ticsperslot>\n", setup->getTicsPerSlot());
-
-  std::printf("  <components>\n");
-  setup->forEachComponent([](const Core::Component* comp) {
-    std::printf("    <component id=\"%s\">\n", comp->getId().c_str());
-    std::vector<std::string> xmlRepr = comp->toXML();
-    for (const std::string& rpr : xmlRepr) {
-      std::printf("        %s\n", rpr.c_str());
+  mIntendedSlots = numSlots;
+  mSink->print("<?xml version=\"1.0\" encoding=\"ascii\"?>\n");
+  mSink->print("<simulation>\n");
+  mSink->print("  <slotcount>%zu</slotcount>\n", numSlots);
+  mSink->print("  <ticsperslot>%zu</ticsperslot>\n",
+    setup->getTicsPerSlot());
+
+  mSink->print("  <components>\n");
+  setup->forEachComponent([this, setup](const Core::Component* comp) {
+    mSink->print("    <component id=\"%s\">\n",
+      setup->getComponentId(comp).c_str());
+    for (const std::string& rpr : setup->getComponentXML(comp)) {
+      mSink->print("        %s\n", rpr.c_str());
     }
-    std::printf("    </component>\n");
+    mSink->print("    </component>\n");
   });
-  std::printf("  </components>\n");
-
-  std::printf("  <topology>\n");
-  setup->forEachComponent([setup, topology](const Core::Component* sndr) {
-    setup->forEachComponent([topology, sndr](const Core::Component* rcvr) {
-      if (topology->canReach(sndr, rcvr)) {
-        std::printf("    <edge>\n");
-        std::printf("      <from>%s</from>\n", sndr->getId().c_str());
-        std::printf("      <to>%s</to>\n", rcvr->getId().c_str());
-        std::printf("    </edge>\n");
-      }
+  mSink->print("  </components>\n");
+
+  mSink->print("  <topology>\n");
+  setup->forEachComponent([this, setup, topology](const Core::Component* sndr) {
+    const std::string& sndrId = setup->getComponentId(sndr);
+    topology->forEachReachable(*setup, sndr,
+        [this, setup, &sndrId](const Core::Component* rcvr) {
+      mSink->print("    <edge>\n");
+      mSink->print("      <from>%s</from>\n", sndrId.c_str());
+      mSink->print("      <to>%s</to>\n",
+        setup->getComponentId(rcvr).c_str());
+      mSink->print("    </edge>\n");
     });
   });
-  std::printf("  </topology>\n");
-  std::printf("  <execution>\n");
+  mSink->print("  </topology>\n");
+  mSink->print("  <execution>\n");
 }
 
 // _____________________________________________________________________________
 void XMLOutputModule::doSlotBegin(std::size_t slotNumber) {
-  std::printf("    <slot num=\"%zu\">\n", slotNumber);
+  mSink->print("    <slot num=\"%zu\">\n", slotNumber);
 }
 
 // _____________________________________________________________________________
 void XMLOutputModule::doIntentChosen(
     const Core::IntentionAssignment& intent) {
-  std::printf("      <intention>\n");
-  std::vector<std::string> xmlRepr = intent.toXML();
-  for (const std::string& rpr : xmlRepr) {
-    std::printf("        %s\n", rpr.c_str());
-  }
-  std::printf("      </intention>\n");
+  mSink->print("      <intention>\n");
+  mBuffer.clear();
+  intent.appendXML(&mBuffer, 8);
+  mSink->write(mBuffer);
+  mSink->print("      </intention>\n");
 }
 
 // _____________________________________________________________________________
 void XMLOutputModule::doTransitionComputed(
     const std::vector<Core::NetworkState>& outcomes) {
-  std::printf("      <choices>\n");
+  mSink->print("      <choices>\n");
   for (const Core::NetworkState& state : outcomes) {
-    std::printf("        <choice>\n");
-    std::vector<std::string> xmlRepr = state.toXML();
-    for (const std::string& rpr : xmlRepr) {
-      std::printf("          %s\n", rpr.c_str());
-    }
-    std::printf("        </choice>\n");
+    mSink->print("        <choice>\n");
+    mBuffer.clear();
+    state.appendXML(&mBuffer, 10);
+    mSink->write(mBuffer);
+    mSink->print("        </choice>\n");
   }
-  std::printf("      </choices>\n");
+  mSink->print("      </choices>\n");
 }
 
 // _____________________________________________________________________________
 void XMLOutputModule::doResultChosen(const Core::NetworkState& state) {
-  std::printf("      <result>\n");
-  std::vector<std::string> xmlRepr = state.toXML();
-  for (const std::string& rpr : xmlRepr) {
-    std::printf("        %s\n", rpr.c_str());
-  }
-  std::printf("      </result>\n");
+  mSink->print("      <result>\n");
+  mBuffer.clear();
+  state.appendXML(&mBuffer, 8);
+  mSink->write(mBuffer);
+  mSink->print("      </result>\n");
+}
+
+// _____________________________________________________________________________
+void XMLOutputModule::doProtocolLog(const std::string& componentId,
+    const std::string& message) {
+  mBuffer.assign("      <log component=\"");
+  Misc::Strings::appendEscapedXML(&mBuffer, componentId);
+  mBuffer.append("\">");
+  Misc::Strings::appendEscapedXML(&mBuffer, message);
+  mBuffer.append("</log>\n");
+  mSink->write(mBuffer);
 }
 
 // _____________________________________________________________________________
 void XMLOutputModule::doSlotEnd() {
-  std::printf("    </slot>\n");
+  mSink->print("    </slot>\n");
+}
+
+// _____________________________________________________________________________
+void XMLOutputModule::doSlotsSkipped(std::size_t firstSlot,
+    std::size_t count, const std::vector<Core::NetworkState>& cycle) {
+  mSink->print("    <skipped first=\"%zu\" count=\"%zu\" period=\"%zu\"/>\n",
+    firstSlot, count, cycle.size());
+}
+
+// _____________________________________________________________________________
+void XMLOutputModule::doSimulationEnd(std::size_t numSlots) {
+  mSink->print("  </execution>\n");
+  if (numSlots != mIntendedSlots) {
+    // The slot count at the beginning was only the intended one.
+    mSink->print("  <simulatedslots>%zu</simulatedslots>\n", numSlots);
+  }
+  mSink->print("</simulation>\n");
+  mSink->flush();
 }
 
 // _____________________________________________________________________________
-void XMLOutputModule::doSimulationEnd() {
-  std::printf("  </execution>\n");
-  std::printf("</simulation>\n");
+void XMLOutputModule::doSimulationResume(std::size_t numSlots,
+    const Core::NetworkSetup* setup, const Core::NetworkTopology* topology,
+    std::size_t firstSlot) {
+  mIntendedSlots = numSlots;
 }
 
+// _____________________________________________________________________________
+bool XMLOutputModule::doSaveState(Core::CheckpointWriter* writer) {
+  mSink->flush();
+  writer->writeNumber(mSink->getPosition());
+  return true;
+}
+
+// _____________________________________________________________________________
+bool XMLOutputModule::doLoadState(Core::CheckpointReader* reader) {
+  std::uint64_t position = 0;
+  return reader->readNumber(&position) && mSink->resumeAt(position);
+}
 
 }  // namespace Output
@@ -29,6 +29,10 @@
 
 #include <gtest/gtest.h>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
 #include "anl/core/anl.h"
 #include "anl/core/anl_algorithm.h"
 #include "anl/core/topologies.h"
@@ -51,6 +55,22 @@ class ExampleNetworkTopology final : public NetworkTopology {
         || (sndr == mScnd && rcvr == mThrd); };
 };
 
+// A topology with explicit edges that counts the calls of canReach and the
+//  enumerations of reachable components.
+class CountingNetworkTopology final : public ExplicitNetworkTopology {
+ public:
+  mutable std::size_t mCalls = 0;
+  mutable std::size_t mEnumerations = 0;
+ private:
+  bool doCanReach(const Component* sndr, const Component* rcvr) const override
+    { mCalls++; return ExplicitNetworkTopology::doCanReach(sndr, rcvr); }
+  void doForEachReachable(const NetworkSetup& setup, const Component* sndr,
+      std::function<void(const Component*)> cb) const override {
+    mEnumerations++;
+    ExplicitNetworkTopology::doForEachReachable(setup, sndr, cb);
+  }
+};
+
 // _____________________________________________________________________________
 TEST(SenderSetComputerDeathTest, noSetup) {
   // Scenario: setup is nullptr fails.
@@ -1147,3 +1167,242 @@ TEST(ANLComputerTest, threeSendersMotivationalExample) {
   ASSERT_EQ(&msg, resultNaive[0].getTraitFor(&c2).getMessage());
   ASSERT_EQ(&msg, resultNaive[0].getTraitFor(&c3).getMessage());
 }
+
+// _____________________________________________________________________________
+TEST(ANLComputerTest, enumeratesReachable) {
+  // Scenario: A sends in tic 0 and reaches B, which intends to send in tic 1,
+  //  and the listener L. C sends in tic 2 and reaches L as well.
+  // Why: carrier sensing and the receptions are collected from the components
+  //  each sender can reach, without probing canReach, and the receptions
+  //  keep the registration order of the senders.
+  NetworkSetup setup(20);
+  Component compA, compB, compC, compL;
+  Message msgA, msgC;
+  setup.registerComponent(&compA);
+  setup.registerComponent(&compB);
+  setup.registerComponent(&compC);
+  setup.registerComponent(&compL);
+  setup.registerMessage(&msgA);
+  setup.registerMessage(&msgC);
+  CountingNetworkTopology topo;
+  topo.addEdge(&compA, &compB);
+  topo.addEdge(&compC, &compL);
+  topo.addEdge(&compA, &compL);
+
+  IntentionAssignment intent(&setup);
+  intent.setTraitFor(&compA,
+    ComponentIntention(setup, IntentionType::SEND, 0, &msgA));
+  intent.setTraitFor(&compB,
+    ComponentIntention(setup, IntentionType::SEND, 1, &msgA));
+  intent.setTraitFor(&compC,
+    ComponentIntention(setup, IntentionType::SEND, 2, &msgC));
+  intent.setTraitFor(&compL,
+    ComponentIntention(setup, IntentionType::LISTEN, 0, nullptr));
+
+  ANLComputer computer(&setup, &topo, &intent, ANLFilterNothing);
+  std::vector<NetworkState> result = computer.transition();
+  ASSERT_EQ(3, result.size());
+  ASSERT_EQ(ActionType::SENT, result[0].getTraitFor(&compA).getType());
+  ASSERT_EQ(ActionType::CANCELLED, result[0].getTraitFor(&compB).getType());
+  ASSERT_EQ(ActionType::SENT, result[0].getTraitFor(&compC).getType());
+  ASSERT_EQ(&msgA, result[0].getTraitFor(&compL).getMessage());
+  ASSERT_EQ(ActionType::COLLISION, result[1].getTraitFor(&compL).getType());
+  ASSERT_EQ(&msgC, result[2].getTraitFor(&compL).getMessage());
+  ASSERT_EQ(0, topo.mCalls);
+}
+
+// _____________________________________________________________________________
+TEST(IncrementalANLComputerTest, matchesFullTransition) {
+  // Scenario: a random topology of twelve components, in which a few random
+  //  components change their intention in every slot. Every incremental
+  //  transition is compared against a transition from scratch.
+  // Why: carrier sensing lets changes cascade through the sender set, random
+  //  changes cover senders appearing, disappearing and moving between tics.
+  const std::size_t kComps = 12;
+  NetworkSetup setup(4);
+  Component comps[kComps];
+  Message msgs[3];
+  for (std::size_t i = 0; i < kComps; i++) {
+    setup.registerComponent(&comps[i]);
+  }
+  for (std::size_t i = 0; i < 3; i++) {
+    setup.registerMessage(&msgs[i]);
+  }
+
+  std::mt19937 random(42);
+  ExplicitNetworkTopology topo;
+  for (std::size_t i = 0; i < kComps; i++) {
+    for (std::size_t j = 0; j < kComps; j++) {
+      if (i != j && random() % 4 == 0) {
+        topo.addEdge(&comps[i], &comps[j]);
+      }
+    }
+  }
+
+  // Creates a random intention.
+  auto randomIntention = [&setup, &msgs, &random]() {
+    std::size_t tic = random() % 4;
+    const Message* msg = &msgs[random() % 3];
+    switch (random() % 4) {
+      case 0: return ComponentIntention(setup, IntentionType::IDLE, 0, nullptr);
+      case 1: return ComponentIntention(setup, IntentionType::LISTEN, 0,
+        nullptr);
+      case 2: return ComponentIntention(setup, IntentionType::SEND, tic, msg);
+      default: return ComponentIntention(setup, IntentionType::SEND_FORCE, tic,
+        msg);
+    }
+  };
+
+  std::vector<ComponentIntention> current;
+  for (std::size_t i = 0; i < kComps; i++) {
+    current.push_back(randomIntention());
+  }
+
+  IncrementalANLComputer incremental(&setup, ANLFilterNaive);
+  for (int slot = 0; slot < 300; slot++) {
+    std::size_t changes = random() % 3;
+    for (std::size_t c = 0; c < changes; c++) {
+      current[random() % kComps] = randomIntention();
+    }
+    IntentionAssignment intent(&setup);
+    for (std::size_t i = 0; i < kComps; i++) {
+      intent.setTraitFor(&comps[i], current[i]);
+    }
+
+    ANLComputer full(&setup, &topo, &intent, ANLFilterNaive);
+    std::vector<NetworkState> expected = full.transition();
+    ASSERT_EQ(1, expected.size());
+    ASSERT_EQ(expected[0].toString(),
+      incremental.transition(&topo, &intent).toString());
+    if (changes == 0 && slot > 0) {
+      ASSERT_EQ(0, incremental.getRecomputedCount());
+    }
+  }
+}
+
+// _____________________________________________________________________________
+TEST(IncrementalANLComputerTest, recomputesOnlyAffected) {
+  // Scenario: in the chain X -> Y -> Z, Y and Z listen while X idles. Then Z
+  //  starts to idle, and finally X starts to send.
+  // Why: an unchanged slot recomputes nothing, a changed listener only itself,
+  //  and a new sender itself and its neighbor, but not Z.
+  NetworkSetup setup(20);
+  Component compX;
+  Component compY;
+  Component compZ;
+  Message msg;
+  setup.registerComponent(&compX);
+  setup.registerComponent(&compY);
+  setup.registerComponent(&compZ);
+  setup.registerMessage(&msg);
+  ExampleNetworkTopology topo(&compX, &compY, &compZ);
+  ComponentIntention idle(setup, IntentionType::IDLE, 0, nullptr);
+  ComponentIntention listen(setup, IntentionType::LISTEN, 0, nullptr);
+  ComponentIntention send(setup, IntentionType::SEND, 3, &msg);
+
+  IncrementalANLComputer incremental(&setup, ANLFilterNaive);
+  IntentionAssignment first(&setup);
+  first.setTraitFor(&compX, idle);
+  first.setTraitFor(&compY, listen);
+  first.setTraitFor(&compZ, listen);
+  incremental.transition(&topo, &first);
+  ASSERT_EQ(3, incremental.getRecomputedCount());
+  incremental.transition(&topo, &first);
+  ASSERT_EQ(0, incremental.getRecomputedCount());
+
+  IntentionAssignment second(&setup);
+  second.setTraitFor(&compX, idle);
+  second.setTraitFor(&compY, listen);
+  second.setTraitFor(&compZ, idle);
+  ASSERT_EQ("(IDL, SIL, IDL)",
+    incremental.transition(&topo, &second).toString());
+  ASSERT_EQ(1, incremental.getRecomputedCount());
+
+  IntentionAssignment third(&setup);
+  third.setTraitFor(&compX, send);
+  third.setTraitFor(&compY, listen);
+  third.setTraitFor(&compZ, idle);
+  ASSERT_EQ("(SENT[Message, 3], RCVD[Message, 3], IDL)",
+    incremental.transition(&topo, &third).toString());
+  ASSERT_EQ(2, incremental.getRecomputedCount());
+}
+
+// _____________________________________________________________________________
+TEST(IncrementalANLComputerTest, carrierSensingFromChangedTic) {
+  // Scenario: A, B and C send in tics 0, 1 and 2 to the listener L. Then C
+  //  moves to tic 3.
+  // Why: carrier sensing is only decided again for C, from its count of heard
+  //  senders, and only the components reachable by C are enumerated. Nothing
+  //  is probed with canReach.
+  NetworkSetup setup(20);
+  Component comps[4];
+  Message msg;
+  for (Component& comp : comps) {
+    setup.registerComponent(&comp);
+  }
+  setup.registerMessage(&msg);
+  CountingNetworkTopology topo;
+  for (int i = 0; i < 3; i++) {
+    topo.addEdge(&comps[i], &comps[3]);
+  }
+  IntentionAssignment intent(&setup);
+  for (int i = 0; i < 3; i++) {
+    intent.setTraitFor(&comps[i],
+      ComponentIntention(setup, IntentionType::SEND, i, &msg));
+  }
+  intent.setTraitFor(&comps[3],
+    ComponentIntention(setup, IntentionType::LISTEN, 0, nullptr));
+
+  IncrementalANLComputer incremental(&setup, ANLFilterNaive);
+  incremental.transition(&topo, &intent);
+  topo.mCalls = 0;
+  topo.mEnumerations = 0;
+  intent.replaceTraitFor(&comps[2],
+    ComponentIntention(setup, IntentionType::SEND, 3, &msg));
+  ASSERT_EQ("(SENT[Message, 0], SENT[Message, 1], SENT[Message, 3], COL)",
+    incremental.transition(&topo, &intent).toString());
+  ASSERT_EQ(0, topo.mCalls);
+  ASSERT_EQ(1, topo.mEnumerations);
+  ASSERT_EQ(2, incremental.getRecomputedCount());
+}
+
+// _____________________________________________________________________________
+TEST(IncrementalANLComputerTest, changedTopology) {
+  // Scenario: X sends and Y listens without an edge between them. Then the
+  //  edge X -> Y is added to the same topology object, and the same intention
+  //  assignment is transitioned again.
+  // Why: changes of the topology between slots must not be patched against
+  //  the previous reachability.
+  NetworkSetup setup(20);
+  Component compX;
+  Component compY;
+  Message msg;
+  setup.registerComponent(&compX);
+  setup.registerComponent(&compY);
+  setup.registerMessage(&msg);
+  ExplicitNetworkTopology topo;
+  IntentionAssignment intent(&setup);
+  intent.setTraitFor(&compX,
+    ComponentIntention(setup, IntentionType::SEND, 3, &msg));
+  intent.setTraitFor(&compY,
+    ComponentIntention(setup, IntentionType::LISTEN, 0, nullptr));
+
+  IncrementalANLComputer incremental(&setup, ANLFilterNaive);
+  ASSERT_EQ("(SENT[Message, 3], SIL)",
+    incremental.transition(&topo, &intent).toString());
+  std::uint64_t generation = topo.getGeneration();
+  topo.addEdge(&compX, &compY);
+  ASSERT_NE(generation, topo.getGeneration());
+  ASSERT_EQ("(SENT[Message, 3], RCVD[Message, 3])",
+    incremental.transition(&topo, &intent).toString());
+  ASSERT_EQ(2, incremental.getRecomputedCount());
+}
+
+// _____________________________________________________________________________
+TEST(IncrementalANLComputerDeathTest, canonicalSemanticsFails) {
+  // Scenario: incremental transitions are requested for canonical semantics.
+  // Why: the canonical semantics is not deterministic.
+  NetworkSetup setup(20);
+  ANL anl(&setup, ANLSemantics::CANONICAL);
+  ASSERT_DEATH(anl.useIncrementalTransitions(true), "deterministic");
+}
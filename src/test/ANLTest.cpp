@@ -32,7 +32,10 @@
 #include <string>
 #include <vector>
 #include "anl/core/anl.h"
+#include "anl/core/message_interner.h"
+#include "anl/core/message_pool.h"
 #include "anl/core/statemachine.h"
+#include "anl/misc/strings.h"
 
 // We do this here as a test can under no circumstance pollute the namespace as
 // it is never included.
@@ -61,6 +64,44 @@ TEST(MessageTest, toXML) {
   ASSERT_EQ(0, m2.toXML().size());
 }
 
+// _____________________________________________________________________________
+TEST(MessageTest, appendTextAndXML) {
+  // Scenario: we append the representations of a message that only overrides
+  //  the old methods and of one that only overrides the append methods.
+  // Why: both kinds of messages must work with both kinds of methods.
+
+  // Message types for this test.
+  class OldMessage : public Message {
+   private:
+    std::string doToString() const override { return "old"; }
+    std::vector<std::string> doToXML() const override
+      { return { "<a>", "</a>" }; }
+  };
+  class NewMessage : public Message {
+   private:
+    void doAppendText(std::string* buffer) const override
+      { buffer->append("new"); }
+    void doAppendXML(std::string* buffer, std::size_t indent) const override
+      { buffer->append(indent, ' '); buffer->append("<b/>\n"); }
+  };
+
+  OldMessage m1;
+  NewMessage m2;
+  std::string buffer("x");
+  m1.appendText(&buffer);
+  m2.appendText(&buffer);
+  ASSERT_EQ("xoldnew", buffer);
+
+  buffer.clear();
+  m1.appendXML(&buffer, 2);
+  m2.appendXML(&buffer, 1);
+  ASSERT_EQ("  <a>\n  </a>\n <b/>\n", buffer);
+
+  ASSERT_EQ("new", m2.toString());
+  std::vector<std::string> expected = { "<b/>" };
+  ASSERT_EQ(expected, m2.toXML());
+}
+
 // _____________________________________________________________________________
 TEST(ComponentTest, getId) {
   // Scenario: we obtain the textual representation of two distinct components.
@@ -84,6 +125,44 @@ TEST(ComponentTest, toXML) {
   ASSERT_EQ(0, comp2.toXML().size());
 }
 
+// _____________________________________________________________________________
+TEST(ComponentTest, appendIdAndXML) {
+  // Scenario: we append the ID and XML representation of a component that
+  //  only overrides the old methods and of one that only overrides the append
+  //  methods.
+  // Why: both kinds of components must work with both kinds of methods.
+
+  // Component types for this test.
+  class OldComponent : public Component {
+   private:
+    std::string doGetId() const override { return "old"; }
+    std::vector<std::string> doToXML() const override { return { "<a/>" }; }
+  };
+  class NewComponent : public Component {
+   private:
+    void doAppendId(std::string* buffer) const override
+      { buffer->append("new"); }
+    void doAppendXML(std::string* buffer, std::size_t indent) const override
+      { buffer->append(indent, ' '); buffer->append("<b/>\n"); }
+  };
+
+  OldComponent comp1;
+  NewComponent comp2;
+  std::string buffer;
+  comp1.appendId(&buffer);
+  comp2.appendId(&buffer);
+  ASSERT_EQ("oldnew", buffer);
+
+  buffer.clear();
+  comp1.appendXML(&buffer, 1);
+  comp2.appendXML(&buffer, 0);
+  ASSERT_EQ(" <a/>\n<b/>\n", buffer);
+
+  ASSERT_EQ("new", comp2.getId());
+  std::vector<std::string> expected = { "<b/>" };
+  ASSERT_EQ(expected, comp2.toXML());
+}
+
 // _____________________________________________________________________________
 TEST(ComponentActionDeathTest, tooBigTicFails) {
   // Scenario: supplying a too big tic fails. we test tics 5..25.
@@ -200,6 +279,53 @@ TEST(ComponentActionTest, toXML) {
   ASSERT_EQ("</trait>", r6[5]);
 }
 
+// _____________________________________________________________________________
+TEST(ComponentActionTest, appendTextAndXML) {
+  // Scenario: we append a component action with a registered message, and one
+  //  with an unregistered message, to a buffer that already has content.
+  // Why: the append methods must not clear the buffer and must produce the
+  //  same representations as toString and toXML, indented as requested.
+  NetworkSetup setup(20);
+
+  // Message type for this test.
+  class TestMessage : public Message {
+   private:
+    std::string doToString() const override { return "m"; }
+    std::vector<std::string> doToXML() const override { return { "<m/>" }; }
+  };
+  TestMessage msg1;
+  TestMessage msg2;
+  setup.registerMessage(&msg1);
+
+  ComponentAction act1(setup, ActionType::SENT, 12, &msg1);
+  ComponentAction act2(setup, ActionType::RECEIVED, 0, &msg2);
+  std::string buffer("> ");
+  act1.appendText(&buffer, &setup);
+  act2.appendText(&buffer, &setup);
+  ASSERT_EQ("> SENT[m, 12]RCVD[m, 0]", buffer);
+  ASSERT_EQ("SENT[m, 12]", act1.toString());
+
+  buffer = "> ";
+  act1.appendXML(&buffer, 3, &setup);
+  ASSERT_EQ("> "
+    "   <trait>\n"
+    "     <type>SENT</type>\n"
+    "     <msg>\n"
+    "       <m/>\n"
+    "     </msg>\n"
+    "     <tic>12</tic>\n"
+    "   </trait>\n", buffer);
+
+  buffer.clear();
+  act2.appendXML(&buffer, 0, &setup);
+  std::vector<std::string> expected = {
+    "<trait>", "  <type>RCVD</type>", "  <msg>", "    <m/>", "  </msg>",
+    "  <tic>0</tic>", "</trait>"
+  };
+  ASSERT_EQ(expected, act2.toXML());
+  ASSERT_EQ(expected.size(), Misc::Strings::splitLines(buffer).size());
+}
+
 // _____________________________________________________________________________
 TEST(ComponentActionTest, operatorEqTest) {
   // Scenario: we test the equality operator for component actions using four
@@ -590,6 +716,57 @@ TEST(NetworkSetupTest, registerComponent) {
   }
 }
 
+// _____________________________________________________________________________
+TEST(NetworkSetupTest, getComponentIndex) {
+  // Scenario: we check the indices of three registered components.
+  // Why: indices follow the registration order, not the memory order.
+  NetworkSetup setup(20);
+  Component comps[3];
+  setup.registerComponent(&comps[1]);
+  setup.registerComponent(&comps[0]);
+  setup.registerComponent(&comps[2]);
+
+  ASSERT_EQ(1, setup.getComponentIndex(&comps[0]));
+  ASSERT_EQ(0, setup.getComponentIndex(&comps[1]));
+  ASSERT_EQ(2, setup.getComponentIndex(&comps[2]));
+}
+
+// _____________________________________________________________________________
+TEST(NetworkSetupDeathTest, getComponentIndexOfUnknownFails) {
+  // Scenario: getting the index of an unregistered component fails.
+  // Why: abnormal exit point of method.
+  NetworkSetup setup(20);
+  Component comp;
+  ASSERT_DEATH(setup.getComponentIndex(&comp), "component not registered");
+}
+
+// _____________________________________________________________________________
+TEST(NetworkSetupTest, getComponentIdAndXML) {
+  // Scenario: we register a component with a custom ID and XML representation
+  //  and a default component, and check the cached values.
+  // Why: regular case and default case.
+
+  // Component type for this test.
+  class TestComponent : public Component {
+   private:
+    std::string doGetId() const override { return "test"; }
+    std::vector<std::string> doToXML() const override
+      { return std::vector<std::string>(1, "<x/>"); }
+  };
+
+  NetworkSetup setup(20);
+  TestComponent comp1;
+  Component comp2;
+  setup.registerComponent(&comp1);
+  setup.registerComponent(&comp2);
+
+  ASSERT_EQ("test", setup.getComponentId(&comp1));
+  ASSERT_EQ("default", setup.getComponentId(&comp2));
+  ASSERT_EQ(1, setup.getComponentXML(&comp1).size());
+  ASSERT_EQ("<x/>", setup.getComponentXML(&comp1)[0]);
+  ASSERT_EQ(0, setup.getComponentXML(&comp2).size());
+}
+
 // _____________________________________________________________________________
 TEST(NetworkSetupTest, isMessage) {
   // See isComponent-test. This is analoguous, but with messages.
@@ -607,6 +784,66 @@ TEST(NetworkSetupTest, isMessage) {
   ASSERT_TRUE(setup.isMessage(&msgB));
 }
 
+// _____________________________________________________________________________
+TEST(NetworkSetupTest, getMessageStringAndXML) {
+  // Scenario: we fetch the representations of a registered message several
+  //  times, also through component traits, and count the renderings.
+  // Why: the representations are rendered once and cached afterwards.
+
+  // Message type for this test, counting its renderings.
+  class CountingMessage : public Message {
+   public:
+    mutable int mStrings = 0;
+    mutable int mXMLs = 0;
+
+   private:
+    std::string doToString() const override { mStrings++; return "cnt"; }
+    std::vector<std::string> doToXML() const override
+      { mXMLs++; return std::vector<std::string>(1, "<cnt/>"); }
+  };
+
+  NetworkSetup setup(20);
+  CountingMessage msg;
+  setup.registerMessage(&msg);
+  ASSERT_EQ(0, msg.mStrings);
+  ASSERT_EQ(0, msg.mXMLs);
+
+  ComponentAction action(setup, ActionType::SENT, 3, &msg);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ("cnt", setup.getMessageString(&msg));
+    ASSERT_EQ("cnt", *setup.findMessageString(&msg));
+    std::string text;
+    action.appendText(&text, &setup);
+    ASSERT_EQ("SENT[cnt, 3]", text);
+    ASSERT_EQ(1, setup.getMessageXML(&msg).size());
+    ASSERT_EQ("<cnt/>", setup.getMessageXML(&msg)[0]);
+    std::string xml;
+    action.appendXML(&xml, 0, &setup);
+    ASSERT_EQ("    <cnt/>", Misc::Strings::splitLines(xml)[3]);
+  }
+  ASSERT_EQ(1, msg.mStrings);
+  ASSERT_EQ(1, msg.mXMLs);
+
+  // Without a setup, traits render their messages.
+  ASSERT_EQ("SENT[cnt, 3]", action.toString());
+  ASSERT_EQ(2, msg.mStrings);
+
+  // Unregistered messages are not found.
+  CountingMessage other;
+  ASSERT_EQ(nullptr, setup.findMessageString(&other));
+  ASSERT_EQ(nullptr, setup.findMessageXML(&other));
+}
+
+// _____________________________________________________________________________
+TEST(NetworkSetupDeathTest, getMessageStringOfUnknownFails) {
+  // Scenario: getting the representations of an unregistered message fails.
+  // Why: abnormal exit point of methods.
+  NetworkSetup setup(20);
+  Message msg;
+  ASSERT_DEATH(setup.getMessageString(&msg), "message not registered");
+  ASSERT_DEATH(setup.getMessageXML(&msg), "message not registered");
+}
+
 // _____________________________________________________________________________
 TEST(NetworkSetupTest, registerMessage) {
   // See registerComponent-test. This is analoguous, but with messages.
@@ -634,6 +871,128 @@ TEST(NetworkSetupDeathTest, duplicateMessageRegistrationFails) {
   ASSERT_DEATH(setup.registerMessage(&msg1), "duplicate");
 }
 
+// _____________________________________________________________________________
+TEST(MessagePoolTest, get) {
+  // Scenario: we request messages of two keys from a pool, repeatedly.
+  // Why: messages are created once per key on first use and then reused.
+  int created = 0;
+  MessagePool<Message, int> pool([&created](const int& key) {
+    created++;
+    return new Message();
+  });
+  ASSERT_EQ(0, pool.size());
+
+  const Message* msgA = pool.get(1);
+  const Message* msgB = pool.get(2);
+  ASSERT_NE(msgA, msgB);
+  ASSERT_EQ(msgA, pool.get(1));
+  ASSERT_EQ(msgB, pool.get(2));
+  ASSERT_EQ(2, created);
+  ASSERT_EQ(2, pool.size());
+
+  Message other;
+  ASSERT_TRUE(pool.contains(msgA));
+  ASSERT_FALSE(pool.contains(&other));
+}
+
+// _____________________________________________________________________________
+TEST(MessageInternerTest, get) {
+  // Scenario: we intern messages of many distinct keys, then look all of them
+  //  up again.
+  // Why: many keys force the table to grow, and lookups after growing must
+  //  still find the original messages.
+
+  // Message type for this test, keeping its key.
+  class KeyedMessage : public Message {
+   public:
+    KeyedMessage(ActionType type, int value) : mType(type), mValue(value) {}
+    ActionType mType;
+    int mValue;
+  };
+
+  MessageInterner<KeyedMessage, ActionType, int> interner;
+  std::vector<const KeyedMessage*> msgs;
+  for (int i = 0; i < 500; i++) {
+    msgs.push_back(interner.get(ActionType::SENT, i));
+    msgs.push_back(interner.get(ActionType::RECEIVED, i));
+  }
+  ASSERT_EQ(1000, interner.size());
+
+  for (int i = 0; i < 500; i++) {
+    const KeyedMessage* sent = interner.get(ActionType::SENT, i);
+    ASSERT_EQ(msgs[2 * i], sent);
+    ASSERT_EQ(ActionType::SENT, sent->mType);
+    ASSERT_EQ(i, sent->mValue);
+    ASSERT_EQ(msgs[2 * i + 1], interner.get(ActionType::RECEIVED, i));
+  }
+  ASSERT_EQ(1000, interner.size());
+
+  Message other;
+  ASSERT_TRUE(interner.contains(msgs[0]));
+  ASSERT_TRUE(interner.contains(msgs[999]));
+  ASSERT_FALSE(interner.contains(&other));
+}
+
+// _____________________________________________________________________________
+TEST(MessageInternerTest, registeredWithSetup) {
+  // Scenario: a setup with an interner accepts the interned messages.
+  // Why: interned messages are registered through their family.
+  NetworkSetup setup(20);
+  MessageInterner<Message> interner;
+  setup.registerMessageFamily(&interner);
+  ASSERT_TRUE(setup.isMessage(interner.get()));
+  ASSERT_EQ("Message", setup.getMessageString(interner.get()));
+}
+
+// _____________________________________________________________________________
+TEST(MessageInternerTest, sharedArena) {
+  // Scenario: two interners place their messages in one shared arena, which is
+  //  released as a whole after the interners are gone.
+  // Why: interned messages may live in the arena of a simulation.
+
+  // Message type for this test, keeping its key.
+  class ValueMessage : public Message {
+   public:
+    explicit ValueMessage(int value) : mValue(value) {}
+    int mValue;
+  };
+
+  Misc::Arena arena;
+  {
+    MessageInterner<ValueMessage, int> internerA(&arena);
+    MessageInterner<ValueMessage, int> internerB(&arena);
+    const Message* msgA = internerA.get(1);
+    const Message* msgB = internerB.get(1);
+    ASSERT_NE(msgA, msgB);
+    ASSERT_TRUE(arena.owns(msgA));
+    ASSERT_TRUE(arena.owns(msgB));
+    ASSERT_TRUE(internerA.contains(msgA));
+    ASSERT_EQ(msgA, internerA.get(1));
+  }
+  ASSERT_NE(0, arena.getAllocated());
+}
+
+// _____________________________________________________________________________
+TEST(NetworkSetupTest, registerMessageFamily) {
+  // Scenario: a setup with a message pool accepts the messages of the pool as
+  //  they are created, and renders them, but no other messages.
+  // Why: messages of a family are registered lazily on first use.
+  NetworkSetup setup(20);
+  MessagePool<Message, int> pool([](const int& key) { return new Message(); });
+  setup.registerMessageFamily(&pool);
+
+  const Message* msg = pool.get(7);
+  ASSERT_TRUE(setup.isMessage(msg));
+  ASSERT_TRUE(setup.isMessage(msg));
+  ASSERT_EQ("Message", setup.getMessageString(pool.get(8)));
+  ASSERT_EQ(setup.getMessageXML(msg), msg->toXML());
+
+  Message other;
+  ASSERT_FALSE(setup.isMessage(&other));
+  setup.registerMessage(&other);
+  ASSERT_TRUE(setup.isMessage(&other));
+}
+
 // _____________________________________________________________________________
 TEST(NetworkSetupDeathTest, duplicateComponentRegistrationFails) {
   // See duplicateMessageRegistrationFails-test. This is analoguous, but with
@@ -759,6 +1118,61 @@ TEST(NetworkStateTest, getTraitFor) {
   ASSERT_EQ(act2, state.getTraitFor(&comp2));
 }
 
+// _____________________________________________________________________________
+TEST(NetworkStateTest, hasTraitFor) {
+  // Scenario: we set the traits of two components in reverse registration
+  //  order and check hasTraitFor() and the order of iteration.
+  // Why: traits are stored by registration index, not by order of setting.
+  NetworkSetup setup(20);
+  NetworkState state(&setup);
+  Component comp1;
+  Component comp2;
+  ComponentAction act1(setup, ActionType::IDLE, 0, nullptr);
+  ComponentAction act2(setup, ActionType::COLLISION, 0, nullptr);
+
+  setup.registerComponent(&comp1);
+  setup.registerComponent(&comp2);
+  ASSERT_FALSE(state.hasTraitFor(&comp1));
+  state.setTraitFor(&comp2, act2);
+  ASSERT_FALSE(state.hasTraitFor(&comp1));
+  ASSERT_TRUE(state.hasTraitFor(&comp2));
+  state.setTraitFor(&comp1, act1);
+  ASSERT_TRUE(state.hasTraitFor(&comp1));
+
+  std::vector<const Component*> order;
+  state.forEachTrait([&order](const Component* comp,
+      const ComponentAction& act) { order.push_back(comp); });
+  ASSERT_EQ(2, order.size());
+  ASSERT_EQ(&comp1, order[0]);
+  ASSERT_EQ(&comp2, order[1]);
+}
+
+// _____________________________________________________________________________
+TEST(NetworkStateTest, equality) {
+  // Scenario: we compare network states that are partial, equal, and differ
+  //  in a single trait.
+  // Why: quiescence detection relies on comparing whole network states.
+  NetworkSetup setup(20);
+  Component comp1;
+  Component comp2;
+  setup.registerComponent(&comp1);
+  setup.registerComponent(&comp2);
+  ComponentAction idle(setup, ActionType::IDLE, 0, nullptr);
+  ComponentAction silence(setup, ActionType::SILENCE, 0, nullptr);
+
+  NetworkState first(&setup);
+  NetworkState second(&setup);
+  ASSERT_TRUE(first == second);
+  first.setTraitFor(&comp1, idle);
+  ASSERT_TRUE(first != second);
+  first.setTraitFor(&comp2, idle);
+  second.setTraitFor(&comp1, idle);
+  second.setTraitFor(&comp2, idle);
+  ASSERT_TRUE(first == second);
+  second.replaceTraitFor(&comp2, silence);
+  ASSERT_TRUE(first != second);
+}
+
 // _____________________________________________________________________________
 TEST(NetworkStateTest, toString) {
   // Scenario: we test that the textual representation of a network state with
@@ -824,6 +1238,39 @@ TEST(NetworkStateTest, toXML) {
   ASSERT_EQ("</entry>", repr[14]);
 }
 
+// _____________________________________________________________________________
+TEST(NetworkStateTest, appendTextAndXML) {
+  // Scenario: we append a network state with two component actions to buffers
+  //  that already have content.
+  // Why: the append methods must not clear the buffer and must indent every
+  //  line of the nested traits.
+  NetworkSetup setup(20);
+  Message msg;
+  Component comp1;
+  Component comp2;
+  setup.registerComponent(&comp1);
+  setup.registerComponent(&comp2);
+  setup.registerMessage(&msg);
+
+  NetworkState state(&setup);
+  state.setTraitFor(&comp1, ComponentAction(setup, ActionType::COLLISION, 0,
+    nullptr));
+  state.setTraitFor(&comp2, ComponentAction(setup, ActionType::SENT, 3, &msg));
+
+  std::string buffer("# ");
+  state.appendText(&buffer);
+  ASSERT_EQ("# (COL, SENT[Message, 3])", buffer);
+  ASSERT_EQ("(COL, SENT[Message, 3])", state.toString());
+
+  buffer = "# ";
+  state.appendXML(&buffer, 4);
+  std::string expected("# ");
+  for (const std::string& line : state.toXML()) {
+    expected += "    " + line + "\n";
+  }
+  ASSERT_EQ(expected, buffer);
+}
+
 // _____________________________________________________________________________
 TEST(NetworkStateDeathTest, canNotSetInvalid) {
   // See canNotGetInvalidFromState-test, this is analoguous.
@@ -873,6 +1320,54 @@ TEST(NetworkStateTest, setTraitFor) {
   ASSERT_EQ(act2, state.getTraitFor(&comp2));
 }
 
+// _____________________________________________________________________________
+TEST(NetworkStateDeathTest, canNotIteratePartialState) {
+  // Scenario: forEachTrait() on partial state fails.
+  // Why: abnormal exit point in method.
+  NetworkSetup setup(20);
+  NetworkState state(&setup);
+
+  ASSERT_DEATH(state.forEachTrait(
+    [](const Component* comp, const ComponentAction& act) {}),
+    "attempting to iterate partial");
+}
+
+// _____________________________________________________________________________
+TEST(NetworkStateTest, forEachTrait) {
+  // Scenario: we iterate a network state with three components, registered in
+  //  an order that differs from their setting order.
+  // Why: more than two components in order to check that the registration
+  //  order is used.
+  NetworkSetup setup(20);
+  NetworkState state(&setup);
+  Component comps[3];
+  ComponentAction act0(setup, ActionType::IDLE, 0, nullptr);
+  ComponentAction act1(setup, ActionType::COLLISION, 0, nullptr);
+  ComponentAction act2(setup, ActionType::SILENCE, 0, nullptr);
+  setup.registerComponent(&comps[2]);
+  setup.registerComponent(&comps[0]);
+  setup.registerComponent(&comps[1]);
+  state.setTraitFor(&comps[0], act0);
+  state.setTraitFor(&comps[1], act1);
+  state.setTraitFor(&comps[2], act2);
+
+  std::vector<const Component*> order;
+  std::vector<ActionType> types;
+  state.forEachTrait([&order, &types](const Component* comp,
+      const ComponentAction& act) {
+    order.push_back(comp);
+    types.push_back(act.getType());
+  });
+
+  ASSERT_EQ(3, order.size());
+  ASSERT_EQ(&comps[2], order[0]);
+  ASSERT_EQ(&comps[0], order[1]);
+  ASSERT_EQ(&comps[1], order[2]);
+  ASSERT_EQ(ActionType::SILENCE, types[0]);
+  ASSERT_EQ(ActionType::IDLE, types[1]);
+  ASSERT_EQ(ActionType::COLLISION, types[2]);
+}
+
 // _____________________________________________________________________________
 TEST(IntentionAssignmentDeathTest, canNotGetFromPartialState) {
   // See same test but for NetworkStates -- this is analoguous.
@@ -1220,6 +1715,22 @@ TEST(ANLViewDeathTest, duplicateActionFails) {
   ASSERT_DEATH(av5.listen(), "already acted");
 }
 
+// _____________________________________________________________________________
+TEST(ANLViewDeathTest, invalidSendFails) {
+  // Scenario: sending nullptr and sending in a tic beyond the slot fail.
+  // Why: abnormal exit points of the method, which are checked in every build.
+  NetworkSetup setup(20);
+  Component comp;
+  Message msg;
+  setup.registerComponent(&comp);
+  setup.registerMessage(&msg);
+
+  IntentionAssignment intent(&setup);
+  ANLView av(&setup, 0, &comp, &intent);
+  ASSERT_DEATH(av.send(nullptr, 3), "can not send nullptr");
+  ASSERT_DEATH(av.send(&msg, 20), "invalid tic number");
+}
+
 // _____________________________________________________________________________
 TEST(StateMachineComponentTest, initialState) {
   // Scenario: we supply an initial state which is correctly set as the state of
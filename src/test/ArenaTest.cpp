@@ -0,0 +1,117 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "anl/misc/arena.h"
+
+// _____________________________________________________________________________
+TEST(ArenaTest, allocate) {
+  // Scenario: we allocate small pieces with different alignments, and one piece
+  //  that is larger than a block.
+  // Why: alignment must be honoured across blocks, oversized requests get a
+  //  block of their own.
+  Misc::Arena arena(64);
+  char* a = static_cast<char*>(arena.allocate(3, 1));
+  void* b = arena.allocate(8, 8);
+  ASSERT_EQ(0, reinterpret_cast<std::uintptr_t>(b) % 8);
+  void* c = arena.allocate(1000, 16);
+  ASSERT_EQ(0, reinterpret_cast<std::uintptr_t>(c) % 16);
+  ASSERT_EQ(1011, arena.getAllocated());
+
+  // The memory is usable and does not overlap.
+  a[0] = 'x';
+  static_cast<char*>(c)[999] = 'y';
+  ASSERT_EQ('x', a[0]);
+}
+
+// _____________________________________________________________________________
+TEST(ArenaTest, ownsAndRelease) {
+  // Scenario: we check ownership of arena memory and of foreign memory, before
+  //  and after releasing the arena.
+  // Why: membership of interned messages relies on owns().
+  Misc::Arena arena(16);
+  int local = 0;
+  void* first = arena.allocate(8, 8);
+  void* second = arena.allocate(64, 8);
+  ASSERT_TRUE(arena.owns(first));
+  ASSERT_TRUE(arena.owns(second));
+  ASSERT_FALSE(arena.owns(&local));
+
+  arena.release();
+  ASSERT_EQ(0, arena.getAllocated());
+  ASSERT_FALSE(arena.owns(second));
+  void* third = arena.allocate(8, 8);
+  ASSERT_TRUE(arena.owns(third));
+  ASSERT_FALSE(arena.owns(&local));
+}
+
+// _____________________________________________________________________________
+TEST(ArenaTest, releaseReusesBlocks) {
+  // Scenario: we fill several blocks, release the arena, and fill it again in
+  //  the same way.
+  // Why: released blocks are reused, thus the second round hands out the same
+  //  memory as the first one.
+  Misc::Arena arena(32);
+  std::vector<void*> first;
+  for (int i = 0; i < 20; i++) {
+    first.push_back(arena.allocate(24, 8));
+  }
+  arena.release();
+  for (int i = 0; i < 20; i++) {
+    ASSERT_EQ(first[i], arena.allocate(24, 8));
+  }
+}
+
+// _____________________________________________________________________________
+TEST(ArenaTest, allocator) {
+  // Scenario: a vector grows within an arena, and another one without arena.
+  // Why: the allocator serves standard containers with and without arena.
+  Misc::Arena arena;
+  std::vector<int, Misc::ArenaAllocator<int>> inArena(
+    (Misc::ArenaAllocator<int>(&arena)));
+  std::vector<int, Misc::ArenaAllocator<int>> onHeap;
+  for (int i = 0; i < 100; i++) {
+    inArena.push_back(i);
+    onHeap.push_back(i);
+  }
+  ASSERT_TRUE(arena.owns(inArena.data()));
+  ASSERT_FALSE(arena.owns(onHeap.data()));
+  ASSERT_EQ(inArena[99], onHeap[99]);
+}
+
+// _____________________________________________________________________________
+TEST(ArenaDeathTest, invalidAlignmentFails) {
+  // Scenario: an alignment that is not a power of two is rejected.
+  // Why: abnormal exit point of allocate().
+  Misc::Arena arena;
+  ASSERT_DEATH(arena.allocate(8, 3), "power of two");
+}
@@ -62,3 +62,28 @@ TEST(ExpectTest, successfulExpectationDoesNotExitProgram) {
   Misc::Asserts::expect(true, "runs!");
   // (Same argument as above)
 }
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Counts its invocations.
+static int gEvaluations = 0;
+static bool evaluate(bool result) {
+  gEvaluations++;
+  return result;
+}
+
+// _____________________________________________________________________________
+TEST(AssertsDeathTest, tiersInDebugCode) {
+  // Scenario: the debug build enables every tier, thus failures of each tier
+  //  exit the program and conditions are evaluated exactly once.
+  // Why: the tests are built with ANL_PARANOID and without NDEBUG.
+  ASSERT_DEATH(ANL_REQUIRE(false, "always_1"), "always_1");
+  ASSERT_DEATH(ANL_DEBUG_REQUIRE(false, "debug_2"), "debug_2");
+  ASSERT_DEATH(ANL_PARANOID_REQUIRE(false, "paranoid_3"), "paranoid_3");
+
+  gEvaluations = 0;
+  ANL_REQUIRE(evaluate(true), "always");
+  ANL_DEBUG_REQUIRE(evaluate(true), "debug");
+  ANL_DEBUG_EXPECT(evaluate(true), "debug");
+  ANL_PARANOID_REQUIRE(evaluate(true), "paranoid");
+  ASSERT_EQ(4, gEvaluations);
+}
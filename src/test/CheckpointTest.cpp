@@ -0,0 +1,309 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include "anl/core/anl.h"
+#include "anl/core/checkpoint.h"
+#include "anl/core/message_interner.h"
+#include "anl/core/message_pool.h"
+
+// We do this here as a test can under no circumstance pollute the namespace as
+// it is never included.
+using namespace Core;  // NOLINT
+
+// _____________________________________________________________________________
+// Message type for the tests in this file, keeping its key.
+class KeyedMessage : public Message {
+ public:
+  KeyedMessage(ActionType type, const Component* comp, int value)
+    : mType(type), mComp(comp), mValue(value) {}
+  ActionType mType;
+  const Component* mComp;
+  int mValue;
+};
+
+// _____________________________________________________________________________
+TEST(CheckpointTest, values) {
+  // Scenario: we write numbers, strings, components, and values of several
+  //  types, and read them back.
+  // Why: regular case of encoding, including nullptr components.
+  Component a;
+  Component b;
+  NetworkSetup setup(20);
+  setup.registerComponent(&a);
+  setup.registerComponent(&b);
+
+  CheckpointWriter writer(&setup);
+  writer.writeMagic();
+  writer.writeNumber(UINT64_MAX);
+  writer.writeString("abc");
+  writer.writeComponent(&b);
+  writer.writeComponent(nullptr);
+  ASSERT_TRUE(writer.writeValue(ActionType::SENT));
+  ASSERT_TRUE(writer.writeValue(-5));
+  ASSERT_TRUE(writer.writeValue(static_cast<const Component*>(&a)));
+  ASSERT_TRUE(writer.writeValue(std::string("de")));
+  ASSERT_FALSE(writer.writeValue(1.5));
+
+  CheckpointReader reader(&setup, std::string(writer.getData()));
+  std::uint64_t number = 0;
+  std::string str;
+  const Component* comp = &a;
+  ActionType type = ActionType::IDLE;
+  int value = 0;
+  double fraction = 0;
+  ASSERT_TRUE(reader.readMagic());
+  ASSERT_TRUE(reader.readNumber(&number));
+  ASSERT_EQ(UINT64_MAX, number);
+  ASSERT_TRUE(reader.readString(&str));
+  ASSERT_EQ("abc", str);
+  ASSERT_TRUE(reader.readComponent(&comp));
+  ASSERT_EQ(&b, comp);
+  ASSERT_TRUE(reader.readComponent(&comp));
+  ASSERT_EQ(nullptr, comp);
+  ASSERT_TRUE(reader.readValue(&type));
+  ASSERT_EQ(ActionType::SENT, type);
+  ASSERT_TRUE(reader.readValue(&value));
+  ASSERT_EQ(-5, value);
+  ASSERT_TRUE(reader.readValue(&comp));
+  ASSERT_EQ(&a, comp);
+  ASSERT_TRUE(reader.readValue(&str));
+  ASSERT_EQ("de", str);
+  ASSERT_TRUE(reader.atEnd());
+  ASSERT_FALSE(reader.readNumber(&number));
+  ASSERT_FALSE(reader.readValue(&fraction));
+}
+
+// _____________________________________________________________________________
+TEST(CheckpointTest, messages) {
+  // Scenario: we write no message, a registered message, an interned message,
+  //  and a pooled message, and read them into a second setup whose families
+  //  have not created the messages yet.
+  // Why: messages of families are identified by their keys, not addresses.
+  Component a;
+  Message registered;
+  MessageInterner<KeyedMessage, ActionType, const Component*, int> interner;
+  MessagePool<Message, std::string> pool([](const std::string& key) {
+    return new Message();
+  });
+  NetworkSetup setup(20);
+  setup.registerComponent(&a);
+  setup.registerMessage(&registered);
+  setup.registerMessageFamily(&pool);
+  setup.registerMessageFamily(&interner);
+
+  CheckpointWriter writer(&setup);
+  ASSERT_TRUE(writer.writeMessage(nullptr));
+  ASSERT_TRUE(writer.writeMessage(&registered));
+  ASSERT_TRUE(writer.writeMessage(interner.get(ActionType::SENT, &a, 7)));
+  ASSERT_TRUE(writer.writeMessage(pool.get("x")));
+
+  MessageInterner<KeyedMessage, ActionType, const Component*, int> interner2;
+  MessagePool<Message, std::string> pool2([](const std::string& key) {
+    return new Message();
+  });
+  NetworkSetup setup2(20);
+  setup2.registerComponent(&a);
+  setup2.registerMessage(&registered);
+  setup2.registerMessageFamily(&pool2);
+  setup2.registerMessageFamily(&interner2);
+
+  CheckpointReader reader(&setup2, std::string(writer.getData()));
+  const Message* msg = &registered;
+  ASSERT_TRUE(reader.readMessage(&msg));
+  ASSERT_EQ(nullptr, msg);
+  ASSERT_TRUE(reader.readMessage(&msg));
+  ASSERT_EQ(&registered, msg);
+  ASSERT_TRUE(reader.readMessage(&msg));
+  ASSERT_EQ(interner2.get(ActionType::SENT, &a, 7), msg);
+  ASSERT_TRUE(reader.readMessage(&msg));
+  ASSERT_EQ(pool2.get("x"), msg);
+  ASSERT_TRUE(reader.atEnd());
+  ASSERT_EQ(1, interner2.size());
+  ASSERT_EQ(1, pool2.size());
+}
+
+// _____________________________________________________________________________
+TEST(CheckpointTest, pooledMessagesAfterGrowth) {
+  // Scenario: a pool creates a thousand messages, and we write the first and
+  //  the last of them and read them into a second setup.
+  // Why: the keys are looked up by message, which must survive the pool
+  //  growing.
+  MessagePool<Message, int> pool([](const int& key) { return new Message(); });
+  NetworkSetup setup(20);
+  setup.registerMessageFamily(&pool);
+  const Message* first = pool.get(0);
+  for (int key = 1; key < 1000; key++) {
+    pool.get(key);
+  }
+  CheckpointWriter writer(&setup);
+  ASSERT_TRUE(writer.writeMessage(first));
+  ASSERT_TRUE(writer.writeMessage(pool.get(999)));
+
+  MessagePool<Message, int> pool2([](const int& key) {
+    return new Message();
+  });
+  NetworkSetup setup2(20);
+  setup2.registerMessageFamily(&pool2);
+  CheckpointReader reader(&setup2, std::string(writer.getData()));
+  const Message* msg = nullptr;
+  ASSERT_TRUE(reader.readMessage(&msg));
+  ASSERT_EQ(pool2.get(0), msg);
+  ASSERT_TRUE(reader.readMessage(&msg));
+  ASSERT_EQ(pool2.get(999), msg);
+  ASSERT_EQ(2, pool2.size());
+}
+
+// _____________________________________________________________________________
+TEST(CheckpointTest, sharedArenaMessages) {
+  // Scenario: two interners of the same type and one of another type share an
+  //  arena, thus all claim each other's messages. We write a message of each
+  //  and read them into a second setup.
+  // Why: the key must come from the interner that created the message.
+
+  // Message types for this test, keyed by a number.
+  class ValueMessage : public Message {
+   public:
+    explicit ValueMessage(int value) {}
+  };
+  class OtherMessage : public Message {
+   public:
+    explicit OtherMessage(int value) {}
+  };
+
+  Misc::Arena arena;
+  MessageInterner<ValueMessage, int> internerA(&arena);
+  MessageInterner<ValueMessage, int> internerB(&arena);
+  MessageInterner<OtherMessage, int> internerC(&arena);
+  NetworkSetup setup(20);
+  setup.registerMessageFamily(&internerA);
+  setup.registerMessageFamily(&internerB);
+  setup.registerMessageFamily(&internerC);
+  internerA.get(1);
+  const Message* msgB = internerB.get(2);
+  const Message* msgC = internerC.get(3);
+  ASSERT_TRUE(internerA.contains(msgB));
+  ASSERT_TRUE(internerA.contains(msgC));
+
+  CheckpointWriter writer(&setup);
+  ASSERT_TRUE(writer.writeMessage(msgB));
+  ASSERT_TRUE(writer.writeMessage(msgC));
+
+  Misc::Arena arena2;
+  MessageInterner<ValueMessage, int> internerA2(&arena2);
+  MessageInterner<ValueMessage, int> internerB2(&arena2);
+  MessageInterner<OtherMessage, int> internerC2(&arena2);
+  NetworkSetup setup2(20);
+  setup2.registerMessageFamily(&internerA2);
+  setup2.registerMessageFamily(&internerB2);
+  setup2.registerMessageFamily(&internerC2);
+
+  CheckpointReader reader(&setup2, std::string(writer.getData()));
+  const Message* msg = nullptr;
+  ASSERT_TRUE(reader.readMessage(&msg));
+  ASSERT_EQ(internerB2.get(2), msg);
+  ASSERT_TRUE(reader.readMessage(&msg));
+  ASSERT_EQ(internerC2.get(3), msg);
+  ASSERT_TRUE(reader.atEnd());
+  ASSERT_EQ(0, internerA2.size());
+}
+
+// _____________________________________________________________________________
+TEST(CheckpointTest, unsupportedMessages) {
+  // Scenario: we write an unregistered message and a message whose key can
+  //  not be encoded.
+  // Why: such messages rule out checkpoints, and nothing is written for them.
+
+  // Message type for this test, keyed by a fraction.
+  class FractionMessage : public Message {
+   public:
+    explicit FractionMessage(double value) {}
+  };
+
+  MessageInterner<FractionMessage, double> interner;
+  Message unregistered;
+  NetworkSetup setup(20);
+  setup.registerMessageFamily(&interner);
+
+  CheckpointWriter writer(&setup);
+  ASSERT_FALSE(writer.writeMessage(&unregistered));
+  ASSERT_FALSE(writer.writeMessage(interner.get(0.5)));
+  ASSERT_EQ("", writer.getData());
+}
+
+// _____________________________________________________________________________
+TEST(CheckpointTest, networkState) {
+  // Scenario: we write a network state with a message and read it back.
+  // Why: the previous network state is part of every checkpoint.
+  Component a;
+  Component b;
+  Message msg;
+  NetworkSetup setup(20);
+  setup.registerComponent(&a);
+  setup.registerComponent(&b);
+  setup.registerMessage(&msg);
+  NetworkState state(&setup);
+  state.setTraitFor(&a, ComponentAction(setup, ActionType::SENT, 3, &msg));
+  state.setTraitFor(&b, ComponentAction(setup, ActionType::RECEIVED, 3, &msg));
+
+  CheckpointWriter writer(&setup);
+  ASSERT_TRUE(writer.writeState(state));
+  CheckpointReader reader(&setup, std::string(writer.getData()));
+  NetworkState restored(&setup);
+  ASSERT_TRUE(reader.readState(&restored));
+  ASSERT_TRUE(reader.atEnd());
+  ASSERT_EQ(state, restored);
+}
+
+// _____________________________________________________________________________
+TEST(CheckpointTest, malformed) {
+  // Scenario: we read a wrong magic, a truncated string, a component and a
+  //  message out of range, an unknown message tag, and a tic out of range.
+  // Why: malformed checkpoints must be rejected instead of being trusted.
+  Component a;
+  NetworkSetup setup(20);
+  setup.registerComponent(&a);
+  const Component* comp = nullptr;
+  const Message* msg = nullptr;
+  std::string str;
+
+  ASSERT_FALSE(CheckpointReader(&setup, "ANLINT01").readMagic());
+  ASSERT_FALSE(CheckpointReader(&setup, "\x05" "abc").readString(&str));
+  ASSERT_FALSE(CheckpointReader(&setup, "\x02").readComponent(&comp));
+  ASSERT_FALSE(CheckpointReader(&setup, std::string("\x01\x00", 2))
+    .readMessage(&msg));
+  ASSERT_FALSE(CheckpointReader(&setup, std::string("\x02\x00", 2))
+    .readMessage(&msg));
+  ASSERT_FALSE(CheckpointReader(&setup, "\x03").readMessage(&msg));
+
+  NetworkState state(&setup);
+  ASSERT_FALSE(CheckpointReader(&setup, std::string("\x00\x14\x00", 3))
+    .readState(&state));
+}
@@ -125,3 +125,39 @@ TEST(ErrorTracerDeathTest, requireFailOnMultiStack) {
   ASSERT_DEATH(et.require(false, "a_06"), "u_23");
   ASSERT_DEATH(et.require(false, "a_06"), "w_24");
 }
+
+// _____________________________________________________________________________
+TEST(ErrorTracerTest, sectionLeavesAtScopeEnd) {
+  // Scenario: we nest two section guards and check the depth after each scope.
+  // Why: the guards must leave exactly the sections they entered.
+  ErrorTracer et;
+  {
+    ErrorTracer::Section outer(&et, "outer");
+    ASSERT_EQ(1, et.getDepth());
+    {
+      ErrorTracer::Section inner(&et, "inner");
+      ASSERT_EQ(2, et.getDepth());
+    }
+    ASSERT_EQ(1, et.getDepth());
+  }
+  ASSERT_EQ(0, et.getDepth());
+}
+
+// _____________________________________________________________________________
+TEST(ErrorTracerDeathTest, requireFailBeyondMaxDepth) {
+  // Scenario: failing a required expression with more sections than the stack
+  //  holds reports the stored sections and the number of the others.
+  // Why: corner case of the fixed-size section stack.
+  ErrorTracer et;
+  et.enter("first_77");
+  for (std::size_t i = 1; i < ErrorTracer::kMaxDepth + 2; i++) {
+    et.enter("deeper");
+  }
+  ASSERT_DEATH(et.require(false, "b_11"), "first_77");
+  ASSERT_DEATH(et.require(false, "b_11"), "\\(2 more sections\\)");
+
+  for (std::size_t i = 0; i < ErrorTracer::kMaxDepth + 2; i++) {
+    et.leave();
+  }
+  ASSERT_EQ(0, et.getDepth());
+}
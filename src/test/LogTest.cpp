@@ -0,0 +1,156 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "anl/misc/log.h"
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Redirects the log into a temporary file
+//  for the lifetime of the object and restores STDERR and the level after.
+class LogCapture {
+ public:
+  LogCapture() : mPath("/tmp/anlimpl_log_test_XXXXXX"),
+      mLevel(Misc::Log::getLevel()) {
+    mFd = mkstemp(&mPath[0]);
+    Misc::Log::setFileDescriptor(mFd);
+  }
+  ~LogCapture() {
+    Misc::Log::setFileDescriptor(STDERR_FILENO);
+    Misc::Log::setLevel(mLevel);
+    close(mFd);
+    unlink(mPath.c_str());
+  }
+
+  // Returns what was written to the log file so far.
+  std::string read() const {
+    std::ifstream in(mPath);
+    std::stringstream sstr;
+    sstr << in.rdbuf();
+    return sstr.str();
+  }
+
+ private:
+  std::string mPath;
+  Misc::LogLevel mLevel;
+  int mFd;
+};
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Counts its invocations.
+static int gEvaluations = 0;
+static int evaluate() { return ++gEvaluations; }
+
+// _____________________________________________________________________________
+TEST(LogTest, parseLevel) {
+  // Scenario: we parse all known level names and an unknown one.
+  // Why: the names are used on the command line.
+  Misc::LogLevel level = Misc::LogLevel::INFO;
+  ASSERT_TRUE(Misc::Log::parseLevel("fine", &level));
+  ASSERT_EQ(Misc::LogLevel::FINE, level);
+  ASSERT_TRUE(Misc::Log::parseLevel("protocol", &level));
+  ASSERT_EQ(Misc::LogLevel::PROTOCOL, level);
+  ASSERT_TRUE(Misc::Log::parseLevel("warning", &level));
+  ASSERT_EQ(Misc::LogLevel::WARNING, level);
+  ASSERT_TRUE(Misc::Log::parseLevel("severe", &level));
+  ASSERT_EQ(Misc::LogLevel::SEVERE, level);
+  ASSERT_TRUE(Misc::Log::parseLevel("off", &level));
+  ASSERT_EQ(Misc::LogLevel::OFF, level);
+  ASSERT_TRUE(Misc::Log::parseLevel("info", &level));
+  ASSERT_EQ(Misc::LogLevel::INFO, level);
+  ASSERT_FALSE(Misc::Log::parseLevel("verbose", &level));
+  ASSERT_EQ(Misc::LogLevel::INFO, level);
+}
+
+// _____________________________________________________________________________
+TEST(LogTest, messagesArePrefixedAndBuffered) {
+  // Scenario: we log an info message, which is only written on flush, and a
+  //  warning, which is written immediately.
+  // Why: buffering must not delay important messages.
+  LogCapture capture;
+  Misc::Log::setLevel(Misc::LogLevel::INFO);
+  ANL_LOG(INFO, "Simulating %d slots.", 3);
+  ASSERT_EQ("", capture.read());
+  Misc::Log::flush();
+  ASSERT_EQ("[ INFO ] Simulating 3 slots.\n", capture.read());
+  ANL_LOG(WARNING, "%s", "careful");
+  ASSERT_EQ("[ INFO ] Simulating 3 slots.\n[ WARN ] careful\n",
+    capture.read());
+}
+
+// _____________________________________________________________________________
+TEST(LogTest, emptyMessagesHaveNoSeparator) {
+  // Scenario: we log an empty message between two regular ones.
+  // Why: blank lines, as in the banner, must not end in a trailing space.
+  LogCapture capture;
+  Misc::Log::setLevel(Misc::LogLevel::INFO);
+  ANL_LOG(INFO, "%s", "a");
+  ANL_LOG(INFO, "%s", "");
+  ANL_LOG(INFO, "%s", "b");
+  Misc::Log::flush();
+  ASSERT_EQ("[ INFO ] a\n[ INFO ]\n[ INFO ] b\n", capture.read());
+}
+
+// _____________________________________________________________________________
+TEST(LogTest, disabledLevelsDoNotEvaluateArguments) {
+  // Scenario: we log below and at the runtime threshold.
+  // Why: disabled messages must not cost more than the level check.
+  LogCapture capture;
+  gEvaluations = 0;
+  Misc::Log::setLevel(Misc::LogLevel::WARNING);
+  ANL_LOG(INFO, "%d", evaluate());
+  ANL_LOG(PROTOCOL, "%d", evaluate());
+  ASSERT_EQ(0, gEvaluations);
+  ANL_LOG(SEVERE, "%d", evaluate());
+  ASSERT_EQ(1, gEvaluations);
+  ASSERT_EQ("[SEVERE] 1\n", capture.read());
+
+  Misc::Log::setLevel(Misc::LogLevel::OFF);
+  ANL_LOG(SEVERE, "%d", evaluate());
+  ASSERT_EQ(1, gEvaluations);
+}
+
+// _____________________________________________________________________________
+TEST(LogTest, longMessagesBypassBuffer) {
+  // Scenario: we log a message that is larger than the log buffer after a
+  //  buffered message.
+  // Why: edge case of the buffer, the order of messages must be kept.
+  LogCapture capture;
+  Misc::Log::setLevel(Misc::LogLevel::FINE);
+  ANL_LOG(FINE, "first");
+  std::string text(Misc::Log::kBufferSize, 'x');
+  ANL_LOG(INFO, "%s", text.c_str());
+  Misc::Log::flush();
+  ASSERT_EQ("[ FINE ] first\n[ INFO ] " + text + "\n", capture.read());
+}
@@ -0,0 +1,1081 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "anl/core/anl.h"
+#include "anl/core/topologies.h"
+#include "anl/output/output.h"
+#include "anl/output/sink.h"
+#include "anl/output/trace_reader.h"
+
+// We do this here as a test can under no circumstance pollute the namespace as
+// it is never included.
+using namespace Core;    // NOLINT
+using namespace Output;  // NOLINT
+
+// _____________________________________________________________________________
+// Output module for the tests in this file. It records every notification
+//  together with a name into a log.
+class RecordingOutputModule : public OutputModule {
+ public:
+  // Constructor. The flag is set when the module is destroyed.
+  RecordingOutputModule(const std::string& name, std::vector<std::string>* log,
+    bool* destroyed = nullptr) : mName(name), mLog(log),
+      mDestroyed(destroyed) {}
+
+  // Destructor.
+  ~RecordingOutputModule() override {
+    if (mDestroyed != nullptr) {
+      *mDestroyed = true;
+    }
+  }
+
+ private:
+  // The name used in the log.
+  std::string mName;
+
+  // The log.
+  std::vector<std::string>* mLog;
+
+  // The destruction flag.
+  bool* mDestroyed;
+
+  // Notifications.
+  void doSimulationBegin(std::size_t numSlots, const NetworkSetup* setup,
+      const NetworkTopology* topology) override
+    { mLog->push_back(mName + ":begin:" + std::to_string(numSlots)); }
+  void doSlotBegin(std::size_t slotNumber) override
+    { mLog->push_back(mName + ":slot:" + std::to_string(slotNumber)); }
+  void doProtocolLog(const std::string& componentId,
+      const std::string& message) override
+    { mLog->push_back(mName + ":log:" + componentId + ":" + message); }
+  void doIntentChosen(const IntentionAssignment& intent) override
+    { mLog->push_back(mName + ":intent"); }
+  void doTransitionComputed(const std::vector<NetworkState>& outcomes)
+      override
+    { mLog->push_back(mName + ":outcomes:" + std::to_string(outcomes.size())); }
+  void doResultChosen(const NetworkState& state) override
+    { mLog->push_back(mName + ":result"); }
+  void doSlotEnd() override { mLog->push_back(mName + ":slotend"); }
+  void doSlotsSkipped(std::size_t firstSlot, std::size_t count,
+      const std::vector<NetworkState>& cycle) override {
+    mLog->push_back(mName + ":skipped:" + std::to_string(firstSlot) + ":"
+      + std::to_string(count) + ":" + cycle.front().toString());
+  }
+  void doSimulationEnd(std::size_t numSlots) override
+    { mLog->push_back(mName + ":end:" + std::to_string(numSlots)); }
+};
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Creates a temporary file and returns its
+//  path.
+static std::string createTempFile() {
+  char path[] = "/tmp/anlimpl_output_test_XXXXXX";
+  int fd = mkstemp(path);
+  close(fd);
+  return path;
+}
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Reads the whole content of a file.
+static std::string readFile(const std::string& path) {
+  std::ifstream in(path);
+  std::stringstream sstr;
+  sstr << in.rdbuf();
+  return sstr.str();
+}
+
+// _____________________________________________________________________________
+TEST(SinkDeathTest, invalidFdFails) {
+  // Scenario: creating a sink for a negative file descriptor fails.
+  // Why: abnormal exit point of constructor.
+  ASSERT_DEATH(Sink(-1), "invalid file descriptor");
+}
+
+// _____________________________________________________________________________
+TEST(SinkTest, openFile) {
+  // Scenario: we open an existing file and a file in a non-existing
+  //  directory.
+  // Why: regular case and failure case.
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path, 16);
+  ASSERT_NE(nullptr, sink);
+  ASSERT_EQ(16, sink->getBufferSize());
+  delete sink;
+  unlink(path.c_str());
+
+  ASSERT_EQ(nullptr, Sink::openFile("/nonexistent/dir/file.txt"));
+}
+
+// _____________________________________________________________________________
+TEST(SinkTest, writeIsBuffered) {
+  // Scenario: we write less than the buffer size. nothing is written before
+  //  flushing, everything is written after flushing.
+  // Why: regular case of buffering.
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path, 16);
+  sink->write("abc");
+  sink->write(std::string("def"));
+  ASSERT_EQ("", readFile(path));
+  sink->flush();
+  ASSERT_EQ("abcdef", readFile(path));
+  delete sink;
+  unlink(path.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(SinkTest, writeLargerThanBuffer) {
+  // Scenario: we write data that fills the buffer exactly, exceeds it, and
+  //  that is larger than the whole buffer.
+  // Why: corner cases of buffering.
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path, 4);
+  sink->write("abc");
+  sink->write("d");
+  sink->write("efghijkl");
+  sink->write("m");
+  delete sink;
+  ASSERT_EQ("abcdefghijklm", readFile(path));
+  unlink(path.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(SinkTest, unbuffered) {
+  // Scenario: a sink with buffer size 0 writes through immediately.
+  // Why: corner case (buffering disabled).
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path, 0, true);
+  sink->write("ab");
+  ASSERT_EQ("ab", readFile(path));
+  sink->print("%d-%s", 42, "x");
+  ASSERT_EQ("ab42-x", readFile(path));
+  delete sink;
+  unlink(path.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(SinkTest, print) {
+  // Scenario: we print formatted output that fits into the buffer, that does
+  //  not fit into the remaining buffer, and that is larger than the buffer.
+  // Why: regular case and the two corner cases of formatting into the buffer.
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path, 8);
+  sink->print("%zu", static_cast<std::size_t>(12345));
+  sink->print("<%s>", "abc");
+  sink->print("[%s]", "0123456789");
+  delete sink;
+  ASSERT_EQ("12345<abc>[0123456789]", readFile(path));
+  unlink(path.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(SinkTest, getPosition) {
+  // Scenario: we write through a small buffer and check the position after
+  //  buffered writes, flushes and writes bypassing the buffer.
+  // Why: the position must count both written and buffered bytes.
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path, 4);
+  ASSERT_EQ(0, sink->getPosition());
+  sink->write("ab", 2);
+  ASSERT_EQ(2, sink->getPosition());
+  sink->write("cdefgh", 6);
+  ASSERT_EQ(8, sink->getPosition());
+  sink->print("%d", 42);
+  sink->flush();
+  ASSERT_EQ(10, sink->getPosition());
+  delete sink;
+  ASSERT_EQ(10, readFile(path).size());
+  unlink(path.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(SinkTest, resumeAt) {
+  // Scenario: we reopen a file without truncating it and resume in its middle,
+  //  at its end, and beyond its end.
+  // Why: output after a checkpoint must be discarded, a file that ends before
+  //  the checkpoint can not be continued.
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path, 4);
+  sink->write("abcdef");
+  delete sink;
+
+  sink = Sink::openFile(path, 4, false, false);
+  ASSERT_TRUE(sink->resumeAt(3));
+  ASSERT_EQ(3, sink->getPosition());
+  sink->write("xy");
+  sink->flush();
+  ASSERT_EQ("abcxy", readFile(path));
+  ASSERT_TRUE(sink->resumeAt(5));
+  ASSERT_FALSE(sink->resumeAt(6));
+  delete sink;
+  ASSERT_EQ("abcxy", readFile(path));
+  unlink(path.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(TeeOutputModuleDeathTest, nullptrModuleFails) {
+  // Scenario: adding nullptr as child module fails.
+  // Why: abnormal exit point of method.
+  TeeOutputModule tee;
+  ASSERT_DEATH(tee.addModule(nullptr), "can not add nullptr as output module");
+}
+
+// _____________________________________________________________________________
+TEST(TeeOutputModuleDeathTest, selfFails) {
+  // Scenario: adding the tee to itself fails.
+  // Why: abnormal exit point of method.
+  TeeOutputModule tee;
+  ASSERT_DEATH(tee.addModule(&tee), "can not add tee to itself");
+}
+
+// _____________________________________________________________________________
+TEST(TeeOutputModuleTest, addModule) {
+  // Scenario: we add zero, one, and two modules and check the count.
+  // Why: corner case (empty) and regular cases.
+  std::vector<std::string> log;
+  TeeOutputModule tee;
+  ASSERT_EQ(0, tee.getModuleCount());
+  tee.addModule(new RecordingOutputModule("a", &log));
+  ASSERT_EQ(1, tee.getModuleCount());
+  tee.addModule(new RecordingOutputModule("b", &log));
+  ASSERT_EQ(2, tee.getModuleCount());
+}
+
+// _____________________________________________________________________________
+TEST(TeeOutputModuleTest, forwardsInOrder) {
+  // Scenario: we notify a tee with two children of a full single-slot
+  //  simulation and check that both children see every notification, in the
+  //  order in which they were added.
+  // Why: regular case covering every notification.
+  NetworkSetup setup(5);
+  Component comp;
+  setup.registerComponent(&comp);
+  TrivialNetworkTopology tnt;
+
+  IntentionAssignment intent(&setup);
+  intent.setTraitFor(&comp, ComponentIntention(setup, IntentionType::IDLE, 0,
+    nullptr));
+  NetworkState state(&setup);
+  state.setTraitFor(&comp, ComponentAction(setup, ActionType::IDLE, 0,
+    nullptr));
+  std::vector<NetworkState> outcomes;
+  outcomes.push_back(state);
+
+  std::vector<std::string> log;
+  TeeOutputModule tee;
+  tee.addModule(new RecordingOutputModule("a", &log));
+  tee.addModule(new RecordingOutputModule("b", &log));
+
+  tee.onSimulationBegin(1, &setup, &tnt);
+  tee.onSlotBegin(0);
+  tee.onIntentChosen(intent);
+  tee.onTransitionComputed(outcomes);
+  tee.onResultChosen(state);
+  tee.onSlotEnd();
+  tee.onSimulationEnd(1);
+
+  std::vector<std::string> expected = {
+    "a:begin:1", "b:begin:1", "a:slot:0", "b:slot:0", "a:intent", "b:intent",
+    "a:outcomes:1", "b:outcomes:1", "a:result", "b:result", "a:slotend",
+    "b:slotend", "a:end:1", "b:end:1"
+  };
+  ASSERT_EQ(expected, log);
+}
+
+// _____________________________________________________________________________
+TEST(TeeOutputModuleTest, deletesChildren) {
+  // Scenario: a tee with one child is destroyed, the child must be destroyed
+  //  as well.
+  // Why: the tee owns its children.
+  std::vector<std::string> log;
+  bool destroyed = false;
+  {
+    TeeOutputModule tee;
+    tee.addModule(new RecordingOutputModule("a", &log, &destroyed));
+    ASSERT_FALSE(destroyed);
+  }
+  ASSERT_TRUE(destroyed);
+}
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Notifies the given module of a single
+//  slot in which the given component idles or, if collision is set, receives a
+//  collision.
+static void notifySlot(OutputModule* module, std::size_t slot,
+    const NetworkSetup& setup, const Component* comp, bool collision) {
+  IntentionAssignment intent(&setup);
+  intent.setTraitFor(comp, ComponentIntention(setup,
+    collision ? IntentionType::LISTEN : IntentionType::IDLE, 0, nullptr));
+  NetworkState state(&setup);
+  state.setTraitFor(comp, ComponentAction(setup,
+    collision ? ActionType::COLLISION : ActionType::IDLE, 0, nullptr));
+  std::vector<NetworkState> outcomes;
+  outcomes.push_back(state);
+
+  module->onSlotBegin(slot);
+  module->onIntentChosen(intent);
+  module->onTransitionComputed(outcomes);
+  module->onResultChosen(state);
+  module->onSlotEnd();
+}
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Runs the given number of slots through
+//  the given filter and returns the slot numbers that reached the child. The
+//  slots in which a collision happens are given as a set of slot numbers.
+static std::vector<std::string> runFilter(
+    std::function<void(FilterOutputModule*)> configure, std::size_t numSlots,
+    const std::vector<std::size_t>& collisions) {
+  NetworkSetup setup(5);
+  Component comp;
+  setup.registerComponent(&comp);
+  TrivialNetworkTopology tnt;
+
+  std::vector<std::string> log;
+  FilterOutputModule filter(new RecordingOutputModule("f", &log));
+  configure(&filter);
+  filter.onSimulationBegin(numSlots, &setup, &tnt);
+  for (std::size_t i = 0; i < numSlots; i++) {
+    bool collision = false;
+    for (std::size_t c : collisions) {
+      collision = collision || c == i;
+    }
+    notifySlot(&filter, i, setup, &comp, collision);
+  }
+  filter.onSimulationEnd(numSlots);
+
+  // Reduce the log to the slot numbers, but check that every slot is
+  //  complete.
+  std::vector<std::string> slots;
+  for (std::size_t i = 0; i < log.size(); i++) {
+    if (log[i].find("f:slot:") == 0) {
+      slots.push_back(log[i].substr(7));
+      EXPECT_EQ("f:intent", log[i + 1]);
+      EXPECT_EQ("f:outcomes:1", log[i + 2]);
+      EXPECT_EQ("f:result", log[i + 3]);
+      EXPECT_EQ("f:slotend", log[i + 4]);
+    }
+  }
+  EXPECT_EQ("f:begin:" + std::to_string(numSlots), log.front());
+  EXPECT_EQ("f:end:" + std::to_string(numSlots), log.back());
+  return slots;
+}
+
+// _____________________________________________________________________________
+TEST(FilterOutputModuleDeathTest, invalidArguments) {
+  // Scenario: invalid child, empty slot range, and zero stride fail.
+  // Why: abnormal exit points of constructor and methods.
+  ASSERT_DEATH(FilterOutputModule(nullptr), "can not filter nullptr");
+  std::vector<std::string> log;
+  FilterOutputModule filter(new RecordingOutputModule("f", &log));
+  ASSERT_DEATH(filter.setSlotRange(5, 4), "empty slot range");
+  ASSERT_DEATH(filter.setStride(0), "stride must be greater than zero");
+}
+
+// _____________________________________________________________________________
+TEST(FilterOutputModuleTest, selectsEverythingByDefault) {
+  // Scenario: an unconfigured filter forwards every slot.
+  // Why: regular case (default).
+  std::vector<std::string> expected = {"0", "1", "2"};
+  ASSERT_EQ(expected, runFilter([](FilterOutputModule* f) {}, 3, {}));
+}
+
+// _____________________________________________________________________________
+TEST(FilterOutputModuleTest, setSlotRange) {
+  // Scenario: we select a range in the middle, a single slot, and a range
+  //  reaching beyond the simulation.
+  // Why: regular case and corner cases of the range.
+  std::vector<std::string> expected1 = {"2", "3", "4"};
+  ASSERT_EQ(expected1, runFilter([](FilterOutputModule* f) {
+    f->setSlotRange(2, 4);
+  }, 10, {}));
+  std::vector<std::string> expected2 = {"0"};
+  ASSERT_EQ(expected2, runFilter([](FilterOutputModule* f) {
+    f->setSlotRange(0, 0);
+  }, 10, {}));
+  std::vector<std::string> expected3 = {"8", "9"};
+  ASSERT_EQ(expected3, runFilter([](FilterOutputModule* f) {
+    f->setSlotRange(8, 100);
+  }, 10, {}));
+}
+
+// _____________________________________________________________________________
+TEST(FilterOutputModuleTest, clipsSkippedSlots) {
+  // Scenario: slots 2 to 7 are skipped, repeating an idle and a colliding
+  //  network state, while the filter selects slots 3 to 5 or 9 onwards.
+  // Why: only the skipped slots in the range may be forwarded, and the cycle
+  //  must be shifted to the first forwarded slot.
+  NetworkSetup setup(5);
+  Component comp;
+  setup.registerComponent(&comp);
+  TrivialNetworkTopology tnt;
+  std::vector<NetworkState> cycle(2, NetworkState(&setup));
+  cycle[0].setTraitFor(&comp, ComponentAction(setup, ActionType::IDLE, 0,
+    nullptr));
+  cycle[1].setTraitFor(&comp, ComponentAction(setup, ActionType::COLLISION, 0,
+    nullptr));
+
+  std::vector<std::string> log;
+  FilterOutputModule filter(new RecordingOutputModule("f", &log));
+  filter.setSlotRange(3, 5);
+  filter.onSimulationBegin(8, &setup, &tnt);
+  filter.onSlotsSkipped(2, 6, cycle);
+  ASSERT_EQ("f:skipped:3:3:(COL)", log.back());
+
+  FilterOutputModule later(new RecordingOutputModule("l", &log));
+  later.setSlotRange(9, 20);
+  later.onSimulationBegin(8, &setup, &tnt);
+  later.onSlotsSkipped(2, 6, cycle);
+  ASSERT_EQ("l:begin:8", log.back());
+}
+
+// _____________________________________________________________________________
+TEST(FilterOutputModuleTest, setStride) {
+  // Scenario: we select every third slot, with and without slot range.
+  // Why: regular case, and the stride counts from the beginning of the range.
+  std::vector<std::string> expected1 = {"0", "3", "6", "9"};
+  ASSERT_EQ(expected1, runFilter([](FilterOutputModule* f) {
+    f->setStride(3);
+  }, 10, {}));
+  std::vector<std::string> expected2 = {"2", "5"};
+  ASSERT_EQ(expected2, runFilter([](FilterOutputModule* f) {
+    f->setSlotRange(2, 6);
+    f->setStride(3);
+  }, 10, {}));
+}
+
+// _____________________________________________________________________________
+TEST(FilterOutputModuleTest, setPredicate) {
+  // Scenario: we select slots with collisions, with none, one, and two such
+  //  slots.
+  // Why: corner case (nothing selected) and regular cases.
+  auto configure = [](FilterOutputModule* f) {
+    f->setPredicate(FilterOutputModule::anyAction(ActionType::COLLISION));
+  };
+  std::vector<std::string> expected1;
+  ASSERT_EQ(expected1, runFilter(configure, 10, {}));
+  std::vector<std::string> expected2 = {"4"};
+  ASSERT_EQ(expected2, runFilter(configure, 10, {4}));
+  std::vector<std::string> expected3 = {"0", "7"};
+  ASSERT_EQ(expected3, runFilter(configure, 10, {0, 7}));
+}
+
+// _____________________________________________________________________________
+TEST(FilterOutputModuleTest, setContext) {
+  // Scenario: we select two slots before and one slot after each collision.
+  //  the collisions are placed such that the context is cut off at the
+  //  beginning and such that contexts overlap.
+  // Why: regular case and the corner cases of context.
+  auto configure = [](FilterOutputModule* f) {
+    f->setPredicate(FilterOutputModule::anyAction(ActionType::COLLISION));
+    f->setContext(2, 1);
+  };
+  std::vector<std::string> expected = {"0", "1", "2", "5", "6", "7", "8", "9",
+    "10"};
+  ASSERT_EQ(expected, runFilter(configure, 15, {1, 7, 9}));
+}
+
+// _____________________________________________________________________________
+TEST(FilterOutputModuleTest, protocolLogIsHeldWithSlot) {
+  // Scenario: we select one slot before each collision. every slot has a
+  //  protocol log message, which arrives before the decision.
+  // Why: held back slots must keep their protocol log, and unselected slots
+  //  must drop it.
+  NetworkSetup setup(5);
+  Component comp;
+  setup.registerComponent(&comp);
+  TrivialNetworkTopology tnt;
+
+  std::vector<std::string> log;
+  FilterOutputModule filter(new RecordingOutputModule("f", &log));
+  filter.setPredicate(FilterOutputModule::anyAction(ActionType::COLLISION));
+  filter.setContext(1, 0);
+  filter.onSimulationBegin(3, &setup, &tnt);
+  for (std::size_t i = 0; i < 3; i++) {
+    filter.onSlotBegin(i);
+    filter.onProtocolLog("c", std::to_string(i));
+    bool collision = i == 2;
+    IntentionAssignment intent(&setup);
+    intent.setTraitFor(&comp, ComponentIntention(setup, IntentionType::IDLE, 0,
+      nullptr));
+    NetworkState state(&setup);
+    state.setTraitFor(&comp, ComponentAction(setup,
+      collision ? ActionType::COLLISION : ActionType::IDLE, 0, nullptr));
+    std::vector<NetworkState> outcomes(1, state);
+    filter.onIntentChosen(intent);
+    filter.onTransitionComputed(outcomes);
+    filter.onResultChosen(state);
+    filter.onSlotEnd();
+  }
+
+  std::vector<std::string> expected = {"f:begin:3",
+    "f:slot:1", "f:log:c:1", "f:intent", "f:outcomes:1", "f:result",
+    "f:slotend",
+    "f:slot:2", "f:log:c:2", "f:intent", "f:outcomes:1", "f:result",
+    "f:slotend"};
+  ASSERT_EQ(expected, log);
+}
+
+// _____________________________________________________________________________
+TEST(FilterOutputModuleTest, anyAction) {
+  // Scenario: we check the predicate on states with and without the type.
+  // Why: regular cases.
+  NetworkSetup setup(5);
+  Component comp1;
+  Component comp2;
+  setup.registerComponent(&comp1);
+  setup.registerComponent(&comp2);
+  NetworkState state(&setup);
+  state.setTraitFor(&comp1, ComponentAction(setup, ActionType::IDLE, 0,
+    nullptr));
+  state.setTraitFor(&comp2, ComponentAction(setup, ActionType::SILENCE, 0,
+    nullptr));
+
+  ASSERT_TRUE(FilterOutputModule::anyAction(ActionType::SILENCE)(state));
+  ASSERT_TRUE(FilterOutputModule::anyAction(ActionType::IDLE)(state));
+  ASSERT_FALSE(FilterOutputModule::anyAction(ActionType::COLLISION)(state));
+}
+
+// _____________________________________________________________________________
+TEST(StatisticsOutputModuleTest, counts) {
+  // Scenario: we record five slots of two components, in which the first
+  //  component collides in slots 1 and 3 and idles otherwise, and the second
+  //  component always idles. we use samples of two slots.
+  // Why: regular case, with a sample that is not completely filled.
+  NetworkSetup setup(5);
+  Component comp1;
+  Component comp2;
+  setup.registerComponent(&comp1);
+  setup.registerComponent(&comp2);
+  TrivialNetworkTopology tnt;
+
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path);
+  StatisticsOutputModule stats(sink, 2);
+  stats.onSimulationBegin(5, &setup, &tnt);
+  for (std::size_t slot = 0; slot < 5; slot++) {
+    bool collision = slot % 2 == 1;
+    IntentionAssignment intent(&setup);
+    intent.setTraitFor(&comp1, ComponentIntention(setup,
+      IntentionType::LISTEN, 0, nullptr));
+    intent.setTraitFor(&comp2, ComponentIntention(setup, IntentionType::IDLE,
+      0, nullptr));
+    NetworkState state(&setup);
+    state.setTraitFor(&comp1, ComponentAction(setup,
+      collision ? ActionType::COLLISION : ActionType::SILENCE, 0, nullptr));
+    state.setTraitFor(&comp2, ComponentAction(setup, ActionType::IDLE, 0,
+      nullptr));
+    std::vector<NetworkState> outcomes;
+    outcomes.push_back(state);
+
+    stats.onSlotBegin(slot);
+    stats.onIntentChosen(intent);
+    stats.onTransitionComputed(outcomes);
+    stats.onResultChosen(state);
+    stats.onSlotEnd();
+  }
+  stats.onSimulationEnd(5);
+
+  ASSERT_EQ(5, stats.getSlotCount());
+  ASSERT_EQ(2, stats.getTotal(ActionType::COLLISION));
+  ASSERT_EQ(3, stats.getTotal(ActionType::SILENCE));
+  ASSERT_EQ(5, stats.getTotal(ActionType::IDLE));
+  ASSERT_EQ(0, stats.getTotal(ActionType::SENT));
+  ASSERT_EQ(2, stats.getComponentCount(0, ActionType::COLLISION));
+  ASSERT_EQ(0, stats.getComponentCount(0, ActionType::IDLE));
+  ASSERT_EQ(5, stats.getComponentCount(1, ActionType::IDLE));
+  ASSERT_EQ(3, stats.getSampleCount());
+  ASSERT_EQ(1, stats.getSampleCount(0, ActionType::COLLISION));
+  ASSERT_EQ(1, stats.getSampleCount(1, ActionType::COLLISION));
+  ASSERT_EQ(0, stats.getSampleCount(2, ActionType::COLLISION));
+  ASSERT_EQ(1, stats.getSampleCount(2, ActionType::SILENCE));
+  ASSERT_EQ(2, stats.getSampleCount(0, ActionType::IDLE));
+
+  // The summary contains the totals and the table rows.
+  delete sink;
+  std::string summary = readFile(path);
+  ASSERT_NE(std::string::npos, summary.find("COLLISION 2\n"));
+  ASSERT_NE(std::string::npos, summary.find("default 0 3 2 0 0 0\n"));
+  ASSERT_NE(std::string::npos, summary.find("4 1 1 0 0 0 0 0\n"));
+  unlink(path.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(StatisticsOutputModuleTest, extrapolatesSkippedSlots) {
+  // Scenario: we record an idle and a colliding slot, then skip five slots
+  //  that repeat both. we use samples of two slots.
+  // Why: skipped slots must be counted as if they were recorded.
+  NetworkSetup setup(5);
+  Component comp;
+  setup.registerComponent(&comp);
+  TrivialNetworkTopology tnt;
+  std::vector<NetworkState> cycle(2, NetworkState(&setup));
+  cycle[0].setTraitFor(&comp, ComponentAction(setup, ActionType::IDLE, 0,
+    nullptr));
+  cycle[1].setTraitFor(&comp, ComponentAction(setup, ActionType::COLLISION, 0,
+    nullptr));
+
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path);
+  StatisticsOutputModule stats(sink, 2);
+  stats.onSimulationBegin(7, &setup, &tnt);
+  notifySlot(&stats, 0, setup, &comp, false);
+  notifySlot(&stats, 1, setup, &comp, true);
+  stats.onSlotsSkipped(2, 5, cycle);
+  stats.onSimulationEnd(7);
+
+  ASSERT_EQ(7, stats.getSlotCount());
+  ASSERT_EQ(5, stats.getSkippedCount());
+  ASSERT_EQ(4, stats.getTotal(ActionType::IDLE));
+  ASSERT_EQ(3, stats.getComponentCount(0, ActionType::COLLISION));
+  ASSERT_EQ(4, stats.getSampleCount());
+  ASSERT_EQ(1, stats.getSampleCount(2, ActionType::COLLISION));
+  ASSERT_EQ(1, stats.getSampleCount(3, ActionType::IDLE));
+  ASSERT_EQ(0, stats.getSampleCount(3, ActionType::COLLISION));
+  delete sink;
+  ASSERT_NE(std::string::npos, readFile(path).find("5 of the slots"));
+  unlink(path.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(StatisticsOutputModuleTest, channelUtilization) {
+  // Scenario: two components both send in slot 0, idle in slot 1 and one of
+  //  them sends in slot 2. Then three slots repeating slots 1 and 2 are
+  //  skipped. we use samples of two slots.
+  // Why: a slot is busy once, no matter how many components send in it, and
+  //  skipped slots are extrapolated.
+  NetworkSetup setup(5);
+  Component comp1;
+  Component comp2;
+  setup.registerComponent(&comp1);
+  setup.registerComponent(&comp2);
+  TrivialNetworkTopology tnt;
+  std::vector<NetworkState> states(3, NetworkState(&setup));
+  for (std::size_t slot = 0; slot < 3; slot++) {
+    for (const Component* comp : { &comp1, &comp2 }) {
+      bool sent = slot == 0 || (slot == 2 && comp == &comp1);
+      states[slot].setTraitFor(comp, ComponentAction(setup,
+        sent ? ActionType::SENT : ActionType::IDLE, 0, nullptr));
+    }
+  }
+
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path);
+  StatisticsOutputModule stats(sink, 2);
+  stats.onSimulationBegin(6, &setup, &tnt);
+  for (std::size_t slot = 0; slot < 3; slot++) {
+    IntentionAssignment intent(&setup);
+    std::vector<NetworkState> outcomes(1, states[slot]);
+    stats.onSlotBegin(slot);
+    stats.onIntentChosen(intent);
+    stats.onTransitionComputed(outcomes);
+    stats.onResultChosen(states[slot]);
+    stats.onSlotEnd();
+  }
+  stats.onSlotsSkipped(3, 3, { states[1], states[2] });
+  stats.onSimulationEnd(6);
+
+  ASSERT_EQ(3, stats.getSampleCount());
+  ASSERT_EQ(1, stats.getBusySlotCount(0));
+  ASSERT_EQ(2, stats.getSampleCount(0, ActionType::SENT));
+  ASSERT_EQ(1, stats.getBusySlotCount(1));
+  ASSERT_EQ(1, stats.getBusySlotCount(2));
+  ASSERT_EQ(1, stats.getSampleCount(2, ActionType::SENT));
+  delete sink;
+  std::string summary = readFile(path);
+  ASSERT_NE(std::string::npos, summary.find(" CANCELLED BUSY\n"));
+  ASSERT_NE(std::string::npos, summary.find("\n0 2 0 0 0 2 0 1\n"));
+  unlink(path.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(StatisticsOutputModuleTest, noTimeSeries) {
+  // Scenario: a sample size of 0 disables the time series.
+  // Why: corner case.
+  NetworkSetup setup(5);
+  Component comp;
+  setup.registerComponent(&comp);
+  TrivialNetworkTopology tnt;
+
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path);
+  StatisticsOutputModule stats(sink, 0);
+  stats.onSimulationBegin(3, &setup, &tnt);
+  for (std::size_t slot = 0; slot < 3; slot++) {
+    notifySlot(&stats, slot, setup, &comp, false);
+  }
+  stats.onSimulationEnd(3);
+  ASSERT_EQ(3, stats.getTotal(ActionType::IDLE));
+  ASSERT_EQ(0, stats.getSampleCount());
+  delete sink;
+  ASSERT_EQ(std::string::npos, readFile(path).find("per 0 slot"));
+  unlink(path.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(StatisticsOutputModuleDeathTest, invalidIndices) {
+  // Scenario: accessing counters of invalid components and samples fails.
+  // Why: abnormal exit points of methods.
+  NetworkSetup setup(5);
+  Component comp;
+  setup.registerComponent(&comp);
+  TrivialNetworkTopology tnt;
+  StatisticsOutputModule stats(nullptr, 1);
+  stats.onSimulationBegin(1, &setup, &tnt);
+  ASSERT_DEATH(stats.getComponentCount(1, ActionType::IDLE),
+    "invalid component index");
+  ASSERT_DEATH(stats.getSampleCount(0, ActionType::IDLE),
+    "invalid sample index");
+  ASSERT_DEATH(stats.getBusySlotCount(0), "invalid sample index");
+}
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Records two slots of two components in
+//  the given format and returns the output. The components have IDs that need
+//  escaping. In slot 0, the first component sends a message that the second
+//  component receives. In slot 1, both components idle. If requested, three
+//  slots repeating slot 1 are skipped afterwards.
+static std::string runRecords(RecordOutputModule::Format format,
+    bool skip = false) {
+  // Types for this test.
+  class TestComponent : public Component {
+   public:
+    explicit TestComponent(const std::string& id) : mId(id) {}
+
+   private:
+    std::string doGetId() const override { return mId; }
+    std::string mId;
+  };
+  class TestMessage : public Message {
+   private:
+    std::string doToString() const override { return "say \"hi\"\n"; }
+  };
+
+  NetworkSetup setup(5);
+  TestComponent comp1("a,b");
+  TestComponent comp2("c");
+  TestMessage msg;
+  setup.registerComponent(&comp1);
+  setup.registerComponent(&comp2);
+  setup.registerMessage(&msg);
+  TrivialNetworkTopology tnt;
+
+  std::string path = createTempFile();
+  Sink* sink = Sink::openFile(path);
+  RecordOutputModule records(format, sink);
+  records.onSimulationBegin(2, &setup, &tnt);
+  for (std::size_t slot = 0; slot < 2; slot++) {
+    IntentionAssignment intent(&setup);
+    NetworkState state(&setup);
+    if (slot == 0) {
+      intent.setTraitFor(&comp1, ComponentIntention(setup, IntentionType::SEND,
+        2, &msg));
+      intent.setTraitFor(&comp2, ComponentIntention(setup,
+        IntentionType::LISTEN, 0, nullptr));
+      state.setTraitFor(&comp1, ComponentAction(setup, ActionType::SENT, 2,
+        &msg));
+      state.setTraitFor(&comp2, ComponentAction(setup, ActionType::RECEIVED, 2,
+        &msg));
+    } else {
+      for (const Component* comp : { &comp1, &comp2 }) {
+        intent.setTraitFor(comp, ComponentIntention(setup,
+          IntentionType::IDLE, 0, nullptr));
+        state.setTraitFor(comp, ComponentAction(setup, ActionType::IDLE, 0,
+          nullptr));
+      }
+    }
+    std::vector<NetworkState> outcomes;
+    outcomes.push_back(state);
+
+    records.onSlotBegin(slot);
+    records.onIntentChosen(intent);
+    records.onTransitionComputed(outcomes);
+    records.onResultChosen(state);
+    records.onSlotEnd();
+    if (skip && slot == 1) {
+      records.onSlotsSkipped(2, 3, outcomes);
+    }
+  }
+  records.onSimulationEnd(skip ? 5 : 2);
+  delete sink;
+  std::string result = readFile(path);
+  unlink(path.c_str());
+  return result;
+}
+
+// _____________________________________________________________________________
+TEST(RecordOutputModuleTest, jsonLines) {
+  // Scenario: we record two slots as JSON lines.
+  // Why: covers records with and without message, and escaping.
+  ASSERT_EQ(
+    "{\"slot\":0,\"records\":["
+    "{\"component\":\"a,b\",\"intent\":\"SEND\",\"action\":\"SENT\","
+    "\"tic\":2,\"message\":\"say \\\"hi\\\"\\u000a\"},"
+    "{\"component\":\"c\",\"intent\":\"LISTEN\",\"action\":\"RECEIVED\","
+    "\"tic\":2,\"message\":\"say \\\"hi\\\"\\u000a\"}]}\n"
+    "{\"slot\":1,\"records\":["
+    "{\"component\":\"a,b\",\"intent\":\"IDLE\",\"action\":\"IDLE\","
+    "\"tic\":null,\"message\":null},"
+    "{\"component\":\"c\",\"intent\":\"IDLE\",\"action\":\"IDLE\","
+    "\"tic\":null,\"message\":null}]}\n",
+    runRecords(RecordOutputModule::Format::JSON_LINES));
+}
+
+// _____________________________________________________________________________
+TEST(RecordOutputModuleTest, csv) {
+  // Scenario: we record two slots as CSV.
+  // Why: covers records with and without message, and quoting.
+  ASSERT_EQ(
+    "slot,component,intent,action,tic,message\n"
+    "0,\"a,b\",SEND,SENT,2,\"say \"\"hi\"\"\n\"\n"
+    "0,c,LISTEN,RECEIVED,2,\"say \"\"hi\"\"\n\"\n"
+    "1,\"a,b\",IDLE,IDLE,,\n"
+    "1,c,IDLE,IDLE,,\n",
+    runRecords(RecordOutputModule::Format::CSV));
+}
+
+// _____________________________________________________________________________
+TEST(RecordOutputModuleTest, skippedSlots) {
+  // Scenario: we record two slots and skip three slots in both formats.
+  // Why: skipped slots must be visible in the records, as they would
+  //  otherwise be missing silently.
+  std::string json = runRecords(RecordOutputModule::Format::JSON_LINES, true);
+  ASSERT_EQ(std::string::npos, json.find("\"slot\":2,\"records\""));
+  ASSERT_EQ("{\"slot\":2,\"skipped\":3,\"period\":1}\n",
+    json.substr(json.rfind('{')));
+  std::string csv = runRecords(RecordOutputModule::Format::CSV, true);
+  ASSERT_EQ("1,c,IDLE,IDLE,,\n2,,SKIPPED,SKIPPED,3,\n",
+    csv.substr(csv.find("1,c,")));
+}
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Writes a text trace of the given number
+//  of slots with an index of the given number of slots per entry, and opens
+//  a reader for it. The paths of the files are stored in the given strings.
+static TraceReader* writeIndexedTrace(std::size_t numSlots,
+    std::size_t slotsPerEntry, std::string* tracePath,
+    std::string* indexPath) {
+  NetworkSetup setup(5);
+  Component comp;
+  setup.registerComponent(&comp);
+  TrivialNetworkTopology tnt;
+
+  *tracePath = createTempFile();
+  *indexPath = createTempFile();
+  Sink* traceSink = Sink::openFile(*tracePath, 16);
+  Sink* indexSink = Sink::openFile(*indexPath, 16);
+  IndexOutputModule index(new StdOutOutputModule(traceSink), traceSink,
+    indexSink, slotsPerEntry);
+  index.onSimulationBegin(numSlots, &setup, &tnt);
+  for (std::size_t slot = 0; slot < numSlots; slot++) {
+    notifySlot(&index, slot, setup, &comp, false);
+  }
+  index.onSimulationEnd(numSlots);
+  delete traceSink;
+  delete indexSink;
+  return TraceReader::open(*tracePath, *indexPath);
+}
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Gets the slot numbers of the slots in
+//  the given part of a text trace.
+static std::vector<std::size_t> getTextSlots(const char* data,
+    std::size_t length) {
+  std::vector<std::size_t> slots;
+  std::string part(data, length);
+  const std::string marker("# Beginning simulation of slot ");
+  for (std::size_t pos = part.find(marker); pos != std::string::npos;
+      pos = part.find(marker, pos + 1)) {
+    slots.push_back(std::stoul(part.substr(pos + marker.size())));
+  }
+  return slots;
+}
+
+// _____________________________________________________________________________
+TEST(IndexOutputModuleDeathTest, invalidArguments) {
+  // Scenario: creating an index without child, sinks or with zero slots per
+  //  entry fails.
+  // Why: abnormal exit points of constructor.
+  Sink* sink = Sink::getStdOut();
+  ASSERT_DEATH(IndexOutputModule(nullptr, sink, sink), "nullptr");
+  ASSERT_DEATH(IndexOutputModule(new StdOutOutputModule(), nullptr, sink),
+    "requires trace and index sinks");
+  ASSERT_DEATH(IndexOutputModule(new StdOutOutputModule(), sink, sink, 0),
+    "greater than zero");
+}
+
+// _____________________________________________________________________________
+TEST(TraceReaderTest, findSlotsWithSingleSlotEntries) {
+  // Scenario: we index each of 10 slots and look up single slots and ranges,
+  //  including ranges partially or completely outside of the trace.
+  // Why: with one slot per entry, the parts are exact.
+  std::string tracePath;
+  std::string indexPath;
+  TraceReader* reader = writeIndexedTrace(10, 1, &tracePath, &indexPath);
+  ASSERT_NE(nullptr, reader);
+  ASSERT_EQ(1, reader->getSlotsPerEntry());
+  ASSERT_EQ(10, reader->getEntryCount());
+  ASSERT_EQ(7, reader->getEntrySlot(7));
+
+  std::size_t length = 0;
+  const char* data = reader->findSlots(4, 4, &length);
+  ASSERT_NE(nullptr, data);
+  ASSERT_EQ(std::vector<std::size_t>({ 4 }), getTextSlots(data, length));
+  ASSERT_EQ(0, std::string(data, length).find("# Beginning"));
+
+  data = reader->findSlots(8, 20, &length);
+  ASSERT_EQ(std::vector<std::size_t>({ 8, 9 }), getTextSlots(data, length));
+
+  // All slots span the trace except for the simulation header.
+  std::string trace = readFile(tracePath);
+  data = reader->findSlots(0, 9, &length);
+  ASSERT_EQ(trace.substr(trace.find("# Beginning")), std::string(data, length));
+
+  ASSERT_EQ(nullptr, reader->findSlots(10, 20, &length));
+  ASSERT_EQ(0, length);
+  delete reader;
+  unlink(tracePath.c_str());
+  unlink(indexPath.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(TraceReaderTest, findSlotsWithMultiSlotEntries) {
+  // Scenario: we index every third of 10 slots and look up slots in the
+  //  middle of entries.
+  // Why: the parts then contain the other slots of the entries.
+  std::string tracePath;
+  std::string indexPath;
+  TraceReader* reader = writeIndexedTrace(10, 3, &tracePath, &indexPath);
+  ASSERT_NE(nullptr, reader);
+  ASSERT_EQ(3, reader->getSlotsPerEntry());
+  ASSERT_EQ(4, reader->getEntryCount());
+  ASSERT_EQ(9, reader->getEntrySlot(3));
+
+  std::size_t length = 0;
+  const char* data = reader->findSlots(4, 4, &length);
+  ASSERT_EQ(std::vector<std::size_t>({ 3, 4, 5 }), getTextSlots(data, length));
+  data = reader->findSlots(5, 7, &length);
+  ASSERT_EQ(std::vector<std::size_t>({ 3, 4, 5, 6, 7, 8 }),
+    getTextSlots(data, length));
+  data = reader->findSlots(9, 9, &length);
+  ASSERT_EQ(std::vector<std::size_t>({ 9 }), getTextSlots(data, length));
+  delete reader;
+  unlink(tracePath.c_str());
+  unlink(indexPath.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(TraceReaderTest, openFailures) {
+  // Scenario: we open a missing trace, a missing index, and an index that is
+  //  not an index.
+  // Why: abnormal exit points of open.
+  std::string path = createTempFile();
+  {
+    std::ofstream out(path);
+    out << "no index at all";
+  }
+  ASSERT_EQ(nullptr, TraceReader::open("/nonexistent/trace", path));
+  ASSERT_EQ(nullptr, TraceReader::open(path, "/nonexistent/index"));
+  ASSERT_EQ(nullptr, TraceReader::open(path, path));
+  unlink(path.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(TraceReaderTest, openDamagedIndex) {
+  // Scenario: we index 10 slots and damage the index by swapping the offsets
+  //  of two entries, by decreasing the slot of an entry, by moving an offset
+  //  behind the trace, and by truncating the trace of an index without end
+  //  entry.
+  // Why: a damaged index is rejected by open instead of failing in findSlots.
+  std::string tracePath;
+  std::string indexPath;
+  delete writeIndexedTrace(10, 1, &tracePath, &indexPath);
+  const std::string index = readFile(indexPath);
+  const std::string trace = readFile(tracePath);
+  const std::size_t headerSize = sizeof(IndexOutputModule::kMagic)
+    + sizeof(std::uint64_t);
+  const std::size_t entrySize = 2 * sizeof(std::uint64_t);
+
+  // Writes the files and opens a reader for them.
+  auto openDamaged = [&tracePath, &indexPath](const std::string& damagedTrace,
+      const std::string& damagedIndex) {
+    std::ofstream(tracePath, std::ios::binary) << damagedTrace;
+    std::ofstream(indexPath, std::ios::binary) << damagedIndex;
+    return TraceReader::open(tracePath, indexPath);
+  };
+  // Sets the given word of the given entry.
+  auto setWord = [headerSize, entrySize](std::string* data, std::size_t entry,
+      std::size_t word, std::uint64_t value) {
+    std::memcpy(&(*data)[headerSize + entry * entrySize
+      + word * sizeof(value)], &value, sizeof(value));
+  };
+  auto getWord = [&index, headerSize, entrySize](std::size_t entry,
+      std::size_t word) {
+    std::uint64_t value = 0;
+    std::memcpy(&value, &index[headerSize + entry * entrySize
+      + word * sizeof(value)], sizeof(value));
+    return value;
+  };
+
+  TraceReader* reader = openDamaged(trace, index);
+  ASSERT_NE(nullptr, reader);
+  delete reader;
+
+  std::string damaged = index;
+  setWord(&damaged, 3, 1, getWord(4, 1));
+  setWord(&damaged, 4, 1, getWord(3, 1));
+  ASSERT_EQ(nullptr, openDamaged(trace, damaged));
+
+  damaged = index;
+  setWord(&damaged, 5, 0, 2);
+  ASSERT_EQ(nullptr, openDamaged(trace, damaged));
+
+  damaged = index;
+  setWord(&damaged, 9, 1, trace.size() + 1);
+  ASSERT_EQ(nullptr, openDamaged(trace, damaged));
+
+  damaged = index.substr(0, index.size() - entrySize);
+  ASSERT_EQ(nullptr, openDamaged(trace.substr(0, getWord(5, 1)), damaged));
+  reader = openDamaged(trace, damaged);
+  ASSERT_NE(nullptr, reader);
+  delete reader;
+
+  unlink(tracePath.c_str());
+  unlink(indexPath.c_str());
+}
@@ -0,0 +1,313 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "anl/core/replay.h"
+#include "anl/core/simulator.h"
+#include "anl/core/topologies.h"
+#include "anl/output/output.h"
+#include "anl/output/sink.h"
+
+// We do this here as a test can under no circumstance pollute the namespace as
+// it is never included.
+using namespace Core;  // NOLINT
+
+// _____________________________________________________________________________
+// Message for the tests in this file.
+class ReplayTestMessage : public Message {
+ public:
+  explicit ReplayTestMessage(const std::string& text) : mText(text) {}
+
+ private:
+  std::string doToString() const override { return mText; }
+  std::vector<std::string> doToXML() const override
+    { return { "<text>" + mText + "</text>" }; }
+
+  std::string mText;
+};
+
+// _____________________________________________________________________________
+// Component for the tests in this file. Sends its message every period-th
+//  slot in the given tic and listens otherwise. It is always stable.
+class ReplayTestComponent : public Component {
+ public:
+  ReplayTestComponent(const std::string& id, const Message* msg,
+    std::size_t period, std::size_t tic) : mId(id), mMsg(msg),
+      mPeriod(period), mTic(tic) {}
+
+ private:
+  void doAct(ANLView* view) override {
+    if (mMsg != nullptr && view->getSlotNumber() % mPeriod == 0) {
+      view->send(mMsg, mTic, mTic != 0);
+    } else {
+      view->listen();
+    }
+  }
+  bool doIsStable() const override { return true; }
+  std::string doGetId() const override { return mId; }
+  std::vector<std::string> doToXML() const override
+    { return { "<name>" + mId + "</name>" }; }
+
+  std::string mId;
+  const Message* mMsg;
+  std::size_t mPeriod;
+  std::size_t mTic;
+};
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Creates an empty temporary file.
+static std::string createTempFile() {
+  char path[] = "/tmp/anlimpl_replay_test_XXXXXX";
+  int fd = mkstemp(path);
+  close(fd);
+  return path;
+}
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Reads the whole content of a file.
+static std::string readFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream sstr;
+  sstr << in.rdbuf();
+  return sstr.str();
+}
+
+// _____________________________________________________________________________
+// Helper for the tests in this file. Simulates three components on a line
+//  for the given number of slots. Writes the intent log to logPath and the
+//  XML output to xmlPath.
+static void recordSimulation(std::size_t numSlots, const std::string& logPath,
+    const std::string& xmlPath) {
+  ReplayTestMessage msg1("hello");
+  ReplayTestMessage msg2("world");
+  ReplayTestComponent compA("A", &msg1, 2, 1);
+  ReplayTestComponent compB("B", nullptr, 1, 0);
+  ReplayTestComponent compC("C", &msg2, 3, 0);
+  Component* comps[] = { &compA, &compB, &compC };
+  const Message* msgs[] = { &msg1, &msg2 };
+  ExplicitNetworkTopology ent;
+  ent.addEdge(&compA, &compB);
+  ent.addEdge(&compB, &compA);
+  ent.addEdge(&compB, &compC);
+  ent.addEdge(&compC, &compB);
+
+  Output::Sink* logSink = Output::Sink::openFile(logPath);
+  Output::Sink* xmlSink = Output::Sink::openFile(xmlPath);
+  Output::TeeOutputModule tee;
+  tee.addModule(new Output::IntentLogOutputModule(logSink));
+  tee.addModule(new Output::XMLOutputModule(xmlSink));
+
+  Simulator sim(5);
+  sim.useTopology(&ent);
+  sim.useOutputModule(&tee);
+  sim.useComponents(comps, 3);
+  sim.useMessages(msgs, 2);
+  sim.run(numSlots);
+  delete logSink;
+  delete xmlSink;
+}
+
+// _____________________________________________________________________________
+TEST(IntentLogReplayerTest, replayReproducesOutput) {
+  // Scenario: we record a simulation with sending, forced sending and
+  //  receiving components, and replay it into a second XML output.
+  // Why: the replay must reproduce the simulation without its components.
+  std::string logPath = createTempFile();
+  std::string xmlPath = createTempFile();
+  std::string replayPath = createTempFile();
+  recordSimulation(7, logPath, xmlPath);
+
+  IntentLogReplayer* replayer = IntentLogReplayer::open(logPath);
+  ASSERT_NE(nullptr, replayer);
+  ASSERT_EQ(7, replayer->getIntendedSlots());
+  ASSERT_EQ(5, replayer->getSetup().getTicsPerSlot());
+  ASSERT_EQ(3, replayer->getSetup().getComponentCount());
+
+  Output::Sink* replaySink = Output::Sink::openFile(replayPath);
+  Output::XMLOutputModule xml(replaySink);
+  ASSERT_EQ(7, replayer->run(&xml, ANLSemantics::NAIVE));
+  delete replaySink;
+  ASSERT_EQ(readFile(xmlPath), readFile(replayPath));
+
+  // Replaying again produces the same result.
+  replaySink = Output::Sink::openFile(replayPath);
+  Output::XMLOutputModule xml2(replaySink);
+  ASSERT_EQ(7, replayer->run(&xml2, ANLSemantics::NAIVE));
+  delete replaySink;
+  ASSERT_EQ(readFile(xmlPath), readFile(replayPath));
+
+  delete replayer;
+  unlink(logPath.c_str());
+  unlink(xmlPath.c_str());
+  unlink(replayPath.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(IntentLogReplayerTest, replaySkippedSlots) {
+  // Scenario: we record a simulation that fast-forwards once the network is
+  //  quiescent, and replay it into a second XML output.
+  // Why: the log must record the skipped slots, and the replay must pass
+  //  them on with the repeated network states.
+  std::string logPath = createTempFile();
+  std::string xmlPath = createTempFile();
+  std::string replayPath = createTempFile();
+  ReplayTestMessage msg("hello");
+  ReplayTestComponent compA("A", &msg, 2, 1);
+  ReplayTestComponent compB("B", nullptr, 1, 0);
+  Component* comps[] = { &compA, &compB };
+  const Message* msgs[] = { &msg };
+  ExplicitNetworkTopology ent;
+  ent.addEdge(&compA, &compB);
+
+  Output::Sink* logSink = Output::Sink::openFile(logPath);
+  Output::Sink* xmlSink = Output::Sink::openFile(xmlPath);
+  Output::TeeOutputModule tee;
+  tee.addModule(new Output::IntentLogOutputModule(logSink));
+  tee.addModule(new Output::XMLOutputModule(xmlSink));
+  Simulator sim(5);
+  sim.useTopology(&ent);
+  sim.useOutputModule(&tee);
+  sim.useComponents(comps, 2);
+  sim.useMessages(msgs, 1);
+  sim.useQuiescence(QuiescenceMode::FAST_FORWARD);
+  sim.run(10);
+  delete logSink;
+  delete xmlSink;
+  std::string xml = readFile(xmlPath);
+  ASSERT_NE(std::string::npos, xml.find("skipped"));
+
+  IntentLogReplayer* replayer = IntentLogReplayer::open(logPath);
+  ASSERT_NE(nullptr, replayer);
+  Output::Sink* replaySink = Output::Sink::openFile(replayPath);
+  Output::XMLOutputModule replayXML(replaySink);
+  ASSERT_EQ(10, replayer->run(&replayXML, ANLSemantics::NAIVE));
+  delete replaySink;
+  ASSERT_EQ(xml, readFile(replayPath));
+  delete replayer;
+  unlink(logPath.c_str());
+  unlink(xmlPath.c_str());
+  unlink(replayPath.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(IntentLogReplayerTest, getTopology) {
+  // Scenario: we check the reconstructed topology of a recorded simulation.
+  // Why: the transitions depend on it.
+  std::string logPath = createTempFile();
+  std::string xmlPath = createTempFile();
+  recordSimulation(1, logPath, xmlPath);
+
+  IntentLogReplayer* replayer = IntentLogReplayer::open(logPath);
+  ASSERT_NE(nullptr, replayer);
+  std::vector<const Component*> comps;
+  replayer->getSetup().forEachComponent([&comps](const Component* comp) {
+    comps.push_back(comp);
+  });
+  ASSERT_EQ(3, comps.size());
+  ASSERT_EQ("B", comps[1]->getId());
+  ASSERT_TRUE(replayer->getTopology().canReach(comps[0], comps[1]));
+  ASSERT_TRUE(replayer->getTopology().canReach(comps[2], comps[1]));
+  ASSERT_FALSE(replayer->getTopology().canReach(comps[0], comps[2]));
+  ASSERT_FALSE(replayer->getTopology().canReach(comps[0], comps[0]));
+  delete replayer;
+  unlink(logPath.c_str());
+  unlink(xmlPath.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(IntentLogReplayerTest, truncatedLog) {
+  // Scenario: we cut off the end of a log in the middle of the last slot
+  //  record.
+  // Why: logs of aborted simulations can be replayed up to the last complete
+  //  slot.
+  std::string logPath = createTempFile();
+  std::string xmlPath = createTempFile();
+  recordSimulation(4, logPath, xmlPath);
+  std::string log = readFile(logPath);
+  ASSERT_EQ(IntentLog::kEndTag, log.back());
+  {
+    std::ofstream out(logPath, std::ios::binary | std::ios::trunc);
+    out << log.substr(0, log.size() - 3);
+  }
+
+  IntentLogReplayer* replayer = IntentLogReplayer::open(logPath);
+  ASSERT_NE(nullptr, replayer);
+  Output::Sink* statsSink = Output::Sink::openFile(xmlPath);
+  Output::StatisticsOutputModule stats(statsSink, 0);
+  ASSERT_EQ(3, replayer->run(&stats, ANLSemantics::NAIVE));
+  ASSERT_EQ(3, stats.getSlotCount());
+  delete statsSink;
+  delete replayer;
+  unlink(logPath.c_str());
+  unlink(xmlPath.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(IntentLogReplayerTest, openFailures) {
+  // Scenario: we open a missing file, a file that is not an intent log, and
+  //  an intent log with a truncated header.
+  // Why: abnormal exit points of open.
+  ASSERT_EQ(nullptr, IntentLogReplayer::open("/nonexistent/intents"));
+
+  std::string logPath = createTempFile();
+  std::string xmlPath = createTempFile();
+  ASSERT_EQ(nullptr, IntentLogReplayer::open(xmlPath));
+
+  recordSimulation(1, logPath, xmlPath);
+  std::string log = readFile(logPath);
+  {
+    std::ofstream out(logPath, std::ios::binary | std::ios::trunc);
+    out << log.substr(0, 12);
+  }
+  ASSERT_EQ(nullptr, IntentLogReplayer::open(logPath));
+  unlink(logPath.c_str());
+  unlink(xmlPath.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(IntentLogReplayerDeathTest, runNeedsOutputModule) {
+  // Scenario: replaying without output module fails.
+  // Why: abnormal exit point of method.
+  std::string logPath = createTempFile();
+  std::string xmlPath = createTempFile();
+  recordSimulation(1, logPath, xmlPath);
+  IntentLogReplayer* replayer = IntentLogReplayer::open(logPath);
+  ASSERT_NE(nullptr, replayer);
+  ASSERT_DEATH(replayer->run(nullptr, ANLSemantics::NAIVE),
+    "output module must not be nullptr");
+  delete replayer;
+  unlink(logPath.c_str());
+  unlink(xmlPath.c_str());
+}
@@ -28,9 +28,19 @@
 // Part of ANL-Impl.
 
 #include <gtest/gtest.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "anl/core/checkpoint.h"
+#include "anl/core/protocol_log.h"
 #include "anl/core/simulator.h"
 #include "anl/core/topologies.h"
 #include "anl/output/output.h"
+#include "anl/output/trace_reader.h"
 
 // We do this here as a test can under no circumstance pollute the namespace as
 // it is never included.
@@ -255,3 +265,761 @@ TEST(SimulatorTest, runSingle) {
   sim.endSingle();
   ASSERT_TRUE(testVar);
 }
+
+// _____________________________________________________________________________
+// Component type for the tests in this file. Logs its ID and the slot number
+//  and idles.
+class LoggingComponent : public Component {
+ public:
+  // Constructor.
+  explicit LoggingComponent(const std::string& id) : mId(id) {}
+
+ private:
+  // The ID of the component.
+  std::string mId;
+
+  // The ID callback.
+  std::string doGetId() const override { return mId; }
+
+  // The protocol callback.
+  void doAct(ANLView* view) override {
+    view->logProtocol(mId + " in " + std::to_string(view->getSlotNumber()));
+    view->idle();
+  }
+};
+
+// _____________________________________________________________________________
+// Output module for the tests in this file. Records the notifications in the
+//  order they were received.
+class EventOutputModule : public Output::OutputModule {
+ public:
+  // The recorded notifications.
+  std::vector<std::string> mEvents;
+
+ private:
+  void doSimulationBegin(std::size_t numSlots, const NetworkSetup* setup,
+      const NetworkTopology* topology) override {}
+  void doSlotBegin(std::size_t slotNumber) override
+    { mEvents.push_back("begin " + std::to_string(slotNumber)); }
+  void doProtocolLog(const std::string& componentId,
+      const std::string& message) override
+    { mEvents.push_back(componentId + ": " + message); }
+  void doIntentChosen(const IntentionAssignment& intent) override
+    { mEvents.push_back("intent"); }
+  void doTransitionComputed(const std::vector<NetworkState>& outcomes)
+    override {}
+  void doResultChosen(const NetworkState& state) override {}
+  void doSlotEnd() override { mEvents.push_back("end"); }
+  void doSlotsSkipped(std::size_t firstSlot, std::size_t count,
+      const std::vector<NetworkState>& cycle) override {
+    mEvents.push_back("skipped " + std::to_string(firstSlot) + " "
+      + std::to_string(count) + " " + std::to_string(cycle.size()));
+  }
+  void doSimulationEnd(std::size_t numSlots) override
+    { mEvents.push_back("slots " + std::to_string(numSlots)); }
+};
+
+// _____________________________________________________________________________
+TEST(ProtocolLogTest, flushesInBatchesToSink) {
+  // Scenario: we add three records to a log with capacity two that writes to a
+  //  sink. the first two records are written when the third is added.
+  // Why: the log must only write in batches, tagged with slot and component.
+  NetworkSetup setup(20);
+  LoggingComponent a("A");
+  LoggingComponent b("B");
+  setup.registerComponent(&a);
+  setup.registerComponent(&b);
+
+  char path[] = "/tmp/anlimpl_simulator_test_XXXXXX";
+  int fd = mkstemp(path);
+  Output::Sink* sink = new Output::Sink(fd, 0);
+  ProtocolLog log(&setup, 2);
+  log.setSink(sink);
+
+  log.add(3, &b, "first");
+  log.add(3, &a, "second");
+  ASSERT_EQ(2, log.getSize());
+  std::ifstream before(path);
+  ASSERT_EQ(std::ifstream::traits_type::eof(), before.peek());
+
+  log.add(4, &a, "third");
+  ASSERT_EQ(1, log.getSize());
+  log.flush();
+  ASSERT_EQ(0, log.getSize());
+
+  std::ifstream in(path);
+  std::stringstream sstr;
+  sstr << in.rdbuf();
+  ASSERT_EQ("[3] B: first\n[3] A: second\n[4] A: third\n", sstr.str());
+  delete sink;
+  unlink(path);
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, mergeProtocolLog) {
+  // Scenario: we run two logging components for two slots with a merged
+  //  protocol log.
+  // Why: the log messages must appear in the slot they were logged in, before
+  //  the chosen intentions.
+  LoggingComponent a("A");
+  LoggingComponent b("B");
+  Component* comps[2] = { &a, &b };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 2);
+  sim.mergeProtocolLog(true);
+  sim.run(2);
+
+  std::vector<std::string> expected = {
+    "begin 0", "A: A in 0", "B: B in 0", "intent", "end",
+    "begin 1", "A: A in 1", "B: B in 1", "intent", "end", "slots 2"
+  };
+  ASSERT_EQ(expected, out.mEvents);
+}
+
+// _____________________________________________________________________________
+// Component type for the quiescence tests. Alternates between listening and
+//  idling and becomes stable after the given number of slots.
+class AlternatingComponent : public Component {
+ public:
+  // Constructor.
+  explicit AlternatingComponent(std::size_t stableAfter)
+    : mStableAfter(stableAfter), mActs(0) {}
+
+ private:
+  // The number of slots after which the component is stable.
+  std::size_t mStableAfter;
+
+  // The number of slots the component acted in.
+  std::size_t mActs;
+
+  // The protocol callback.
+  void doAct(ANLView* view) override {
+    if (mActs++ % 2 == 0) {
+      view->listen();
+    } else {
+      view->idle();
+    }
+  }
+
+  // The stability callback.
+  bool doIsStable() const override { return mActs >= mStableAfter; }
+};
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, quiescenceStop) {
+  // Scenario: we run an alternating component that becomes stable after four
+  //  slots for ten slots, stopping at quiescence.
+  // Why: the network state of slot 3 repeats slot 1 and the component is
+  //  stable, so the simulation must stop after slot 3.
+  AlternatingComponent comp(4);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.useQuiescence(QuiescenceMode::STOP);
+  sim.run(10);
+
+  ASSERT_TRUE(sim.isQuiescent());
+  ASSERT_EQ(4, sim.getSlotNumber());
+  ASSERT_EQ(13, out.mEvents.size());
+  ASSERT_EQ("slots 4", out.mEvents.back());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, quiescenceFastForward) {
+  // Scenario: as above, but the remaining slots are skipped.
+  // Why: the output module must be told about the skipped slots, and the slot
+  //  counter must account for them.
+  AlternatingComponent comp(4);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.useQuiescence(QuiescenceMode::FAST_FORWARD);
+  sim.run(10);
+
+  ASSERT_EQ(10, sim.getSlotNumber());
+  ASSERT_EQ(14, out.mEvents.size());
+  ASSERT_EQ("skipped 4 6 2", out.mEvents[12]);
+  ASSERT_EQ("slots 10", out.mEvents.back());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, quiescenceFastForwardIndexed) {
+  // Scenario: as above, but with an indexed text trace, in which we look up
+  //  skipped slots.
+  // Why: the skipped slots have no output of their own, the record of the
+  //  skipped slots must be found for them.
+  char tracePath[] = "/tmp/anlimpl_simulator_test_XXXXXX";
+  char indexPath[] = "/tmp/anlimpl_simulator_test_XXXXXX";
+  Output::Sink* traceSink = new Output::Sink(mkstemp(tracePath), 0);
+  Output::Sink* indexSink = new Output::Sink(mkstemp(indexPath), 0);
+  Output::IndexOutputModule out(new Output::StdOutOutputModule(traceSink),
+    traceSink, indexSink);
+  AlternatingComponent comp(4);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.useQuiescence(QuiescenceMode::FAST_FORWARD);
+  sim.run(10);
+  delete traceSink;
+  delete indexSink;
+
+  Output::TraceReader* reader = Output::TraceReader::open(tracePath,
+    indexPath);
+  ASSERT_NE(nullptr, reader);
+  const std::string skipped("# Skipped 6 slots beginning with slot 4");
+  std::size_t length = 0;
+  for (std::size_t slot = 4; slot < 10; slot++) {
+    const char* data = reader->findSlots(slot, slot, &length);
+    ASSERT_NE(nullptr, data);
+    ASSERT_EQ(0, std::string(data, length).find(skipped));
+  }
+  const char* data = reader->findSlots(3, 5, &length);
+  ASSERT_NE(nullptr, data);
+  std::string part(data, length);
+  ASSERT_EQ(0, part.find("# Beginning simulation of slot 3"));
+  ASSERT_NE(std::string::npos, part.find(skipped));
+  data = reader->findSlots(2, 2, &length);
+  ASSERT_EQ(std::string::npos, std::string(data, length).find(skipped));
+  ASSERT_EQ(nullptr, reader->findSlots(10, 12, &length));
+  delete reader;
+  unlink(tracePath);
+  unlink(indexPath);
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, quiescenceNeedsPeriod) {
+  // Scenario: we run the alternating component while only comparing with the
+  //  network state of the previous slot.
+  // Why: the network state never equals the previous one, so all slots must
+  //  be simulated.
+  AlternatingComponent comp(0);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.useQuiescence(QuiescenceMode::FAST_FORWARD, 1);
+  sim.run(10);
+
+  ASSERT_FALSE(sim.isQuiescent());
+  ASSERT_EQ(10, sim.getSlotNumber());
+  ASSERT_EQ(31, out.mEvents.size());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, quiescenceOffByDefault) {
+  // Scenario: we run a stable component that idles for five slots without
+  //  enabling quiescence detection.
+  // Why: without opting in, every slot must be simulated.
+  LoggingComponent comp("A");
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.run(5);
+
+  ASSERT_FALSE(sim.isQuiescent());
+  ASSERT_EQ(5, sim.getSlotNumber());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorDeathTest, quiescenceBeforeSimulation) {
+  // Scenario: we enable quiescence detection after the first slot.
+  // Why: the history of network states must cover the whole simulation.
+  LoggingComponent comp("A");
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.runSingle(2);
+  ASSERT_DEATH(sim.useQuiescence(QuiescenceMode::STOP), "");
+}
+
+// _____________________________________________________________________________
+// Component type for the cycle tests. Listens in every period-th slot and idles
+//  otherwise. Exposes its position in the period as its state, unless it is
+//  opaque.
+class PeriodicComponent : public Component {
+ public:
+  // Constructor.
+  PeriodicComponent(std::size_t period, bool opaque)
+    : mPeriod(period), mOpaque(opaque), mPosition(0) {}
+
+ private:
+  // The period of the component.
+  std::size_t mPeriod;
+
+  // Whether or not the state is hidden.
+  bool mOpaque;
+
+  // The position in the period.
+  std::size_t mPosition;
+
+  // The protocol callback.
+  void doAct(ANLView* view) override {
+    if (mPosition == 0) {
+      view->listen();
+    } else {
+      view->idle();
+    }
+    mPosition = (mPosition + 1) % mPeriod;
+  }
+
+  // The state callback.
+  bool doHashState(StateHasher* hasher) const override {
+    hasher->addValue(mPosition);
+    return !mOpaque;
+  }
+};
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, cycleStop) {
+  // Scenario: we run a component with period three for ten slots, stopping at
+  //  the first cycle.
+  // Why: the global states after slots 3 to 5 repeat the ones after slots 0
+  //  to 2, which confirms the cycle after slot 5.
+  PeriodicComponent comp(3, false);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.useCycleDetection(CycleMode::STOP);
+  sim.run(10);
+
+  ASSERT_EQ(3, sim.getCyclePeriod());
+  ASSERT_EQ(6, sim.getSlotNumber());
+  ASSERT_EQ("slots 6", out.mEvents.back());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, cycleExtrapolate) {
+  // Scenario: as above, but extrapolating the remaining slots into statistics
+  //  and comparing them with a full simulation.
+  // Why: extrapolated statistics must equal simulated ones.
+  char path[] = "/tmp/anlimpl_simulator_test_XXXXXX";
+  int fd = mkstemp(path);
+  Output::Sink sink(fd, 0);
+  Output::StatisticsOutputModule full(&sink, 4);
+  Output::StatisticsOutputModule extrapolated(&sink, 4);
+  TrivialNetworkTopology tnt;
+  for (Output::StatisticsOutputModule* out : { &full, &extrapolated }) {
+    PeriodicComponent comp(3, false);
+    Component* comps[1] = { &comp };
+    Simulator sim(20);
+    sim.useOutputModule(out);
+    sim.useTopology(&tnt);
+    sim.useComponents(comps, 1);
+    if (out == &extrapolated) {
+      sim.useCycleDetection(CycleMode::EXTRAPOLATE);
+    }
+    sim.run(50);
+    ASSERT_EQ(50, sim.getSlotNumber());
+  }
+  unlink(path);
+
+  ASSERT_EQ(44, extrapolated.getSkippedCount());
+  ASSERT_EQ(full.getSlotCount(), extrapolated.getSlotCount());
+  ASSERT_EQ(full.getTotal(ActionType::SILENCE),
+    extrapolated.getTotal(ActionType::SILENCE));
+  ASSERT_EQ(full.getTotal(ActionType::IDLE),
+    extrapolated.getTotal(ActionType::IDLE));
+  ASSERT_EQ(full.getSampleCount(), extrapolated.getSampleCount());
+  for (std::size_t i = 0; i < full.getSampleCount(); i++) {
+    ASSERT_EQ(full.getSampleCount(i, ActionType::SILENCE),
+      extrapolated.getSampleCount(i, ActionType::SILENCE));
+  }
+}
+
+// _____________________________________________________________________________
+// Component type for the cycle confirmation test. Follows a fixed pattern of
+//  listening ('L') and idling ('I'), and repeats the last entry forever. Its
+//  state is hidden from the hash, which thus only covers the network state.
+class PatternComponent : public Component {
+ public:
+  // Constructor.
+  explicit PatternComponent(const std::string& pattern)
+    : mPattern(pattern), mPosition(0) {}
+
+ private:
+  // The pattern.
+  std::string mPattern;
+
+  // The position in the pattern.
+  std::size_t mPosition;
+
+  // The protocol callback.
+  void doAct(ANLView* view) override {
+    if (mPattern[mPosition] == 'L') {
+      view->listen();
+    } else {
+      view->idle();
+    }
+    mPosition = std::min(mPosition + 1, mPattern.size() - 1);
+  }
+
+  // The state callback.
+  bool doHashState(StateHasher* hasher) const override { return true; }
+};
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, cycleNeedsRepeatedPeriod) {
+  // Scenario: the component listens, idles, and then listens forever.
+  // Why: the global state after slot 2 equals the one after slot 0, but the
+  //  period of two does not repeat. Only the period of one is confirmed, after
+  //  slot 3.
+  PatternComponent comp("LIL");
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.useCycleDetection(CycleMode::STOP);
+  sim.run(20);
+
+  ASSERT_EQ(1, sim.getCyclePeriod());
+  ASSERT_EQ(4, sim.getSlotNumber());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, cycleNeedsExposedStates) {
+  // Scenario: we run the periodic component without exposing its state.
+  // Why: without the component states, no cycle can be detected safely.
+  PeriodicComponent comp(3, true);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.useCycleDetection(CycleMode::STOP);
+  sim.run(10);
+
+  ASSERT_EQ(0, sim.getCyclePeriod());
+  ASSERT_EQ(10, sim.getSlotNumber());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, cycleHistoryBoundsPeriod) {
+  // Scenario: we run the periodic component with a history of two slots.
+  // Why: cycles longer than the history can not be detected.
+  PeriodicComponent comp(3, false);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.useCycleDetection(CycleMode::STOP, 2);
+  sim.run(10);
+
+  ASSERT_EQ(10, sim.getSlotNumber());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, runUntilState) {
+  // Scenario: we run a component with period four until it listens again,
+  //  allowing at most ten slots.
+  // Why: the predicate must see the network state and the slot number, and
+  //  the output module must learn the real number of slots.
+  PeriodicComponent comp(4, false);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  std::size_t numSlots = sim.runUntil([&comp](const NetworkState& state,
+      std::size_t slot) {
+    return slot > 0
+      && state.getTraitFor(&comp).getType() == ActionType::SILENCE;
+  }, 10);
+
+  ASSERT_EQ(5, numSlots);
+  ASSERT_EQ("slots 5", out.mEvents.back());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, runUntilMaxSlots) {
+  // Scenario: we run with a predicate that is never fulfilled.
+  // Why: the maximum number of slots must end the simulation.
+  LoggingComponent comp("A");
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  ASSERT_EQ(7, sim.runUntil([](const NetworkState& state, std::size_t slot) {
+    return false;
+  }, 7));
+  ASSERT_EQ("slots 7", out.mEvents.back());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, runUntilSkipsToPredicate) {
+  // Scenario: we run a component with period three until slot 20 while
+  //  extrapolating cycles.
+  // Why: slots may only be skipped up to the slot fulfilling the predicate.
+  PeriodicComponent comp(3, false);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.useCycleDetection(CycleMode::EXTRAPOLATE);
+  ASSERT_EQ(21, sim.runUntil([](const NetworkState& state, std::size_t slot) {
+    return slot == 20;
+  }, 100));
+  ASSERT_EQ("skipped 6 15 3", out.mEvents[out.mEvents.size() - 2]);
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, runUntilReportsSlotCount) {
+  // Scenario: we stop after slot 2 of at most ten slots with text output.
+  // Why: the text output must state the real number of slots, as the number
+  //  at its beginning was only the maximum.
+  char path[] = "/tmp/anlimpl_simulator_test_XXXXXX";
+  int fd = mkstemp(path);
+  Output::Sink* sink = new Output::Sink(fd, 0);
+  Output::StdOutOutputModule out(sink);
+  LoggingComponent comp("A");
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.runUntil([](const NetworkState& state, std::size_t slot) {
+    return slot == 2;
+  }, 10);
+  delete sink;
+
+  std::ifstream in(path);
+  std::stringstream sstr;
+  sstr << in.rdbuf();
+  ASSERT_NE(std::string::npos,
+    sstr.str().find("# Simulation ended after 3 slots.\n"));
+  unlink(path);
+}
+
+// _____________________________________________________________________________
+// Component type for the checkpoint tests. Listens or idles at random and
+//  counts the slots it listened in.
+class RandomComponent : public Component {
+ public:
+  // Constructor. The random numbers are drawn from the given simulator.
+  explicit RandomComponent(Simulator* sim) : mSim(sim), mListens(0) {}
+
+  // Gets the number of slots the component listened in.
+  std::size_t getListens() const { return mListens; }
+
+ private:
+  // The simulator.
+  Simulator* mSim;
+
+  // The number of slots the component listened in.
+  std::size_t mListens;
+
+  // The protocol callback.
+  void doAct(ANLView* view) override {
+    if ((*mSim->getRandom())() % 2 == 0) {
+      view->listen();
+      mListens++;
+    } else {
+      view->idle();
+    }
+  }
+
+  // The checkpoint callbacks.
+  bool doSaveState(CheckpointWriter* writer) const override
+    { return writer->writeValue(mListens); }
+  bool doLoadState(CheckpointReader* reader) override
+    { return reader->readValue(&mListens); }
+};
+
+// _____________________________________________________________________________
+// Helper for the checkpoint tests. Simulates a random component for at most 30
+//  slots, stopping after the given slot, and writes the plain text output to
+//  the given path. Checkpoints are written after every tenth slot. Returns the
+//  number of slots the component listened in.
+static std::size_t runRandom(const std::string& path,
+    const std::string& checkpoint, bool resume, std::size_t lastSlot) {
+  Output::Sink* sink = Output::Sink::openFile(path, 0, false, !resume);
+  Output::StdOutOutputModule out(sink);
+  TrivialNetworkTopology tnt;
+  Simulator sim(20);
+  RandomComponent comp(&sim);
+  Component* comps[1] = { &comp };
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.useSeed(42);
+  sim.useCheckpoints(checkpoint, 10);
+  if (resume) {
+    sim.resumeFrom(checkpoint);
+  }
+  sim.runUntil([lastSlot](const NetworkState& state, std::size_t slot) {
+    return slot == lastSlot;
+  }, 30);
+  delete sink;
+  return comp.getListens();
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, checkpointResume) {
+  // Scenario: we interrupt a random simulation after slot 16 and resume it
+  //  from its checkpoint after slot 9, and compare it with an uninterrupted
+  //  simulation.
+  // Why: a resumed simulation continues exactly, including the random numbers,
+  //  the component states and the output.
+  char refPath[] = "/tmp/anlimpl_simulator_test_XXXXXX";
+  close(mkstemp(refPath));
+  char path[] = "/tmp/anlimpl_simulator_test_XXXXXX";
+  close(mkstemp(path));
+  std::string checkpoint = std::string(path) + ".checkpoint";
+
+  std::size_t full = runRandom(refPath, checkpoint, false, 29);
+  runRandom(path, checkpoint, false, 16);
+  std::size_t resumed = runRandom(path, checkpoint, true, 29);
+  ASSERT_EQ(full, resumed);
+  ASSERT_NE(0, full);
+  ASSERT_NE(30, full);
+
+  std::ifstream refIn(refPath);
+  std::stringstream refStr;
+  refStr << refIn.rdbuf();
+  std::ifstream in(path);
+  std::stringstream str;
+  str << in.rdbuf();
+  ASSERT_EQ(refStr.str(), str.str());
+  unlink(refPath);
+  unlink(path);
+  unlink(checkpoint.c_str());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, checkpointNeedsSupport) {
+  // Scenario: we write checkpoints of a component and an output module that
+  //  do not support them.
+  // Why: the checkpoints are skipped, the simulation itself continues.
+  char path[] = "/tmp/anlimpl_simulator_test_XXXXXX";
+  close(mkstemp(path));
+  unlink(path);
+  PeriodicComponent comp(3, false);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.useCheckpoints(path, 2);
+  sim.run(5);
+
+  ASSERT_EQ(5, sim.getSlotNumber());
+  ASSERT_NE(0, access(path, F_OK));
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorTest, resumeWithoutCheckpoint) {
+  // Scenario: we resume from a checkpoint that does not exist.
+  // Why: a simulation that was never interrupted starts from scratch.
+  PeriodicComponent comp(3, false);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  sim.resumeFrom("/nonexistent/dir/checkpoint");
+  sim.run(2);
+
+  ASSERT_EQ("begin 0", out.mEvents.front());
+  ASSERT_EQ("slots 2", out.mEvents.back());
+}
+
+// _____________________________________________________________________________
+TEST(SimulatorDeathTest, checkpointArguments) {
+  // Scenario: we request checkpoints with an empty path or interval, after
+  //  the simulation has begun, and resume from a file that is no checkpoint.
+  // Why: abnormal exit points of the checkpoint methods.
+  char path[] = "/tmp/anlimpl_simulator_test_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_EQ(7, write(fd, "garbage", 7));
+  close(fd);
+  PeriodicComponent comp(3, false);
+  Component* comps[1] = { &comp };
+  TrivialNetworkTopology tnt;
+  EventOutputModule out;
+
+  Simulator sim(20);
+  sim.useOutputModule(&out);
+  sim.useTopology(&tnt);
+  sim.useComponents(comps, 1);
+  ASSERT_DEATH(sim.useCheckpoints("", 10), "Checkpoint path must not be "
+    "empty");
+  ASSERT_DEATH(sim.useCheckpoints(path, 0), "Checkpoint interval must be "
+    "greater than zero");
+  sim.resumeFrom(path);
+  ASSERT_DEATH(sim.run(2), "Checkpoint does not match the simulation");
+  unlink(path);
+
+  sim.run(2);
+  ASSERT_DEATH(sim.useCheckpoints(path, 10), "Checkpoints must be set before "
+    "the simulation");
+  ASSERT_DEATH(sim.resumeFrom(path), "Resuming must be set before the "
+    "simulation");
+  ASSERT_DEATH(sim.useSeed(1), "Seed must be set before the simulation");
+}
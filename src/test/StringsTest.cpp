@@ -0,0 +1,113 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "anl/misc/strings.h"
+
+// _____________________________________________________________________________
+TEST(StringsTest, appendNumber) {
+  // Scenario: we append zero, a small number, and the largest number to a
+  //  buffer that already has content.
+  // Why: zero and the maximum are the edge cases of the digit loop.
+  std::string buffer("x");
+  Misc::Strings::appendNumber(&buffer, 0);
+  ASSERT_EQ("x0", buffer);
+  Misc::Strings::appendNumber(&buffer, 1230);
+  ASSERT_EQ("x01230", buffer);
+
+  buffer.clear();
+  Misc::Strings::appendNumber(&buffer, SIZE_MAX);
+  ASSERT_EQ(std::to_string(SIZE_MAX), buffer);
+}
+
+// _____________________________________________________________________________
+TEST(StringsTest, appendVarint) {
+  // Scenario: we append numbers needing one, two and ten bytes.
+  // Why: the group boundaries and the largest number are the edge cases.
+  std::string buffer;
+  Misc::Strings::appendVarint(&buffer, 0x7F);
+  ASSERT_EQ(std::string("\x7F"), buffer);
+
+  buffer.clear();
+  Misc::Strings::appendVarint(&buffer, 0x80);
+  ASSERT_EQ(std::string("\x80\x01"), buffer);
+
+  buffer.clear();
+  Misc::Strings::appendVarint(&buffer, UINT64_MAX);
+  ASSERT_EQ(10, buffer.size());
+  ASSERT_EQ('\x01', buffer.back());
+}
+
+// _____________________________________________________________________________
+TEST(StringsTest, appendIndent) {
+  // Scenario: we append no indentation and some indentation.
+  // Why: regular case and edge case.
+  std::string buffer("a");
+  Misc::Strings::appendIndent(&buffer, 0);
+  ASSERT_EQ("a", buffer);
+  Misc::Strings::appendIndent(&buffer, 3);
+  ASSERT_EQ("a   ", buffer);
+}
+
+// _____________________________________________________________________________
+TEST(StringsTest, appendEscapedXML) {
+  // Scenario: we append text with every special character and plain text.
+  // Why: the special characters must not end the element or attribute.
+  std::string buffer("<a>");
+  Misc::Strings::appendEscapedXML(&buffer, "x<y & \"z\">w");
+  ASSERT_EQ("<a>x&lt;y &amp; &quot;z&quot;&gt;w", buffer);
+  Misc::Strings::appendEscapedXML(&buffer, "");
+  ASSERT_EQ("<a>x&lt;y &amp; &quot;z&quot;&gt;w", buffer);
+}
+
+// _____________________________________________________________________________
+TEST(StringsTest, appendLines) {
+  // Scenario: we append two lines with indentation, and no lines.
+  // Why: regular case and edge case.
+  std::string buffer;
+  Misc::Strings::appendLines(&buffer, std::vector<std::string>(), 2);
+  ASSERT_EQ("", buffer);
+  Misc::Strings::appendLines(&buffer, { "<a>", "</a>" }, 2);
+  ASSERT_EQ("  <a>\n  </a>\n", buffer);
+}
+
+// _____________________________________________________________________________
+TEST(StringsTest, splitLines) {
+  // Scenario: we split an empty buffer, terminated lines including an empty
+  //  one, and a buffer with an unterminated last line.
+  // Why: the edge cases of splitting.
+  ASSERT_TRUE(Misc::Strings::splitLines("").empty());
+
+  std::vector<std::string> expected = { "a", "", "  b" };
+  ASSERT_EQ(expected, Misc::Strings::splitLines("a\n\n  b\n"));
+  ASSERT_EQ(expected, Misc::Strings::splitLines("a\n\n  b"));
+}
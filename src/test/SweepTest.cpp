@@ -0,0 +1,185 @@
+// This is free and unencumbered software released into the public domain.
+//
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+//
+// Author: Yannick Bühler
+//
+// Part of ANL-Impl.
+
+#include <gtest/gtest.h>
+#include <csignal>
+#include <string>
+#include <vector>
+#include "anl/core/sweep.h"
+
+// We do this here as a test can under no circumstance pollute the namespace as
+// it is never included.
+using namespace Core;  // NOLINT
+
+// _____________________________________________________________________________
+TEST(ParametersTest, get) {
+  // Scenario: we set a parameter and read it and an unset one.
+  // Why: regular case and the default value of unset parameters.
+  Parameters::clear();
+  Parameters::set("topology", "ring");
+  ASSERT_TRUE(Parameters::has("topology"));
+  ASSERT_FALSE(Parameters::has("tics"));
+  ASSERT_EQ("ring", Parameters::get("topology", "line"));
+  ASSERT_EQ("line", Parameters::get("tics", "line"));
+
+  // Scenario: we clear the parameters.
+  // Why: clearing removes every parameter.
+  Parameters::clear();
+  ASSERT_FALSE(Parameters::has("topology"));
+}
+
+// _____________________________________________________________________________
+TEST(ParametersTest, getSize) {
+  // Scenario: we read a size parameter that is set, and one that is not.
+  // Why: regular case and the default value of unset parameters.
+  Parameters::clear();
+  Parameters::set("tics", "25");
+  ASSERT_EQ(25u, Parameters::getSize("tics", 10));
+  ASSERT_EQ(10u, Parameters::getSize("slots", 10));
+  Parameters::clear();
+}
+
+// _____________________________________________________________________________
+TEST(ParametersDeathTest, getSizeInvalid) {
+  // Scenario: we read parameters that are no sizes as sizes.
+  // Why: exit point, including the empty value.
+  Parameters::clear();
+  Parameters::set("tics", "25x");
+  Parameters::set("slots", "");
+  ASSERT_DEATH(Parameters::getSize("tics", 10), "parameter is not a size");
+  ASSERT_DEATH(Parameters::getSize("slots", 10), "parameter is not a size");
+  Parameters::clear();
+}
+
+// _____________________________________________________________________________
+TEST(ParameterSweepTest, grid) {
+  // Scenario: we sweep over no parameters.
+  // Why: corner case, the sweep has a single run.
+  ParameterSweep sweep;
+  ASSERT_EQ(0u, sweep.getParameterCount());
+  ASSERT_EQ(1u, sweep.getRunCount());
+
+  // Scenario: we sweep two parameters with three and two values.
+  // Why: regular case, the last parameter varies fastest.
+  sweep.addParameter("tics", { "10", "20", "30" });
+  sweep.addParameter("scheme", { "a", "b" });
+  ASSERT_EQ(2u, sweep.getParameterCount());
+  ASSERT_EQ("tics", sweep.getParameterName(0));
+  ASSERT_EQ("scheme", sweep.getParameterName(1));
+  ASSERT_EQ(6u, sweep.getRunCount());
+  const char* const expected[6][2] = {
+    { "10", "a" }, { "10", "b" }, { "20", "a" },
+    { "20", "b" }, { "30", "a" }, { "30", "b" }
+  };
+  for (std::size_t run = 0; run < 6; run++) {
+    ASSERT_EQ(expected[run][0], sweep.getValue(run, 0));
+    ASSERT_EQ(expected[run][1], sweep.getValue(run, 1));
+  }
+
+  // Scenario: we get the header of a results table with a result column that
+  //  is named like a swept parameter.
+  // Why: the columns of the parameters are prefixed, the names stay distinct.
+  sweep.addParameter("slots", { "60" });
+  ASSERT_EQ("run param:tics param:scheme param:slots status slots\n",
+    sweep.getTableHeader({ "status", "slots" }));
+
+  // Scenario: we apply a run.
+  // Why: the parameters are set to the values of the run.
+  Parameters::clear();
+  sweep.applyRun(3);
+  ASSERT_EQ(20u, Parameters::getSize("tics", 0));
+  ASSERT_EQ("b", Parameters::get("scheme", ""));
+  Parameters::clear();
+}
+
+// _____________________________________________________________________________
+TEST(ParameterSweepDeathTest, grid) {
+  // Scenario: we add parameters without values or twice, and access runs and
+  //  parameters that do not exist.
+  // Why: exit points.
+  ParameterSweep sweep;
+  sweep.addParameter("tics", { "10", "20" });
+  ASSERT_DEATH(sweep.addParameter("slots", {}), "parameter needs values");
+  ASSERT_DEATH(sweep.addParameter("tics", { "30" }),
+    "parameter is already swept");
+  ASSERT_DEATH(sweep.getParameterName(1), "parameter out of range");
+  ASSERT_DEATH(sweep.getValue(2, 0), "run out of range");
+  ASSERT_DEATH(sweep.getValue(0, 1), "parameter out of range");
+  ASSERT_DEATH(sweep.getTableHeader({ "status", "param:tics" }),
+    "result column contains ':'");
+}
+
+// _____________________________________________________________________________
+TEST(ParameterSweepTest, run) {
+  // Scenario: we perform six runs with up to two at the same time. Each run
+  //  writes its parameters and exits with its number.
+  // Why: regular case, the results are in the order of the runs, and the
+  //  parameters are only set in the processes of the runs.
+  ParameterSweep sweep;
+  sweep.addParameter("tics", { "10", "20", "30" });
+  sweep.addParameter("scheme", { "a", "b" });
+  Parameters::clear();
+  std::vector<ParameterSweep::Result> results = sweep.run(2,
+    [](std::size_t run, Output::Sink* sink) {
+      sink->print("%zu %s\n", Parameters::getSize("tics", 0),
+        Parameters::get("scheme", "").c_str());
+      return static_cast<int>(run);
+    });
+  ASSERT_FALSE(Parameters::has("tics"));
+  ASSERT_EQ(6u, results.size());
+  const char* const expected[6] = {
+    "10 a\n", "10 b\n", "20 a\n", "20 b\n", "30 a\n", "30 b\n"
+  };
+  for (std::size_t run = 0; run < 6; run++) {
+    ASSERT_EQ(static_cast<int>(run), results[run].status);
+    ASSERT_EQ(expected[run], results[run].output);
+  }
+
+  // Scenario: we perform runs with one process per processor, writing more
+  //  than a pipe holds, and one of them is killed by a signal.
+  // Why: large results are collected while the runs write them, and killed
+  //  runs are reported by their signal.
+  results = sweep.run(0, [](std::size_t run, Output::Sink* sink) {
+      if (run == 4) {
+        std::raise(SIGKILL);
+      }
+      sink->print("%s", std::string(256 * 1024, 'x').c_str());
+      return 0;
+    });
+  ASSERT_EQ(6u, results.size());
+  for (std::size_t run = 0; run < 6; run++) {
+    if (run == 4) {
+      ASSERT_EQ(128 + SIGKILL, results[run].status);
+      ASSERT_EQ("", results[run].output);
+    } else {
+      ASSERT_EQ(0, results[run].status);
+      ASSERT_EQ(256u * 1024, results[run].output.size());
+    }
+  }
+}
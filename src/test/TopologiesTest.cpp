@@ -28,6 +28,9 @@
 // Part of ANL-Impl.
 
 #include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
 #include "anl/core/anl.h"
 #include "anl/core/topologies.h"
 
@@ -35,6 +38,30 @@
 // it is never included.
 using namespace Core;  // NOLINT
 
+// A topology that only knows canReach, to test the default enumeration.
+//  Component i can reach component j iff j is a multiple of i + 1.
+class OpaqueNetworkTopology : public NetworkTopology {
+ public:
+  explicit OpaqueNetworkTopology(const Component* comps) : mComps(comps) {}
+
+ private:
+  bool doCanReach(const Component* sndr, const Component* rcvr) const override
+    { return (rcvr - mComps) % (sndr - mComps + 1) == 0; }
+
+  const Component* mComps;
+};
+
+// Collects the components reachable from the given sender.
+static std::vector<const Component*> collectReachable(
+    const NetworkTopology& topology, const NetworkSetup& setup,
+    const Component* sndr) {
+  std::vector<const Component*> result;
+  topology.forEachReachable(setup, sndr, [&result](const Component* rcvr) {
+    result.push_back(rcvr);
+  });
+  return result;
+}
+
 // _____________________________________________________________________________
 TEST(TrivialNetworkTopologyTest, canReach) {
   // Scenario: each component can reach each other component in the trivial
@@ -100,3 +127,188 @@ TEST(ExplicitNetworkTopology, canReach) {
     ASSERT_EQ(c11, ent.canReach(&comps[1], &comps[1]));
   }
 }
+
+// _____________________________________________________________________________
+TEST(TrivialNetworkTopologyTest, forEachReachable) {
+  // Scenario: every registered component is reachable, in registration order.
+  // Why: the XML output relies on this order.
+  Component comps[3];
+  NetworkSetup setup(1);
+  setup.registerComponent(&comps[2]);
+  setup.registerComponent(&comps[0]);
+  setup.registerComponent(&comps[1]);
+  TrivialNetworkTopology tnt;
+  std::vector<const Component*> expected = { &comps[2], &comps[0], &comps[1] };
+  ASSERT_EQ(expected, collectReachable(tnt, setup, &comps[0]));
+}
+
+// _____________________________________________________________________________
+TEST(IsolatedNetworkTopologyTest, forEachReachable) {
+  // Scenario: no component is reachable in the isolated network topology.
+  // Why: trivial case.
+  Component comps[3];
+  NetworkSetup setup(1);
+  for (int i = 0; i < 3; i++) {
+    setup.registerComponent(&comps[i]);
+  }
+  IsolatedNetworkTopology into;
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(collectReachable(into, setup, &comps[i]).empty());
+  }
+}
+
+// _____________________________________________________________________________
+TEST(ExplicitNetworkTopology, forEachReachable) {
+  // Scenario: edges are added in reverse order and one edge points to an
+  //  unregistered component. Only registered components are enumerated, in
+  //  registration order.
+  // Why: the edges are stored unordered, the order must be restored.
+  Component comps[5];
+  NetworkSetup setup(1);
+  for (int i = 0; i < 4; i++) {
+    setup.registerComponent(&comps[i]);
+  }
+  ExplicitNetworkTopology ent;
+  ent.addEdge(&comps[0], &comps[4]);
+  for (int i = 3; i >= 0; i--) {
+    ent.addEdge(&comps[0], &comps[i]);
+  }
+  ent.addEdge(&comps[1], &comps[2]);
+
+  std::vector<const Component*> expected = {
+    &comps[0], &comps[1], &comps[2], &comps[3]
+  };
+  ASSERT_EQ(expected, collectReachable(ent, setup, &comps[0]));
+  expected = { &comps[2] };
+  ASSERT_EQ(expected, collectReachable(ent, setup, &comps[1]));
+  ASSERT_TRUE(collectReachable(ent, setup, &comps[2]).empty());
+}
+
+// _____________________________________________________________________________
+TEST(NetworkTopologyTest, forEachReachableFallback) {
+  // Scenario: a topology without its own enumeration is probed with canReach
+  //  for every registered component.
+  // Why: user topologies must keep working without changes.
+  Component comps[6];
+  NetworkSetup setup(1);
+  for (int i = 0; i < 6; i++) {
+    setup.registerComponent(&comps[i]);
+  }
+  OpaqueNetworkTopology ont(comps);
+  std::vector<const Component*> expected = { &comps[0], &comps[2], &comps[4] };
+  ASSERT_EQ(expected, collectReachable(ont, setup, &comps[1]));
+  expected = { &comps[0], &comps[3] };
+  ASSERT_EQ(expected, collectReachable(ont, setup, &comps[2]));
+}
+
+// _____________________________________________________________________________
+TEST(UnitDiskNetworkTopologyTest, canReach) {
+  // Scenario: components at exactly the range, across a cell boundary, out of
+  //  range, the component itself, and a component that was not placed.
+  // Why: the range is inclusive, cells must not split neighbors, and nobody
+  //  reaches itself or unplaced components.
+  Component comps[5];
+  UnitDiskNetworkTopology udnt(1);
+  udnt.addComponent(&comps[0], 0, 0);
+  udnt.addComponent(&comps[1], 1, 0);
+  udnt.addComponent(&comps[2], -0.5, -0.5);
+  udnt.addComponent(&comps[3], 2.5, 0);
+  ASSERT_TRUE(udnt.canReach(&comps[0], &comps[1]));
+  ASSERT_TRUE(udnt.canReach(&comps[1], &comps[0]));
+  ASSERT_TRUE(udnt.canReach(&comps[0], &comps[2]));
+  ASSERT_FALSE(udnt.canReach(&comps[1], &comps[2]));
+  ASSERT_FALSE(udnt.canReach(&comps[1], &comps[3]));
+  ASSERT_FALSE(udnt.canReach(&comps[0], &comps[0]));
+  ASSERT_FALSE(udnt.canReach(&comps[0], &comps[4]));
+  ASSERT_FALSE(udnt.canReach(&comps[4], &comps[0]));
+  ASSERT_EQ(2u, udnt.getNeighborCount(&comps[0]));
+  ASSERT_EQ(0u, udnt.getNeighborCount(&comps[3]));
+  ASSERT_EQ(0u, udnt.getNeighborCount(&comps[4]));
+}
+
+// _____________________________________________________________________________
+TEST(UnitDiskNetworkTopologyTest, forEachReachable) {
+  // Scenario: components are registered in another order than placed, one is
+  //  not registered, and the layout is three-dimensional.
+  // Why: only registered components are enumerated, in registration order,
+  //  and the z coordinate counts.
+  Component comps[5];
+  NetworkSetup setup(1);
+  setup.registerComponent(&comps[3]);
+  setup.registerComponent(&comps[1]);
+  setup.registerComponent(&comps[0]);
+  setup.registerComponent(&comps[2]);
+  UnitDiskNetworkTopology udnt(2);
+  udnt.addComponent(&comps[0], 0, 0, 0);
+  udnt.addComponent(&comps[1], 0, 0, 2);
+  udnt.addComponent(&comps[2], 0, 0, 3);
+  udnt.addComponent(&comps[3], 1, 1, -1);
+  udnt.addComponent(&comps[4], 0, 1, 0);
+  std::vector<const Component*> expected = { &comps[3], &comps[1] };
+  ASSERT_EQ(expected, collectReachable(udnt, setup, &comps[0]));
+  expected = { &comps[0], &comps[2] };
+  ASSERT_EQ(expected, collectReachable(udnt, setup, &comps[1]));
+  expected = { &comps[3], &comps[0] };
+  ASSERT_EQ(expected, collectReachable(udnt, setup, &comps[4]));
+
+  // Scenario: a component is placed after the neighbors were determined.
+  // Why: the neighbors are determined again.
+  Component late;
+  setup.registerComponent(&late);
+  udnt.addComponent(&late, 0, 0, 4);
+  expected = { &comps[1], &late };
+  ASSERT_EQ(expected, collectReachable(udnt, setup, &comps[2]));
+}
+
+// _____________________________________________________________________________
+TEST(UnitDiskNetworkTopologyTest, forEachReachableRandom) {
+  // Scenario: a random two- and three-dimensional layout of 300 components,
+  //  compared against probing every pair with canReach.
+  // Why: the grid must find exactly the components in range, including
+  //  negative coordinates.
+  for (int dims = 2; dims <= 3; dims++) {
+    std::mt19937 random(dims);
+    std::uniform_real_distribution<double> coord(-10, 10);
+    std::vector<Component> comps(300);
+    NetworkSetup setup(1);
+    UnitDiskNetworkTopology udnt(1.5);
+    for (Component& comp : comps) {
+      setup.registerComponent(&comp);
+      double x = coord(random);
+      double y = coord(random);
+      udnt.addComponent(&comp, x, y, dims == 3 ? coord(random) : 0);
+    }
+    for (const Component& sndr : comps) {
+      std::vector<const Component*> expected;
+      setup.forEachComponent([&](const Component* rcvr) {
+        if (udnt.canReach(&sndr, rcvr)) {
+          expected.push_back(rcvr);
+        }
+      });
+      ASSERT_EQ(expected, collectReachable(udnt, setup, &sndr));
+    }
+  }
+}
+
+// _____________________________________________________________________________
+TEST(UnitDiskNetworkTopologyDeathTest, invalidArguments) {
+  // Scenario: ranges that are not positive, a component placed twice, and
+  //  coordinates that are not finite or whose grid cells overflow.
+  // Why: exit points.
+  ASSERT_DEATH(UnitDiskNetworkTopology(0), "range must be positive");
+  ASSERT_DEATH(UnitDiskNetworkTopology(-1), "range must be positive");
+  Component comp;
+  UnitDiskNetworkTopology udnt(1);
+  udnt.addComponent(&comp, 0, 0);
+  ASSERT_DEATH(udnt.addComponent(&comp, 1, 1), "component is already placed");
+  Component other;
+  ASSERT_DEATH(udnt.addComponent(&other, std::nan(""), 0),
+    "coordinates must be finite");
+  ASSERT_DEATH(udnt.addComponent(&other, 0, 0, -HUGE_VAL),
+    "coordinates must be finite");
+  ASSERT_DEATH(udnt.addComponent(&other, 0, 1e19),
+    "coordinates are too large for the range");
+  UnitDiskNetworkTopology tiny(1e-300);
+  ASSERT_DEATH(tiny.addComponent(&other, 1, 0),
+    "coordinates are too large for the range");
+}